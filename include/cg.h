@@ -9,16 +9,32 @@
 #define CG_H_
 
 #include "gp.h"
+#include "objective.h"
+#include "stopping_criteria.h"
 
 namespace libgp
 {
 
-class CG
+class CG : public StoppingCriteria
 {
 public:
 	CG();
 	virtual ~CG();
+	/** Maximize the log marginal likelihood of gp. */
 	void maximize(GaussianProcess* gp, size_t n=100, bool verbose=1);
+	/** Maximize an arbitrary objective, e.g. LooPredictive. */
+	void maximize(Objective* objective, size_t n=100, bool verbose=1);
+	/** Evaluate up to points step lengths of the line search concurrently,
+	 *  each on a fork of the objective (see Objective::fork()). Extrapolation
+	 *  speculates on repeated maximal extrapolation steps, which are used
+	 *  whenever the cubic extrapolation reaches its limit. Interpolation adds
+	 *  equally spaced points inside the bracket. The Wolfe-Powell conditions
+	 *  are unchanged. Every evaluated point counts against the maximum
+	 *  number of evaluations n of maximize(). The default of one point is
+	 *  the serial line search. */
+	void set_parallel(size_t points);
+private:
+	size_t points;
 };
 
 }
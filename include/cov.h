@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <vector>
+#include <deque>
 #include <Eigen/Dense>
 #include "gp_version.h"
 
@@ -20,6 +21,30 @@ namespace libgp
   class LIBGP_EXPORT CovarianceFunction
   {
     public:
+
+      /** Pool of scratch vectors for value_and_grad(). Vectors are handed
+       *  out in stack order and keep their memory, so after the first
+       *  evaluation no further allocations take place. Not thread-safe,
+       *  use one workspace per thread. */
+      class LIBGP_EXPORT Workspace
+      {
+      public:
+        Workspace() : used(0) {}
+
+        /** Borrow a vector with n entries, valid until released. */
+        Eigen::VectorXd & acquire(int n);
+
+        /** Return the count most recently acquired vectors. */
+        void release(size_t count = 1)
+        {
+          used -= count;
+        }
+
+      private:
+        std::deque<Eigen::VectorXd> pool;
+        size_t used;
+      };
+
       /** Constructor. */
       CovarianceFunction() {};
 
@@ -63,6 +88,88 @@ namespace libgp
        *  @param grad covariance gradient */
       virtual void grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::VectorXd &grad) = 0;
 
+      /** Covariance and its gradient in a single pass.
+       *  The default implementation calls get() and grad(), all covariance
+       *  functions of the library override it without allocating memory.
+       *  @param x1 first input vector
+       *  @param x2 second input vector
+       *  @param k covariance of x1 and x2
+       *  @param grad covariance gradient, param_dim entries
+       *  @param ws scratch vectors */
+      virtual void value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                  Eigen::Ref<Eigen::VectorXd> grad, Workspace &ws);
+
+      /** Second derivatives of the covariance of two input vectors with
+       *  respect to the hyperparameters. The default implementation uses
+       *  central differences of grad(), the atomic covariance functions
+       *  except the periodic ones, the compound functions and CovStatic
+       *  are analytic.
+       *  @param x1 first input vector
+       *  @param x2 second input vector
+       *  @param hess param_dim x param_dim matrix of second derivatives */
+      virtual void hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess);
+
+      /** Covariances of x and the input vectors X[0], ..., X[k.size()-1].
+       *  As in get(), input vectors are identified by their address. The
+       *  default implementation calls get(), the stationary covariance
+       *  functions evaluate exp, log and sin for the whole row using the
+       *  vectorized functions of simd_math.h.
+       *  @param x input vector
+       *  @param X pointers to input vectors
+       *  @param k covariances
+       *  @param ws scratch vectors */
+      virtual void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                           Eigen::Ref<Eigen::VectorXd> k, Workspace &ws);
+
+      /** Covariances as in get_row() from precomputed squared euclidean
+       *  distances, so that evaluations for several hyperparameter vectors
+       *  share the distance computations. Supported by the isotropic
+       *  stationary covariance functions, CovNoise and their sums and
+       *  products, the default returns false (see supports_distances()).
+       *  @param d2 squared distances of x and the input vectors X[i]
+       *  @param self true if X[0] is x itself
+       *  @param k covariances, may be the same vector as d2
+       *  @param ws scratch vectors
+       *  @return false if the covariance function does not support distances */
+      virtual bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                          Eigen::Ref<Eigen::VectorXd> k, Workspace &ws);
+
+      /** Check if get_row_from_distances() is supported.
+       *  @return true if the covariance depends on the inputs only through
+       *  their squared euclidean distance and their identity */
+      virtual bool supports_distances();
+
+      /** Check if the covariance function has the form
+       *  \f$ sf^2 k_0(x_1, x_2) + s^2 \delta(x_1, x_2) \f$ with
+       *  sf = exp(loghyper(scale)) and s = exp(loghyper(noise)), where
+       *  \f$\delta\f$ is one for identical input vectors only and \f$k_0\f$
+       *  depends on neither parameter. A missing term has index -1.
+       *  @param scale index of the log signal standard deviation
+       *  @param noise index of the log noise standard deviation
+       *  @return false if the covariance function has a different form */
+      virtual bool scale_noise_form(int &scale, int &noise);
+
+      /** Check if the covariance function is a finite sum of weighted features
+       *  \f$ \sum_j w_j^2 \phi_j(x_1) \phi_j(x_2) + s^2 \delta(x_1, x_2) \f$
+       *  with \f$ w_j \f$ = exp(-loghyper(param_j)) and s = exp(loghyper(noise)),
+       *  where the features \f$\phi_j\f$ depend on no parameter (see
+       *  features() and feature_params()). A missing noise term has index -1.
+       *  @param features number of features
+       *  @param noise index of the log noise standard deviation
+       *  @return false if the covariance function has a different form */
+      virtual bool feature_form(int &features, int &noise);
+
+      /** Unweighted features of an input vector, only valid if
+       *  feature_form() returns true.
+       *  @param x input vector
+       *  @param phi features */
+      virtual void features(const Eigen::VectorXd &x, Eigen::Ref<Eigen::VectorXd> phi);
+
+      /** Indices of the parameters weighting the features, only valid if
+       *  feature_form() returns true.
+       *  @param param parameter index for each feature */
+      virtual void feature_params(Eigen::Ref<Eigen::VectorXi> param);
+
       /** Update parameter vector.
        *  @param p new parameter vector */
       virtual void set_loghyper(const Eigen::VectorXd &p);
@@ -83,6 +190,12 @@ namespace libgp
        *  @return log-hyperparameter */
       Eigen::VectorXd get_loghyper();
 
+      /** Deep copy with the same hyperparameters. The default recreates the
+       *  covariance function from to_string(), the covariance functions of
+       *  the library copy their state directly.
+       *  @return new instance, owned by the caller */
+      virtual CovarianceFunction * clone();
+
       /** Returns a string representation of this covariance function.
        *  @return string containing the name of this covariance function */
       virtual std::string to_string() = 0;
@@ -93,6 +206,10 @@ namespace libgp
       bool loghyper_changed;
 
     protected:
+      /** Squared euclidean distances d(i) of x and X[i]. */
+      static void squared_distances(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                                    Eigen::Ref<Eigen::VectorXd> d);
+
       /** Input dimensionality. */
       size_t input_dim;
 
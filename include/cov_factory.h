@@ -37,9 +37,33 @@ namespace libgp {
     /** Returns a string vector of available covariance functions. */
     std::vector<std::string> list();
     
-  private:
     typedef CovarianceFunction*(*create_func_def)();
+
+  private:
+
+    /** Register specializations for input dimensionality 1..max_fixed_dim. */
+    template <template <int> class ClassName> void register_fixed(const std::string & func);
+
+    /** Create uninitialized instance, the fixed dimension specialization
+     *  is preferred if available and fixed is true. */
+    CovarianceFunction * create_instance(const std::string & func, size_t input_dim, bool fixed);
+
+    /** Register a compile-time kernel expression (see cov_static.h) as
+     *  replacement for the covariance function tree it describes. */
+    template <class Expr> void register_static();
+
+    /** Create instance of a registered kernel expression or return NULL.
+     *  @param trimmed string representation without whitespace */
+    CovarianceFunction * create_static(const std::string & trimmed, size_t input_dim);
+
     std::map<std::string , CovFactory::create_func_def> registry;
+
+    /** Fixed dimension specializations, indexed by input dimensionality - 1. */
+    std::map<std::string, std::vector<CovFactory::create_func_def> > fixed_registry;
+
+    /** Kernel expressions, index 0 holds the instance for arbitrary input
+     *  dimensionality and index D the instance for dimensionality D. */
+    std::map<std::string, std::vector<CovFactory::create_func_def> > static_registry;
   };
 }
 
@@ -0,0 +1,352 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __COV_FIXED_H__
+#define __COV_FIXED_H__
+
+#include <cmath>
+#include <Eigen/Dense>
+
+#include "cov.h"
+#include "cov_se_iso.h"
+#include "cov_se_ard.h"
+#include "cov_matern3_iso.h"
+#include "cov_matern5_iso.h"
+#include "cov_rq_iso.h"
+#include "cov_noise.h"
+#include "cov_sum.h"
+#include "cov_prod.h"
+#include "simd_math.h"
+
+namespace libgp
+{
+
+  /** Largest input dimensionality for which CovFactory creates fixed
+   *  dimension specializations. */
+  const int max_fixed_dim = 8;
+
+  /** Common base of all fixed dimension specializations. */
+  class CovFixedBase
+  {
+  public:
+    virtual ~CovFixedBase() {}
+  };
+
+  /** Interface of covariance functions specialized for inputs of fixed
+   *  dimensionality D. The inputs are stack allocated and all distance
+   *  computations are unrolled at compile time.
+   *  @ingroup cov_group */
+  template <int D> class CovFixed : public CovFixedBase
+  {
+  public:
+    typedef Eigen::Matrix<double, D, 1> Input;
+
+    virtual ~CovFixed() {}
+
+    /** Computes the covariance of two input vectors.
+     *  @param same true if x1 and x2 refer to the same sample */
+    virtual double get_fixed(const Input &x1, const Input &x2, bool same) = 0;
+
+    /** Covariance gradient of two input vectors with respect to the hyperparameters.
+     *  @param same true if x1 and x2 refer to the same sample */
+    virtual void grad_fixed(const Input &x1, const Input &x2, bool same, Eigen::Ref<Eigen::VectorXd> grad) = 0;
+  };
+
+  /** Routes the dynamic interface of covariance function Cov to the
+   *  fixed dimension implementation. */
+  template <class Cov, int D> class CovFixedAdapter : public Cov, public CovFixed<D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    double get(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2)
+    {
+      return this->get_fixed(x1, x2, &x1 == &x2);
+    }
+
+    void grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::VectorXd &grad)
+    {
+      this->grad_fixed(x1, x2, &x1 == &x2, grad);
+    }
+
+    void value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                        Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] CovarianceFunction::Workspace &ws)
+    {
+      bool same = &x1 == &x2;
+      Input a = x1, b = x2;
+      k = this->get_fixed(a, b, same);
+      this->grad_fixed(a, b, same, grad);
+    }
+
+    /** Squared distances are computed for fixed size inputs and the
+     *  covariances of the whole row by get_row_from_distances(), which
+     *  evaluates the transcendental functions with simd_math.h. Other
+     *  covariance functions use the row of Cov, composites thereby the
+     *  rows of their fixed dimension operands. */
+    void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                 Eigen::Ref<Eigen::VectorXd> k, CovarianceFunction::Workspace &ws)
+    {
+      if (!this->supports_distances()) return Cov::get_row(x, X, k, ws);
+      Input a = x;
+      for (int i = 0; i < k.size(); ++i) k(i) = (a - Eigen::Map<const Input>(X[i]->data())).squaredNorm();
+      this->get_row_from_distances(k, false, k, ws);
+      // input vectors identical to x are not identified by their distance
+      for (int i = 0; i < k.size(); ++i) {
+        if (X[i] == &x) k(i) = this->get_fixed(a, a, true);
+      }
+    }
+  };
+
+  template <int D> class CovSEisoFixed : public CovFixedAdapter<CovSEiso, D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    double get_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same)
+    {
+      double z = (x1 - x2).squaredNorm() / (this->ell * this->ell);
+      return this->sf2 * exp(-0.5 * z);
+    }
+
+    void grad_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::VectorXd> grad)
+    {
+      double z = (x1 - x2).squaredNorm() / (this->ell * this->ell);
+      double k = this->sf2 * exp(-0.5 * z);
+      grad(0) = k * z;
+      grad(1) = 2 * k;
+    }
+
+    CovarianceFunction * clone()
+    {
+      return new CovSEisoFixed(*this);
+    }
+  };
+
+  template <int D> class CovSEardFixed : public CovFixedAdapter<CovSEard, D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    double get_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same)
+    {
+      double z = (x1 - x2).cwiseProduct(inv_ell).squaredNorm();
+      return this->sf2 * exp(-0.5 * z);
+    }
+
+    void grad_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::VectorXd> grad)
+    {
+      Input z = (x1 - x2).cwiseProduct(inv_ell).array().square();
+      double k = this->sf2 * exp(-0.5 * z.sum());
+      grad.template head<D>() = z * k;
+      grad(D) = 2.0 * k;
+    }
+
+    void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                 Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws)
+    {
+      Input a = x;
+      for (int i = 0; i < k.size(); ++i) {
+        k(i) = (a - Eigen::Map<const Input>(X[i]->data())).cwiseProduct(inv_ell).squaredNorm();
+      }
+      k *= -0.5;
+      simd::exp(k.data(), k.data(), k.size());
+      k *= this->sf2;
+    }
+
+    CovarianceFunction * clone()
+    {
+      return new CovSEardFixed(*this);
+    }
+
+    void set_loghyper(const Eigen::VectorXd &p)
+    {
+      CovSEard::set_loghyper(p);
+      inv_ell = this->ell.cwiseInverse();
+    }
+
+  private:
+    Input inv_ell;
+  };
+
+  template <int D> class CovMatern3isoFixed : public CovFixedAdapter<CovMatern3iso, D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    double get_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same)
+    {
+      double z = this->sqrt3 * (x1 - x2).norm() / this->ell;
+      return this->sf2 * exp(-z) * (1 + z);
+    }
+
+    void grad_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::VectorXd> grad)
+    {
+      double z = this->sqrt3 * (x1 - x2).norm() / this->ell;
+      double k = this->sf2 * exp(-z);
+      grad(0) = k * z * z;
+      grad(1) = 2 * k * (1 + z);
+    }
+
+    CovarianceFunction * clone()
+    {
+      return new CovMatern3isoFixed(*this);
+    }
+  };
+
+  template <int D> class CovMatern5isoFixed : public CovFixedAdapter<CovMatern5iso, D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    double get_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same)
+    {
+      double z = this->sqrt5 * (x1 - x2).norm() / this->ell;
+      return this->sf2 * exp(-z) * (1 + z + z * z / 3);
+    }
+
+    void grad_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::VectorXd> grad)
+    {
+      double z = this->sqrt5 * (x1 - x2).norm() / this->ell;
+      double k = this->sf2 * exp(-z);
+      double z_square = z * z;
+      grad(0) = k * (z_square + z_square * z) / 3;
+      grad(1) = 2 * k * (1 + z + z_square / 3);
+    }
+
+    CovarianceFunction * clone()
+    {
+      return new CovMatern5isoFixed(*this);
+    }
+  };
+
+  template <int D> class CovRQisoFixed : public CovFixedAdapter<CovRQiso, D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    double get_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same)
+    {
+      double z = (x1 - x2).squaredNorm() / (this->ell * this->ell);
+      return this->sf2 * pow(1 + 0.5 * z / this->alpha, -this->alpha);
+    }
+
+    void grad_fixed(const Input &x1, const Input &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::VectorXd> grad)
+    {
+      double z = (x1 - x2).squaredNorm() / (this->ell * this->ell);
+      double k = 1 + 0.5 * z / this->alpha;
+      double sf2_k = this->sf2 * pow(k, -this->alpha);
+      grad(0) = sf2_k * z / k;
+      grad(1) = 2 * sf2_k;
+      grad(2) = sf2_k * (0.5 * z / k - this->alpha * log(k));
+    }
+
+    CovarianceFunction * clone()
+    {
+      return new CovRQisoFixed(*this);
+    }
+  };
+
+  template <int D> class CovNoiseFixed : public CovFixedAdapter<CovNoise, D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    double get_fixed([[maybe_unused]] const Input &x1, [[maybe_unused]] const Input &x2, bool same)
+    {
+      return same ? this->s2 : 0.0;
+    }
+
+    void grad_fixed([[maybe_unused]] const Input &x1, [[maybe_unused]] const Input &x2, bool same,
+                    Eigen::Ref<Eigen::VectorXd> grad)
+    {
+      grad(0) = same ? 2 * this->s2 : 0.0;
+    }
+
+    CovarianceFunction * clone()
+    {
+      return new CovNoiseFixed(*this);
+    }
+  };
+
+  /** Sum of two fixed dimension covariance functions. */
+  template <int D> class CovSumFixed : public CovFixedAdapter<CovSum, D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    bool init(int n, CovarianceFunction * first, CovarianceFunction * second)
+    {
+      fixed_first = dynamic_cast<CovFixed<D> *>(first);
+      fixed_second = dynamic_cast<CovFixed<D> *>(second);
+      return CovSum::init(n, first, second) && fixed_first != NULL && fixed_second != NULL;
+    }
+
+    double get_fixed(const Input &x1, const Input &x2, bool same)
+    {
+      return fixed_first->get_fixed(x1, x2, same) + fixed_second->get_fixed(x1, x2, same);
+    }
+
+    void grad_fixed(const Input &x1, const Input &x2, bool same, Eigen::Ref<Eigen::VectorXd> grad)
+    {
+      fixed_first->grad_fixed(x1, x2, same, grad.head(this->param_dim_first));
+      fixed_second->grad_fixed(x1, x2, same, grad.tail(this->param_dim_second));
+    }
+
+    CovarianceFunction * clone()
+    {
+      CovSumFixed * copy = new CovSumFixed();
+      copy->init(this->input_dim, this->first->clone(), this->second->clone());
+      copy->loghyper = this->loghyper;
+      copy->loghyper_changed = this->loghyper_changed;
+      return copy;
+    }
+
+  private:
+    CovFixed<D> * fixed_first;
+    CovFixed<D> * fixed_second;
+  };
+
+  /** Product of two fixed dimension covariance functions. */
+  template <int D> class CovProdFixed : public CovFixedAdapter<CovProd, D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    bool init(int n, CovarianceFunction * first, CovarianceFunction * second)
+    {
+      fixed_first = dynamic_cast<CovFixed<D> *>(first);
+      fixed_second = dynamic_cast<CovFixed<D> *>(second);
+      return CovProd::init(n, first, second) && fixed_first != NULL && fixed_second != NULL;
+    }
+
+    double get_fixed(const Input &x1, const Input &x2, bool same)
+    {
+      return fixed_first->get_fixed(x1, x2, same) * fixed_second->get_fixed(x1, x2, same);
+    }
+
+    void grad_fixed(const Input &x1, const Input &x2, bool same, Eigen::Ref<Eigen::VectorXd> grad)
+    {
+      fixed_first->grad_fixed(x1, x2, same, grad.head(this->param_dim_first));
+      fixed_second->grad_fixed(x1, x2, same, grad.tail(this->param_dim_second));
+      grad.head(this->param_dim_first) *= fixed_second->get_fixed(x1, x2, same);
+      grad.tail(this->param_dim_second) *= fixed_first->get_fixed(x1, x2, same);
+    }
+
+    CovarianceFunction * clone()
+    {
+      CovProdFixed * copy = new CovProdFixed();
+      copy->init(this->input_dim, this->first->clone(), this->second->clone());
+      copy->loghyper = this->loghyper;
+      copy->loghyper_changed = this->loghyper_changed;
+      return copy;
+    }
+
+  private:
+    CovFixed<D> * fixed_first;
+    CovFixed<D> * fixed_second;
+  };
+
+}
+
+#endif /* __COV_FIXED_H__ */
@@ -23,7 +23,14 @@ namespace libgp
     bool init(int n);
     double get(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2);
     void grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::VectorXd &grad);
+    void value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                        Eigen::Ref<Eigen::VectorXd> grad, Workspace &ws);
+    void hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess);
+    bool feature_form(int &features, int &noise);
+    void features(const Eigen::VectorXd &x, Eigen::Ref<Eigen::VectorXd> phi);
+    void feature_params(Eigen::Ref<Eigen::VectorXi> param);
     void set_loghyper(const Eigen::VectorXd &p);
+    CovarianceFunction * clone();
     virtual std::string to_string();
   private:
     Eigen::VectorXd ell;
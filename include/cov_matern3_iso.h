@@ -22,9 +22,19 @@ namespace libgp
     bool init(int n);
     double get(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2);
     void grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::VectorXd &grad);
+    void value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                        Eigen::Ref<Eigen::VectorXd> grad, Workspace &ws);
+    void hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess);
+    void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                 Eigen::Ref<Eigen::VectorXd> k, Workspace &ws);
+    bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                Eigen::Ref<Eigen::VectorXd> k, Workspace &ws);
+    bool supports_distances();
+    bool scale_noise_form(int &scale, int &noise);
     void set_loghyper(const Eigen::VectorXd &p);
+    CovarianceFunction * clone();
     virtual std::string to_string();
-  private:
+  protected:
     double ell;
     double sf2;
     double sqrt3;
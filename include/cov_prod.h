@@ -20,9 +20,18 @@ namespace libgp
     bool init(int n, CovarianceFunction * first, CovarianceFunction * second);
     double get(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2);
     void grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::VectorXd &grad);
+    void value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                        Eigen::Ref<Eigen::VectorXd> grad, Workspace &ws);
+    void hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess);
+    void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                 Eigen::Ref<Eigen::VectorXd> k, Workspace &ws);
+    bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                Eigen::Ref<Eigen::VectorXd> k, Workspace &ws);
+    bool supports_distances();
     void set_loghyper(const Eigen::VectorXd &p);
+    CovarianceFunction * clone();
     virtual std::string to_string();
-  private:
+  protected:
     size_t param_dim_first;
     size_t param_dim_second;
     CovarianceFunction * first;
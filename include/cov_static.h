@@ -0,0 +1,969 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __COV_STATIC_H__
+#define __COV_STATIC_H__
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <Eigen/Dense>
+
+#include "cov.h"
+#include "cov_fixed.h"
+#include "simd_math.h"
+
+namespace libgp
+{
+
+  /** Covariance function expressions composed at compile time.
+   *  Each expression provides the interface
+   *    - init(input_dim) returning false for unsupported inputs,
+   *      param_dim() and to_string()
+   *    - set_loghyper(p) with p pointing to param_dim() values
+   *    - get(x1, x2, same) returning the covariance
+   *    - value_and_grad(x1, x2, same, grad) returning the covariance and
+   *      writing the param_dim() partial derivatives to grad
+   *    - hessian(x1, x2, same, hess) writing the second derivatives
+   *    - get_row(x, X, k, ws), get_row_from_distances(d2, self, k, ws),
+   *      supports_distances(), scale_noise_form(scale, noise) and
+   *      feature_form(features, noise) as the methods of CovarianceFunction
+   *    - features(x, phi) and feature_params(param) writing to arrays
+   *  without virtual functions, so that composite kernels like
+   *  Sum<SEiso, Noise> are inlined completely and value and gradient are
+   *  evaluated in one pass. The parameters, their order and to_string()
+   *  are identical to the corresponding dynamic covariance functions.
+   *  Use CovStatic to turn an expression into a CovarianceFunction. */
+  namespace expr
+  {
+
+    /** Defaults shared by all expressions: no kernel rows from distances,
+     *  no scale and noise form and no feature form. Expressions hide the
+     *  methods they support. */
+    class Base
+    {
+    public:
+      bool init([[maybe_unused]] int input_dim) { return true; }
+
+      static bool supports_distances() { return false; }
+
+      bool get_row_from_distances([[maybe_unused]] const Eigen::Ref<const Eigen::VectorXd> &d2,
+                                  [[maybe_unused]] bool self, [[maybe_unused]] Eigen::Ref<Eigen::VectorXd> k,
+                                  [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        return false;
+      }
+
+      bool scale_noise_form(int &scale, int &noise) const
+      {
+        scale = noise = -1;
+        return false;
+      }
+
+      bool feature_form(int &features, int &noise) const
+      {
+        features = 0;
+        noise = -1;
+        return false;
+      }
+
+      void features([[maybe_unused]] const Eigen::VectorXd &x, [[maybe_unused]] double phi[]) const {}
+
+      void feature_params([[maybe_unused]] int param[]) const {}
+    };
+
+    /** Squared exponential, see CovSEiso. */
+    class SEiso : public Base
+    {
+    public:
+      static size_t param_dim() { return 2; }
+      static std::string to_string() { return "CovSEiso"; }
+
+      void set_loghyper(const double p[])
+      {
+        inv_ell2 = exp(-2 * p[0]);
+        sf2 = exp(2 * p[1]);
+      }
+
+      template <class V1, class V2>
+      double get(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same) const
+      {
+        return sf2 * exp(-0.5 * (x1 - x2).squaredNorm() * inv_ell2);
+      }
+
+      template <class V1, class V2>
+      double value_and_grad(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, double grad[]) const
+      {
+        double z = (x1 - x2).squaredNorm() * inv_ell2;
+        double k = sf2 * exp(-0.5 * z);
+        grad[0] = k * z;
+        grad[1] = 2 * k;
+        return k;
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        for (int i = 0; i < k.size(); ++i) k(i) = (x - *X[i]).squaredNorm() * (-0.5 * inv_ell2);
+        simd::exp(k.data(), k.data(), k.size());
+        k *= sf2;
+      }
+
+      static bool supports_distances() { return true; }
+
+      bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, [[maybe_unused]] bool self,
+                                  Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        k = d2 * (-0.5 * inv_ell2);
+        simd::exp(k.data(), k.data(), k.size());
+        k *= sf2;
+        return true;
+      }
+
+      template <class V1, class V2>
+      void hessian(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        double z = (x1 - x2).squaredNorm() * inv_ell2;
+        double k = sf2 * exp(-0.5 * z);
+        hess(0, 0) = k * z * (z - 2);
+        hess(0, 1) = hess(1, 0) = 2 * k * z;
+        hess(1, 1) = 4 * k;
+      }
+
+      bool scale_noise_form(int &scale, int &noise) const
+      {
+        scale = 1;
+        noise = -1;
+        return true;
+      }
+
+    private:
+      double inv_ell2, sf2;
+    };
+
+    /** Squared exponential with automatic relevance detection, see CovSEard. */
+    class SEard : public Base
+    {
+    public:
+      bool init(int input_dim)
+      {
+        inv_ell.resize(input_dim);
+        return true;
+      }
+
+      size_t param_dim() const { return inv_ell.size() + 1; }
+      static std::string to_string() { return "CovSEard"; }
+
+      void set_loghyper(const double p[])
+      {
+        for (int i = 0; i < inv_ell.size(); ++i) inv_ell(i) = exp(-p[i]);
+        sf2 = exp(2 * p[inv_ell.size()]);
+      }
+
+      template <class V1, class V2>
+      double get(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same) const
+      {
+        return sf2 * exp(-0.5 * (x1 - x2).cwiseProduct(inv_ell).squaredNorm());
+      }
+
+      template <class V1, class V2>
+      double value_and_grad(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, double grad[]) const
+      {
+        int n = inv_ell.size();
+        Eigen::Map<Eigen::VectorXd> z(grad, n);
+        z = (x1 - x2).cwiseProduct(inv_ell).array().square();
+        double k = sf2 * exp(-0.5 * z.sum());
+        z *= k;
+        grad[n] = 2 * k;
+        return k;
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        for (int i = 0; i < k.size(); ++i) k(i) = (x - *X[i]).cwiseProduct(inv_ell).squaredNorm() * -0.5;
+        simd::exp(k.data(), k.data(), k.size());
+        k *= sf2;
+      }
+
+      template <class V1, class V2>
+      void hessian(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        int n = inv_ell.size();
+        Eigen::VectorXd z = (x1 - x2).cwiseProduct(inv_ell).array().square();
+        double k = sf2 * exp(-0.5 * z.sum());
+        hess.topLeftCorner(n, n) = k * z * z.transpose();
+        hess.topLeftCorner(n, n).diagonal() -= 2 * k * z;
+        hess.col(n).head(n) = 2 * k * z;
+        hess.row(n).head(n) = 2 * k * z.transpose();
+        hess(n, n) = 4 * k;
+      }
+
+      bool scale_noise_form(int &scale, int &noise) const
+      {
+        scale = inv_ell.size();
+        noise = -1;
+        return true;
+      }
+
+    private:
+      Eigen::VectorXd inv_ell;
+      double sf2;
+    };
+
+    /** Matern with nu = 3/2, see CovMatern3iso. */
+    class Matern3iso : public Base
+    {
+    public:
+      static size_t param_dim() { return 2; }
+      static std::string to_string() { return "CovMatern3iso"; }
+
+      void set_loghyper(const double p[])
+      {
+        sqrt3_ell = sqrt(3.0) * exp(-p[0]);
+        sf2 = exp(2 * p[1]);
+      }
+
+      template <class V1, class V2>
+      double get(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same) const
+      {
+        double z = (x1 - x2).norm() * sqrt3_ell;
+        return sf2 * exp(-z) * (1 + z);
+      }
+
+      template <class V1, class V2>
+      double value_and_grad(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, double grad[]) const
+      {
+        double z = (x1 - x2).norm() * sqrt3_ell;
+        double k = sf2 * exp(-z);
+        grad[0] = k * z * z;
+        grad[1] = 2 * k * (1 + z);
+        return k * (1 + z);
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, CovarianceFunction::Workspace &ws) const
+      {
+        Eigen::VectorXd & e = ws.acquire(k.size());
+        for (int i = 0; i < k.size(); ++i) k(i) = (x - *X[i]).norm() * sqrt3_ell;
+        e = -k;
+        simd::exp(e.data(), e.data(), e.size());
+        k = (sf2 * e.array() * (1 + k.array())).matrix();
+        ws.release();
+      }
+
+      static bool supports_distances() { return true; }
+
+      bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, [[maybe_unused]] bool self,
+                                  Eigen::Ref<Eigen::VectorXd> k, CovarianceFunction::Workspace &ws) const
+      {
+        Eigen::VectorXd & e = ws.acquire(k.size());
+        k = d2.cwiseSqrt() * sqrt3_ell;
+        e = -k;
+        simd::exp(e.data(), e.data(), e.size());
+        k = (sf2 * e.array() * (1 + k.array())).matrix();
+        ws.release();
+        return true;
+      }
+
+      template <class V1, class V2>
+      void hessian(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        double z = (x1 - x2).norm() * sqrt3_ell;
+        double e = sf2 * exp(-z);
+        hess(0, 0) = e * z * z * (z - 2);
+        hess(0, 1) = hess(1, 0) = 2 * e * z * z;
+        hess(1, 1) = 4 * e * (1 + z);
+      }
+
+      bool scale_noise_form(int &scale, int &noise) const
+      {
+        scale = 1;
+        noise = -1;
+        return true;
+      }
+
+    private:
+      double sqrt3_ell, sf2;
+    };
+
+    /** Matern with nu = 5/2, see CovMatern5iso. */
+    class Matern5iso : public Base
+    {
+    public:
+      static size_t param_dim() { return 2; }
+      static std::string to_string() { return "CovMatern5iso"; }
+
+      void set_loghyper(const double p[])
+      {
+        sqrt5_ell = sqrt(5.0) * exp(-p[0]);
+        sf2 = exp(2 * p[1]);
+      }
+
+      template <class V1, class V2>
+      double get(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same) const
+      {
+        double z = (x1 - x2).norm() * sqrt5_ell;
+        return sf2 * exp(-z) * (1 + z + z * z / 3);
+      }
+
+      template <class V1, class V2>
+      double value_and_grad(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, double grad[]) const
+      {
+        double z = (x1 - x2).norm() * sqrt5_ell;
+        double k = sf2 * exp(-z);
+        double z_square = z * z;
+        grad[0] = k * (z_square + z_square * z) / 3;
+        grad[1] = 2 * k * (1 + z + z_square / 3);
+        return k * (1 + z + z_square / 3);
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, CovarianceFunction::Workspace &ws) const
+      {
+        Eigen::VectorXd & e = ws.acquire(k.size());
+        for (int i = 0; i < k.size(); ++i) k(i) = (x - *X[i]).norm() * sqrt5_ell;
+        e = -k;
+        simd::exp(e.data(), e.data(), e.size());
+        k = (sf2 * e.array() * (1 + k.array() + k.array().square() / 3)).matrix();
+        ws.release();
+      }
+
+      static bool supports_distances() { return true; }
+
+      bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, [[maybe_unused]] bool self,
+                                  Eigen::Ref<Eigen::VectorXd> k, CovarianceFunction::Workspace &ws) const
+      {
+        Eigen::VectorXd & e = ws.acquire(k.size());
+        k = d2.cwiseSqrt() * sqrt5_ell;
+        e = -k;
+        simd::exp(e.data(), e.data(), e.size());
+        k = (sf2 * e.array() * (1 + k.array() + k.array().square() / 3)).matrix();
+        ws.release();
+        return true;
+      }
+
+      template <class V1, class V2>
+      void hessian(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        double z = (x1 - x2).norm() * sqrt5_ell;
+        double e = sf2 * exp(-z);
+        double z_square = z * z;
+        hess(0, 0) = e * z_square * (z_square - 2 * z - 2) / 3;
+        hess(0, 1) = hess(1, 0) = 2 * e * (z_square + z_square * z) / 3;
+        hess(1, 1) = 4 * e * (1 + z + z_square / 3);
+      }
+
+      bool scale_noise_form(int &scale, int &noise) const
+      {
+        scale = 1;
+        noise = -1;
+        return true;
+      }
+
+    private:
+      double sqrt5_ell, sf2;
+    };
+
+    /** Rational quadratic, see CovRQiso. */
+    class RQiso : public Base
+    {
+    public:
+      static size_t param_dim() { return 3; }
+      static std::string to_string() { return "CovRQiso"; }
+
+      void set_loghyper(const double p[])
+      {
+        inv_ell2 = exp(-2 * p[0]);
+        sf2 = exp(2 * p[1]);
+        alpha = exp(p[2]);
+      }
+
+      template <class V1, class V2>
+      double get(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same) const
+      {
+        double z = (x1 - x2).squaredNorm() * inv_ell2;
+        return sf2 * pow(1 + 0.5 * z / alpha, -alpha);
+      }
+
+      template <class V1, class V2>
+      double value_and_grad(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, double grad[]) const
+      {
+        double z = (x1 - x2).squaredNorm() * inv_ell2;
+        double b = 1 + 0.5 * z / alpha;
+        double log_b = log(b);
+        double k = sf2 * exp(-alpha * log_b);
+        grad[0] = k * z / b;
+        grad[1] = 2 * k;
+        grad[2] = k * (0.5 * z / b - alpha * log_b);
+        return k;
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        for (int i = 0; i < k.size(); ++i) k(i) = 1 + 0.5 * (x - *X[i]).squaredNorm() * inv_ell2 / alpha;
+        simd::log(k.data(), k.data(), k.size());
+        k *= -alpha;
+        simd::exp(k.data(), k.data(), k.size());
+        k *= sf2;
+      }
+
+      static bool supports_distances() { return true; }
+
+      bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, [[maybe_unused]] bool self,
+                                  Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        k = (1 + d2.array() * (0.5 * inv_ell2 / alpha)).matrix();
+        simd::log(k.data(), k.data(), k.size());
+        k *= -alpha;
+        simd::exp(k.data(), k.data(), k.size());
+        k *= sf2;
+        return true;
+      }
+
+      template <class V1, class V2>
+      void hessian(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        double z = (x1 - x2).squaredNorm() * inv_ell2;
+        double u = 0.5 * z / alpha;
+        double b = 1 + u;
+        double log_b = log(b);
+        double k = sf2 * exp(-alpha * log_b);
+        double g0 = k * z / b;
+        double g2 = k * (0.5 * z / b - alpha * log_b);
+        hess(0, 0) = g0 * g0 / k - 2 * k * z / (b * b);
+        hess(0, 1) = hess(1, 0) = 2 * g0;
+        hess(0, 2) = hess(2, 0) = g0 * g2 / k + k * z * u / (b * b);
+        hess(1, 1) = 4 * k;
+        hess(1, 2) = hess(2, 1) = 2 * g2;
+        hess(2, 2) = g2 * g2 / k + k * alpha * (u * u / (b * b) + u / b - log_b);
+      }
+
+      bool scale_noise_form(int &scale, int &noise) const
+      {
+        scale = 1;
+        noise = -1;
+        return true;
+      }
+
+    private:
+      double inv_ell2, sf2, alpha;
+    };
+
+    /** Linear covariance function, see CovLinearone. */
+    class Linearone : public Base
+    {
+    public:
+      bool init(int input_dim)
+      {
+        dim = input_dim;
+        return true;
+      }
+
+      static size_t param_dim() { return 1; }
+      static std::string to_string() { return "CovLinearone"; }
+
+      void set_loghyper(const double p[])
+      {
+        it2 = exp(-2 * p[0]);
+      }
+
+      template <class V1, class V2>
+      double get(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same) const
+      {
+        return it2 * (1 + x1.dot(x2));
+      }
+
+      template <class V1, class V2>
+      double value_and_grad(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, double grad[]) const
+      {
+        double k = it2 * (1 + x1.dot(x2));
+        grad[0] = -2 * k;
+        return k;
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        for (int i = 0; i < k.size(); ++i) k(i) = it2 * (1 + x.dot(*X[i]));
+      }
+
+      template <class V1, class V2>
+      void hessian(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        hess(0, 0) = 4 * it2 * (1 + x1.dot(x2));
+      }
+
+      bool feature_form(int &features, int &noise) const
+      {
+        features = dim + 1;
+        noise = -1;
+        return true;
+      }
+
+      void features(const Eigen::VectorXd &x, double phi[]) const
+      {
+        phi[0] = 1;
+        for (int i = 0; i < dim; ++i) phi[i + 1] = x(i);
+      }
+
+      void feature_params(int param[]) const
+      {
+        for (int i = 0; i <= dim; ++i) param[i] = 0;
+      }
+
+    private:
+      double it2;
+      int dim;
+    };
+
+    /** White noise, see CovNoise. Nonzero only for the same sample. */
+    class Noise : public Base
+    {
+    public:
+      static size_t param_dim() { return 1; }
+      static std::string to_string() { return "CovNoise"; }
+
+      void set_loghyper(const double p[])
+      {
+        s2 = exp(2 * p[0]);
+      }
+
+      template <class V1, class V2>
+      double get([[maybe_unused]] const V1 &x1, [[maybe_unused]] const V2 &x2, bool same) const
+      {
+        return same ? s2 : 0.0;
+      }
+
+      template <class V1, class V2>
+      double value_and_grad([[maybe_unused]] const V1 &x1, [[maybe_unused]] const V2 &x2, bool same, double grad[]) const
+      {
+        grad[0] = same ? 2 * s2 : 0.0;
+        return same ? s2 : 0.0;
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        for (int i = 0; i < k.size(); ++i) k(i) = (X[i] == &x) ? s2 : 0.0;
+      }
+
+      static bool supports_distances() { return true; }
+
+      bool get_row_from_distances([[maybe_unused]] const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                  Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        k.setZero();
+        if (self && k.size() > 0) k(0) = s2;
+        return true;
+      }
+
+      template <class V1, class V2>
+      void hessian([[maybe_unused]] const V1 &x1, [[maybe_unused]] const V2 &x2, bool same,
+                   Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        hess(0, 0) = same ? 4 * s2 : 0.0;
+      }
+
+      bool scale_noise_form(int &scale, int &noise) const
+      {
+        scale = -1;
+        noise = 0;
+        return true;
+      }
+
+      bool feature_form(int &features, int &noise) const
+      {
+        features = 0;
+        noise = 0;
+        return true;
+      }
+
+    private:
+      double s2;
+    };
+
+    /** Sum of two covariance functions, see CovSum. */
+    template <class A, class B> class Sum : public Base
+    {
+    public:
+      bool init(int input_dim) { return a.init(input_dim) && b.init(input_dim); }
+
+      size_t param_dim() const { return a.param_dim() + b.param_dim(); }
+
+      std::string to_string() const
+      {
+        return "CovSum(" + a.to_string() + ", " + b.to_string() + ")";
+      }
+
+      void set_loghyper(const double p[])
+      {
+        a.set_loghyper(p);
+        b.set_loghyper(p + a.param_dim());
+      }
+
+      template <class V1, class V2>
+      double get(const V1 &x1, const V2 &x2, bool same) const
+      {
+        return a.get(x1, x2, same) + b.get(x1, x2, same);
+      }
+
+      template <class V1, class V2>
+      double value_and_grad(const V1 &x1, const V2 &x2, bool same, double grad[]) const
+      {
+        return a.value_and_grad(x1, x2, same, grad)
+             + b.value_and_grad(x1, x2, same, grad + a.param_dim());
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, CovarianceFunction::Workspace &ws) const
+      {
+        Eigen::VectorXd & k_b = ws.acquire(k.size());
+        a.get_row(x, X, k, ws);
+        b.get_row(x, X, k_b, ws);
+        k += k_b;
+        ws.release();
+      }
+
+      bool supports_distances() const { return a.supports_distances() && b.supports_distances(); }
+
+      bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                  Eigen::Ref<Eigen::VectorXd> k, CovarianceFunction::Workspace &ws) const
+      {
+        Eigen::VectorXd & k_b = ws.acquire(k.size());
+        bool supported = b.get_row_from_distances(d2, self, k_b, ws) && a.get_row_from_distances(d2, self, k, ws);
+        if (supported) k += k_b;
+        ws.release();
+        return supported;
+      }
+
+      template <class V1, class V2>
+      void hessian(const V1 &x1, const V2 &x2, bool same, Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        size_t n = a.param_dim(), m = b.param_dim();
+        hess.setZero();
+        a.hessian(x1, x2, same, hess.topLeftCorner(n, n));
+        b.hessian(x1, x2, same, hess.bottomRightCorner(m, m));
+      }
+
+      bool scale_noise_form(int &scale, int &noise) const
+      {
+        int scale_a, noise_a, scale_b, noise_b;
+        scale = noise = -1;
+        if (!a.scale_noise_form(scale_a, noise_a) || !b.scale_noise_form(scale_b, noise_b)) return false;
+        if ((scale_a >= 0 && scale_b >= 0) || (noise_a >= 0 && noise_b >= 0)) return false;
+        if (scale_a >= 0) scale = scale_a;
+        if (scale_b >= 0) scale = a.param_dim() + scale_b;
+        if (noise_a >= 0) noise = noise_a;
+        if (noise_b >= 0) noise = a.param_dim() + noise_b;
+        return true;
+      }
+
+      bool feature_form(int &features, int &noise) const
+      {
+        int features_a, noise_a, features_b, noise_b;
+        features = 0;
+        noise = -1;
+        if (!a.feature_form(features_a, noise_a) || !b.feature_form(features_b, noise_b)) return false;
+        if (noise_a >= 0 && noise_b >= 0) return false;
+        features = features_a + features_b;
+        if (noise_a >= 0) noise = noise_a;
+        if (noise_b >= 0) noise = a.param_dim() + noise_b;
+        return true;
+      }
+
+      void features(const Eigen::VectorXd &x, double phi[]) const
+      {
+        int features_a, noise_a;
+        a.feature_form(features_a, noise_a);
+        a.features(x, phi);
+        b.features(x, phi + features_a);
+      }
+
+      void feature_params(int param[]) const
+      {
+        int features_a, noise_a, features_b, noise_b;
+        a.feature_form(features_a, noise_a);
+        b.feature_form(features_b, noise_b);
+        a.feature_params(param);
+        b.feature_params(param + features_a);
+        for (int i = features_a; i < features_a + features_b; ++i) param[i] += a.param_dim();
+      }
+
+    private:
+      A a;
+      B b;
+    };
+
+    /** Product of two covariance functions, see CovProd. */
+    template <class A, class B> class Prod : public Base
+    {
+    public:
+      bool init(int input_dim) { return a.init(input_dim) && b.init(input_dim); }
+
+      size_t param_dim() const { return a.param_dim() + b.param_dim(); }
+
+      std::string to_string() const
+      {
+        return "CovProd(" + a.to_string() + ", " + b.to_string() + ")";
+      }
+
+      void set_loghyper(const double p[])
+      {
+        a.set_loghyper(p);
+        b.set_loghyper(p + a.param_dim());
+      }
+
+      template <class V1, class V2>
+      double get(const V1 &x1, const V2 &x2, bool same) const
+      {
+        return a.get(x1, x2, same) * b.get(x1, x2, same);
+      }
+
+      template <class V1, class V2>
+      double value_and_grad(const V1 &x1, const V2 &x2, bool same, double grad[]) const
+      {
+        size_t n = a.param_dim(), m = b.param_dim();
+        double ka = a.value_and_grad(x1, x2, same, grad);
+        double kb = b.value_and_grad(x1, x2, same, grad + n);
+        for (size_t i = 0; i < n; ++i) grad[i] *= kb;
+        for (size_t i = n; i < n + m; ++i) grad[i] *= ka;
+        return ka * kb;
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, CovarianceFunction::Workspace &ws) const
+      {
+        Eigen::VectorXd & k_b = ws.acquire(k.size());
+        a.get_row(x, X, k, ws);
+        b.get_row(x, X, k_b, ws);
+        k = k.cwiseProduct(k_b);
+        ws.release();
+      }
+
+      bool supports_distances() const { return a.supports_distances() && b.supports_distances(); }
+
+      bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                  Eigen::Ref<Eigen::VectorXd> k, CovarianceFunction::Workspace &ws) const
+      {
+        Eigen::VectorXd & k_b = ws.acquire(k.size());
+        bool supported = b.get_row_from_distances(d2, self, k_b, ws) && a.get_row_from_distances(d2, self, k, ws);
+        if (supported) k = k.cwiseProduct(k_b);
+        ws.release();
+        return supported;
+      }
+
+      template <class V1, class V2>
+      void hessian(const V1 &x1, const V2 &x2, bool same, Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        size_t n = a.param_dim(), m = b.param_dim();
+        Eigen::VectorXd grad_a(n), grad_b(m);
+        double ka = a.value_and_grad(x1, x2, same, grad_a.data());
+        double kb = b.value_and_grad(x1, x2, same, grad_b.data());
+        a.hessian(x1, x2, same, hess.topLeftCorner(n, n));
+        b.hessian(x1, x2, same, hess.bottomRightCorner(m, m));
+        hess.topLeftCorner(n, n) *= kb;
+        hess.bottomRightCorner(m, m) *= ka;
+        hess.topRightCorner(n, m) = grad_a * grad_b.transpose();
+        hess.bottomLeftCorner(m, n) = grad_b * grad_a.transpose();
+      }
+
+    private:
+      A a;
+      B b;
+    };
+
+    /** Covariance function K applied to input dimension I only, see
+     *  InputDimFilter. Like InputDimFilter, the filtered inputs are treated
+     *  as distinct samples. */
+    template <int I, class K> class Filter : public Base
+    {
+    public:
+      bool init(int input_dim) { return I < input_dim && k.init(1); }
+      size_t param_dim() const { return k.param_dim(); }
+
+      std::string to_string() const
+      {
+        std::ostringstream is;
+        is << "InputDimFilter(" << I << "/" << k.to_string() << ")";
+        return is.str();
+      }
+
+      void set_loghyper(const double p[]) { k.set_loghyper(p); }
+
+      template <class V1, class V2>
+      double get(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same) const
+      {
+        return k.get(x1.template segment<1>(I), x2.template segment<1>(I), false);
+      }
+
+      template <class V1, class V2>
+      double value_and_grad(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, double grad[]) const
+      {
+        return k.value_and_grad(x1.template segment<1>(I), x2.template segment<1>(I), false, grad);
+      }
+
+      void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                   Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] CovarianceFunction::Workspace &ws) const
+      {
+        for (int i = 0; i < k.size(); ++i) k(i) = get(x, *X[i], false);
+      }
+
+      template <class V1, class V2>
+      void hessian(const V1 &x1, const V2 &x2, [[maybe_unused]] bool same, Eigen::Ref<Eigen::MatrixXd> hess) const
+      {
+        k.hessian(x1.template segment<1>(I), x2.template segment<1>(I), false, hess);
+      }
+
+    private:
+      K k;
+    };
+  }
+
+  /** Covariance function defined by a compile-time expression.
+   *  Only the outermost call is virtual.
+   *  @ingroup cov_group */
+  template <class Expr> class CovStatic : public CovarianceFunction
+  {
+  public:
+    bool init(int n)
+    {
+      input_dim = n;
+      if (!expr.init(n)) return false;
+      param_dim = expr.param_dim();
+      loghyper.resize(param_dim);
+      loghyper.setZero();
+      expr.set_loghyper(loghyper.data());
+      return true;
+    }
+
+    double get(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2)
+    {
+      return expr.get(x1, x2, &x1 == &x2);
+    }
+
+    void grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::VectorXd &grad)
+    {
+      expr.value_and_grad(x1, x2, &x1 == &x2, grad.data());
+    }
+
+    void value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                        Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+    {
+      k = expr.value_and_grad(x1, x2, &x1 == &x2, grad.data());
+    }
+
+    void hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+    {
+      expr.hessian(x1, x2, &x1 == &x2, hess);
+    }
+
+    void set_loghyper(const Eigen::VectorXd &p)
+    {
+      CovarianceFunction::set_loghyper(p);
+      expr.set_loghyper(loghyper.data());
+    }
+
+    void get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                 Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+    {
+      expr.get_row(x, X, k, ws);
+    }
+
+    bool get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+    {
+      return expr.get_row_from_distances(d2, self, k, ws);
+    }
+
+    bool supports_distances()
+    {
+      return expr.supports_distances();
+    }
+
+    bool scale_noise_form(int &scale, int &noise)
+    {
+      return expr.scale_noise_form(scale, noise);
+    }
+
+    bool feature_form(int &features, int &noise)
+    {
+      return expr.feature_form(features, noise);
+    }
+
+    void features(const Eigen::VectorXd &x, Eigen::Ref<Eigen::VectorXd> phi)
+    {
+      expr.features(x, phi.data());
+    }
+
+    void feature_params(Eigen::Ref<Eigen::VectorXi> param)
+    {
+      expr.feature_params(param.data());
+    }
+
+    virtual std::string to_string()
+    {
+      return expr.to_string();
+    }
+
+    CovarianceFunction * clone()
+    {
+      return new CovStatic(*this);
+    }
+
+  protected:
+    Expr expr;
+  };
+
+  /** Covariance function defined by a compile-time expression for inputs
+   *  of fixed dimensionality D.
+   *  @ingroup cov_group */
+  template <class Expr, int D> class CovStaticFixed : public CovStatic<Expr>, public CovFixed<D>
+  {
+  public:
+    typedef typename CovFixed<D>::Input Input;
+
+    double get(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2)
+    {
+      return this->expr.get(Eigen::Map<const Input>(x1.data()), Eigen::Map<const Input>(x2.data()), &x1 == &x2);
+    }
+
+    void grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::VectorXd &grad)
+    {
+      this->expr.value_and_grad(Eigen::Map<const Input>(x1.data()), Eigen::Map<const Input>(x2.data()),
+                                &x1 == &x2, grad.data());
+    }
+
+    void value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                        Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] CovarianceFunction::Workspace &ws)
+    {
+      k = this->expr.value_and_grad(Eigen::Map<const Input>(x1.data()), Eigen::Map<const Input>(x2.data()),
+                                    &x1 == &x2, grad.data());
+    }
+
+    void hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+    {
+      this->expr.hessian(Eigen::Map<const Input>(x1.data()), Eigen::Map<const Input>(x2.data()), &x1 == &x2, hess);
+    }
+
+    double get_fixed(const Input &x1, const Input &x2, bool same)
+    {
+      return this->expr.get(x1, x2, same);
+    }
+
+    void grad_fixed(const Input &x1, const Input &x2, bool same, Eigen::Ref<Eigen::VectorXd> grad)
+    {
+      this->expr.value_and_grad(x1, x2, same, grad.data());
+    }
+
+    CovarianceFunction * clone()
+    {
+      return new CovStaticFixed(*this);
+    }
+  };
+
+}
+
+#endif /* __COV_STATIC_H__ */
@@ -0,0 +1,93 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __CROSS_VALIDATION_H__
+#define __CROSS_VALIDATION_H__
+
+#include <vector>
+#include <Eigen/Dense>
+
+#include "gp.h"
+
+namespace libgp {
+
+  /** Samples held out in one fold of a cross-validation. */
+  struct Fold
+  {
+    /** Samples the predictions are evaluated on. */
+    std::vector<size_t> test;
+
+    /** Samples neither used for training nor evaluated, e.g. the
+     *  neighbours of the test block in a time series. */
+    std::vector<size_t> excluded;
+  };
+
+  /** Held-out predictions and metrics of one fold. */
+  struct FoldResult
+  {
+    /** Predictive mean and variance (including noise) of the test samples. */
+    Eigen::VectorXd mean;
+    Eigen::VectorXd var;
+
+    /** Root mean squared error. */
+    double rmse;
+
+    /** Mean negative log predictive density. */
+    double nlpd;
+
+    /** False if the held-out block of the inverse kernel matrix is not
+     *  positive definite, e.g. for an ill-conditioned kernel matrix. The
+     *  predictions and metrics are NaN then. */
+    bool valid;
+  };
+
+  /** Cross-validation of a Gaussian process with fixed hyperparameters.
+   *  The held-out predictions of all folds are derived from the inverse
+   *  kernel matrix of the full model: for the held-out block H,
+   *  \f$ \Sigma_H = ([K^{-1}]_{HH})^{-1} \f$ and
+   *  \f$ \mu_H = y_H - \Sigma_H \alpha_H \f$. After one O(n^3) inversion
+   *  each fold costs O(|H|^3 + |H|^2) instead of a refit in O(n^3).
+   *  Folds are evaluated in parallel (see parallel_for()).
+   *  @author Manuel Blum */
+  class CrossValidation
+  {
+  public:
+
+    /** Prepare cross-validation of gp with its current hyperparameters. */
+    CrossValidation (GaussianProcess & gp);
+
+    virtual ~CrossValidation ();
+
+    /** Evaluate folds.
+     *  @param folds held-out samples of each fold
+     *  @param threads number of threads, 0 selects the hardware concurrency
+     *  @return one result per fold */
+    std::vector<FoldResult> evaluate(const std::vector<Fold> & folds, size_t threads = 0);
+
+    /** Split n samples into k contiguous blocks. For time series, the gap
+     *  samples on either side of each block are excluded from training. */
+    static std::vector<Fold> kfold(size_t n, size_t k, size_t gap = 0);
+
+    /** Create folds from a fold index per sample. Samples with negative
+     *  index are always used for training. The folds are ordered by index,
+     *  indices without samples are skipped. */
+    static std::vector<Fold> from_assignment(const std::vector<int> & assignment);
+
+  private:
+
+    /** Evaluate a single fold. */
+    FoldResult evaluate(const Fold & fold);
+
+    /** Inverse kernel matrix of the full model. */
+    Eigen::MatrixXd K_inv;
+
+    /** K^-1 y */
+    Eigen::VectorXd alpha;
+
+    /** Target values. */
+    Eigen::VectorXd y;
+  };
+}
+
+#endif /* __CROSS_VALIDATION_H__ */
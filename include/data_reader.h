@@ -0,0 +1,96 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __DATA_READER_H__
+#define __DATA_READER_H__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "gp.h"
+
+namespace libgp {
+
+  /** Buffered reader for whitespace or comma separated data files.
+   *  The file is read in large chunks and numbers are parsed in place
+   *  without creating a stream per line. Empty lines and lines starting
+   *  with '#' are skipped.
+   *  @author Manuel Blum */
+  class DataReader
+  {
+  public:
+    /** Open data file.
+     *  @param filename name of the file to read
+     *  @param buffer_size size of the read buffer in bytes */
+    DataReader (const char * filename, size_t buffer_size = 1 << 20);
+
+    virtual ~DataReader ();
+
+    /** Check if the file could be opened. */
+    bool is_open();
+
+    /** Set column that holds the target value. A negative index counts
+     *  from the last column, i.e. -1 selects the last column. Defaults to
+     *  the first column as written by GaussianProcess::write(). */
+    void set_target_column(int column);
+
+    /** Read next line that is neither empty nor a comment.
+     *  @param line the line without trailing newline
+     *  @return false if the end of file has been reached */
+    bool read_line(std::string & line);
+
+    /** Read a block of patterns. The input matrix and the target vector
+     *  are grown as needed and resized to the number of rows read.
+     *  @param input_dim number of input columns per row
+     *  @param x input matrix where each row is an input vector
+     *  @param y target values
+     *  @param max_rows maximum number of rows to read
+     *  @return number of rows read, zero at the end of file */
+    size_t read(size_t input_dim, Eigen::MatrixXd & x, Eigen::VectorXd & y,
+                size_t max_rows = static_cast<size_t>(-1));
+
+    /** Read all remaining patterns and add them to a Gaussian process in
+     *  blocks of block_size rows.
+     *  @return number of patterns added */
+    size_t import(GaussianProcess & gp, size_t block_size = 4096);
+
+  private:
+
+    /** Make sure that a complete line is available in the buffer.
+     *  @return false if the buffer is empty and the end of file is reached */
+    bool fill();
+
+    /** Find next line that is neither empty nor a comment. */
+    bool next_line(const char *& first, const char *& last);
+
+    /** Parse a number at the current position. */
+    const char * parse(const char * first, const char * last, double & value);
+
+    std::FILE * file;
+
+    /** Read buffer, always terminated by a zero character. */
+    std::vector<char> buffer;
+
+    /** Current read position and end of valid data in the buffer. */
+    size_t pos, end;
+
+    bool eof;
+
+    int target_column;
+
+    /** Number of lines consumed, used in error messages. */
+    size_t line_number;
+
+    /** Parsed values of the current row. */
+    std::vector<double> row;
+
+    /** No copy and assignment, the file is closed by the destructor */
+    DataReader (const DataReader &);
+    DataReader & operator=(const DataReader &);
+  };
+}
+
+#endif /* __DATA_READER_H__ */
@@ -0,0 +1,105 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __FROZEN_PREDICTOR_H__
+#define __FROZEN_PREDICTOR_H__
+
+#include <Eigen/Dense>
+
+#include "gp.h"
+#include "cov.h"
+
+namespace libgp {
+
+  /** Immutable inference-only snapshot of a trained Gaussian process.
+   *  Holds the training inputs, the weight vector alpha and the covariance
+   *  function. Optionally the inverse of the Cholesky factor is stored, so
+   *  that variance prediction is a matrix-vector product instead of a
+   *  triangular solve. Targets, the kernel matrix and all caches of the
+   *  original model are dropped.
+   *  @author Manuel Blum */
+  class LIBGP_EXPORT FrozenPredictor
+  {
+  public:
+
+    /** Scratch buffers for prediction. Create with workspace() and keep
+     *  one per thread; prediction then does not allocate memory. */
+    struct Workspace
+    {
+      Eigen::VectorXd x_star;
+      Eigen::VectorXd x_train;
+      Eigen::VectorXd k_star;
+      Eigen::VectorXd v;
+    };
+
+    /** Freeze a trained Gaussian process.
+     *  @param gp trained model, its factorization is updated if necessary
+     *  @param with_variance store the inverse Cholesky factor for variance
+     *  prediction */
+    FrozenPredictor (GaussianProcess & gp, bool with_variance = true);
+
+    /** Load predictor written by write(). */
+    FrozenPredictor (const char * filename);
+
+    virtual ~FrozenPredictor ();
+
+    /** Write predictor in a compact binary format. The format uses the
+     *  native byte order. */
+    void write(const char * filename) const;
+
+    /** Create workspace with buffers of the right size. */
+    Workspace workspace() const;
+
+    /** Predict target values and optionally variances for given inputs.
+     *  @param x input matrix where each row is an input vector
+     *  @param mean predicted values, must have x.rows() entries
+     *  @param var predicted variances, either empty or x.rows() entries
+     *  @param ws workspace created by workspace() */
+    void predict(const Eigen::MatrixXd & x, Eigen::Ref<Eigen::VectorXd> mean,
+                 Eigen::Ref<Eigen::VectorXd> var, Workspace & ws) const;
+
+    /** Predict target value for given input. */
+    double f(const double x[], Workspace & ws) const;
+
+    /** Predict variance of prediction for given input. */
+    double var(const double x[], Workspace & ws) const;
+
+    /** Check if the predictor can compute variances. */
+    bool has_variance() const;
+
+    /** Get number of training inputs. */
+    size_t size() const;
+
+    /** Get input vector dimensionality. */
+    size_t get_input_dim() const;
+
+  private:
+
+    /** Compute kernel vector for the input in ws.x_star. */
+    void update_k_star(Workspace & ws) const;
+
+    /** Variance of the latent function given the kernel vector. */
+    double latent_var(Workspace & ws) const;
+
+    /** No copies, the covariance function is owned. */
+    FrozenPredictor (const FrozenPredictor &);
+    FrozenPredictor & operator=(const FrozenPredictor &);
+
+    CovarianceFunction * cf;
+
+    /** Training inputs, one sample per column. */
+    Eigen::MatrixXd X;
+
+    Eigen::VectorXd alpha;
+
+    /** Inverse of the lower Cholesky factor, empty without variance. */
+    Eigen::MatrixXd L_inv;
+
+    size_t input_dim;
+
+    bool variance;
+  };
+}
+
+#endif /* __FROZEN_PREDICTOR_H__ */
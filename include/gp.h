@@ -21,6 +21,7 @@
 #include "gp_version.h"
 #include "cov.h"
 #include "sampleset.h"
+#include "scale_noise_cache.h"
 
 namespace libgp {
   
@@ -37,13 +38,23 @@ namespace libgp {
      *  and covariance function. */
     GaussianProcess (size_t input_dim, std::string covf_def);
     
-    /** Create and instance of GaussianProcess from file. */
+    /** Create and instance of GaussianProcess from file. All patterns
+     *  are read in one pass and the kernel matrix is factorized once. */
     GaussianProcess (const char * filename);
     
     /** Copy constructor */
     GaussianProcess (const GaussianProcess& gp);
     
     virtual ~GaussianProcess ();
+
+    /** Create a copy for hyperparameter search, e.g. by MultiStart. The
+     *  fork shares the input vectors with this model and clones the
+     *  covariance function, its kernel matrix is factorized on first use
+     *  instead of copying L. Derived models fork into their own type so
+     *  that the fork has the same log-likelihood, the implementation of
+     *  this class creates a plain single-output GaussianProcess.
+     *  @return new instance, owned by the caller */
+    virtual GaussianProcess * fork();
     
     /** Write current gp model to file. */
     void write(const char * filename);
@@ -64,28 +75,45 @@ namespace libgp {
      *  @return Matrix where first column contains predictions and second column contains variances (if compute_variance is true) */
     virtual Eigen::MatrixXd predict(const Eigen::MatrixXd& x, bool compute_variance = false);
     
+    /** Prepare the model for real-time prediction. Performs all pending
+     *  work (factorization and update of alpha) and sizes the scratch
+     *  buffers used by predict_rt(). Must be called again after the sample
+     *  set or the hyperparameters have changed. */
+    virtual void prepare();
+
+    /** Predict target value and optionally variance for given input in
+     *  bounded time. Never triggers a factorization and does not allocate
+     *  memory, the model has to be prepared with prepare().
+     *  @param x input vector
+     *  @param mean predicted value
+     *  @param var predicted variance, not computed if NULL
+     *  @return false if the model has not been prepared */
+    virtual bool predict_rt(const double x[], double & mean, double * var = NULL);
+
     /** Add multiple input-output pairs to sample set.
-     *  Add multiple patterns efficiently in a batch.
+     *  Add multiple patterns efficiently in a batch. If the kernel matrix
+     *  is already factorized, the Cholesky factor is extended by one block
+     *  instead of being recomputed.
      *  @param x input matrix where each row is an input vector
      *  @param y output vector with target values corresponding to each input
      */
-    void add_patterns(const Eigen::MatrixXd& x, const Eigen::VectorXd& y);
+    virtual void add_patterns(const Eigen::MatrixXd& x, const Eigen::VectorXd& y);
 
     /** Add input-output-pair to sample set.
      *  Add a copy of the given input-output-pair to sample set.
      *  @param x input array
      *  @param y output value
      */
-    void add_pattern(const double x[], double y);
+    virtual void add_pattern(const double x[], double y);
 
 
-    bool set_y(size_t i, double y);
+    virtual bool set_y(size_t i, double y);
 
     /** Get number of samples in the training set. */
     size_t get_sampleset_size();
     
     /** Clear sample set and free memory. */
-    void clear_sampleset();
+    virtual void clear_sampleset();
 
     Eigen::MatrixXd get_sampleset();
     
@@ -95,9 +123,69 @@ namespace libgp {
     /** Get input vector dimensionality. */
     size_t get_input_dim();
 
-    double log_likelihood();
+    virtual double log_likelihood();
     
-    Eigen::VectorXd log_likelihood_gradient();
+    /** Gradient of log_likelihood(). While only signal and noise level
+     *  changed since the last factorization (see ScaleNoiseCache), their
+     *  derivatives cost O(n^2), the other derivatives still need K^-1. */
+    virtual Eigen::VectorXd log_likelihood_gradient();
+
+    /** Derivatives of log_likelihood() with respect to the log signal and
+     *  noise level of a covariance function of the form sf^2 K_0 + s^2 I,
+     *  zero for a missing level. Costs O(n^2) while the eigendecomposition
+     *  of K_0 is reused, e.g. in a noise-level sweep (see
+     *  set_scale_noise_cache()).
+     *  @return false if the covariance function does not have this form */
+    bool scale_noise_gradient(double & scale_grad, double & noise_grad);
+
+    /** Represent the kernel matrix by an eigendecomposition of K_0 while
+     *  only signal and noise level change (see ScaleNoiseCache). The first
+     *  decomposition costs several Cholesky factorizations and pays off
+     *  only for sweeps over many levels, hence it is disabled by default. */
+    void set_scale_noise_cache(bool enable);
+
+    /** Hessian of log_likelihood() with respect to the log-hyperparameters,
+     *  built on CovarianceFunction::hessian(). Costs O(p n^3) for p
+     *  hyperparameters in addition to the factorization. */
+    Eigen::MatrixXd log_likelihood_hessian();
+
+    /** log_likelihood(), its gradient and its Hessian from a single
+     *  factorization of the kernel matrix.
+     *  @param grad gradient with respect to the log-hyperparameters
+     *  @param hess Hessian with respect to the log-hyperparameters
+     *  @return log marginal likelihood */
+    virtual double log_likelihood_hessian(Eigen::VectorXd & grad, Eigen::MatrixXd & hess);
+
+    /** log_likelihood() for many hyperparameter vectors, e.g. for grid
+     *  searches. The candidates are factorized concurrently on copies of
+     *  the covariance function (see parallel_for()), the model itself is
+     *  not changed. Isotropic covariance functions share the pairwise
+     *  distances (see CovarianceFunction::get_row_from_distances()).
+     *  @param theta log-hyperparameters, one candidate per row
+     *  @param grad gradient of each candidate in the rows, not computed if NULL
+     *  @param threads number of threads, 0 selects the hardware concurrency
+     *  @return log-likelihood of each candidate, -inf if the kernel matrix is not positive definite */
+    Eigen::VectorXd log_likelihood_batch(const Eigen::MatrixXd & theta, Eigen::MatrixXd * grad = NULL,
+                                         size_t threads = 0);
+
+    /** Leave-one-out predictions for all training samples in closed form,
+     *  \f$ \mu_i = y_i - \alpha_i / [K^{-1}]_{ii} \f$ and
+     *  \f$ \sigma_i^2 = 1 / [K^{-1}]_{ii} \f$. The variance is that of the
+     *  target, i.e. it includes the noise term.
+     *  @return Matrix where first column contains means and second column contains variances */
+    Eigen::MatrixXd loo_predict();
+
+    /** Sum of the leave-one-out log predictive probabilities of the targets. */
+    double loo_log_predictive();
+
+    /** Gradient of loo_log_predictive() with respect to the log-hyperparameters. */
+    Eigen::VectorXd loo_log_predictive_gradient();
+
+    /** loo_log_predictive() and its gradient from a single inversion of
+     *  the kernel matrix.
+     *  @param grad gradient with respect to the log-hyperparameters
+     *  @return sum of the leave-one-out log predictive probabilities */
+    double loo_log_predictive(Eigen::VectorXd & grad);
 
   protected:
     
@@ -125,13 +213,84 @@ namespace libgp {
 
     void update_alpha();
 
-    /** Compute covariance matrix and perform cholesky decomposition. */
+    /** Inverse of the kernel matrix, requires compute(). */
+    virtual Eigen::MatrixXd kernel_inverse();
+
+    /** Contract the symmetric matrix W with the kernel matrix derivatives,
+     *  grad_j = sum_ab W_ab dK_ab / dtheta_j / 2. */
+    Eigen::VectorXd trace_gradient(const Eigen::MatrixXd & W);
+
+    /** trace_gradient() for another covariance function, e.g. a copy of cf. */
+    Eigen::VectorXd trace_gradient(const Eigen::MatrixXd & W, CovarianceFunction & covf,
+                                   CovarianceFunction::Workspace & ws);
+
+    /** Hessian by central differences of log_likelihood_gradient(), for
+     *  models that do not implement the analytic Hessian. */
+    double numerical_hessian(Eigen::VectorXd & grad, Eigen::MatrixXd & hess);
+
+    /** Compute L^-1 y, log |K| and y^T K^-1 y from the cholesky factor. */
+    void update_stats();
+
+    /** Compute covariance matrix and perform cholesky decomposition.
+     *  Nothing is done if the hyperparameters equal those of L. If only
+     *  signal and noise level have changed and the cache is enabled, the
+     *  kernel matrix is represented by an eigendecomposition instead (see
+     *  ScaleNoiseCache). */
     virtual void compute();
+
+    /** Make sure L holds the cholesky factor of the current kernel matrix. */
+    virtual void cholesky();
+
+    /** Compute covariance matrix and its cholesky factor from scratch. */
+    void factorize();
+
+    /** Write the lower triangle of the kernel matrix of the first n
+     *  samples to L, called by factorize(). */
+    virtual void fill_kernel(int n);
+
+    /** Record the hyperparameters and sample set size L was computed for. */
+    void mark_factorized();
+
+    /** Share the samples and clone the covariance function into a model
+     *  created by the default constructor, see fork(). */
+    void fork_to(GaussianProcess * gp);
     
     bool alpha_needs_update;
 
+    /** L^-1 y, log |K| and y^T K^-1 y, updated incrementally when patterns
+     *  are added so that the log-likelihood costs O(1) after an append. */
+    Eigen::VectorXd L_inv_y;
+    double log_det_K;
+    double y_K_inv_y;
+    bool stats_need_update;
+
+    /** True if the kernel matrix is represented by spectral instead of L. */
+    bool use_spectral;
+
+    /** Eigendecomposition for kernels of the form sf^2 K_0 + s^2 I. */
+    ScaleNoiseCache spectral;
+
+    /** True if spectral may be computed, see set_scale_noise_cache(). */
+    bool scale_noise_cache;
+
+    /** Hyperparameters and sample set size of the last factorization. */
+    Eigen::VectorXd factorized_loghyper;
+    int factorized_n;
+
+    /** Scratch buffers for real-time prediction. */
+    Eigen::VectorXd rt_x;
+    Eigen::VectorXd rt_x2;
+    Eigen::VectorXd rt_v;
+
+    /** Scratch vectors for covariance function evaluation. */
+    CovarianceFunction::Workspace cov_ws;
+
   private:
 
+    friend class FrozenPredictor;
+    friend class CrossValidation;
+    friend class OnlineAdaptation;
+
     /** No assignement */
     GaussianProcess& operator=(const GaussianProcess&);
 
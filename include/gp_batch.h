@@ -0,0 +1,178 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __GP_BATCH_H__
+#define __GP_BATCH_H__
+
+#include <string>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "gp_version.h"
+#include "cov.h"
+
+namespace libgp {
+
+  /** Container for many small, independent Gaussian processes that share
+   *  the structure of their covariance function but not its hyperparameters
+   *  or their samples. Instead of a GaussianProcess object per model, with
+   *  its own preallocated cholesky factor and scattered input vectors, the
+   *  inputs, targets, alpha and cholesky factor of each model are stored in
+   *  one slot of an arena. Arenas are bucketed by capacity (16, 24, 32, 48,
+   *  64, ...) and a model moves to the next bucket when it outgrows its
+   *  slot. Refactorization, prediction, likelihood and gradient are batched
+   *  over models and run in parallel (see parallel_for()).
+   *  @author Manuel Blum */
+  class LIBGP_EXPORT GPBatch
+  {
+  public:
+
+    /** Create an empty batch with given input dimensionality and
+     *  covariance function. */
+    GPBatch (size_t input_dim, std::string covf_def);
+
+    virtual ~GPBatch ();
+
+    /** Add an empty model with all log-hyperparameters zero.
+     *  @return model id */
+    size_t add_model();
+
+    /** Number of models. */
+    size_t get_model_count();
+
+    /** Get input vector dimensionality. */
+    size_t get_input_dim();
+
+    /** Number of hyperparameters per model. */
+    size_t get_param_dim();
+
+    /** Get number of samples of a model. */
+    size_t get_sampleset_size(size_t id);
+
+    /** Add input-output-pair to the sample set of a model. The cholesky
+     *  factor is extended in O(n^2) if the model is factorized. */
+    void add_pattern(size_t id, const double x[], double y);
+
+    /** Add multiple input-output pairs to the sample set of a model.
+     *  The model is refactorized by the next batched operation. */
+    void add_patterns(size_t id, const Eigen::MatrixXd & x, const Eigen::VectorXd & y);
+
+    /** Remove all samples of a model and return it to the smallest bucket. */
+    void clear_sampleset(size_t id);
+
+    /** Get log-hyperparameters of a model. */
+    Eigen::VectorXd get_loghyper(size_t id);
+
+    /** Set log-hyperparameters of a model. */
+    void set_loghyper(size_t id, const Eigen::VectorXd & p);
+
+    /** Set log-hyperparameters of all models, column i holds the
+     *  parameters of model i. */
+    void set_loghyper(const Eigen::MatrixXd & p);
+
+    /** Refactorize all models whose samples or hyperparameters changed.
+     *  @param threads number of threads, 0 selects the hardware concurrency */
+    void compute(size_t threads = 0);
+
+    /** Predict for (model, input) pairs.
+     *  @param id model of each input
+     *  @param x input matrix where each row is an input vector
+     *  @param compute_variance if true, also compute variance
+     *  @param threads number of threads, 0 selects the hardware concurrency
+     *  @return Matrix where first column contains predictions and second column contains variances (if compute_variance is true) */
+    Eigen::MatrixXd predict(const std::vector<size_t> & id, const Eigen::MatrixXd & x,
+                            bool compute_variance = false, size_t threads = 0);
+
+    /** Log-likelihood of every model. */
+    Eigen::VectorXd log_likelihood(size_t threads = 0);
+
+    /** Log-likelihood gradients, column i belongs to model i. */
+    Eigen::MatrixXd log_likelihood_gradient(size_t threads = 0);
+
+  private:
+
+    /** Location and state of a model. */
+    struct Model
+    {
+      int bucket;
+      size_t slot;
+      int n;
+      bool factorized;
+    };
+
+    /** Slots of equal capacity in contiguous memory. A slot holds the
+     *  inputs (capacity x input_dim), targets, alpha and the cholesky
+     *  factor (capacity x capacity, column-major). */
+    struct Arena
+    {
+      int capacity;
+      size_t stride;
+      size_t slots;
+      std::vector<double> data;
+      std::vector<size_t> free;
+    };
+
+    /** Per-thread covariance function and scratch memory. */
+    struct Scratch
+    {
+      CovarianceFunction * cf;
+      CovarianceFunction::Workspace ws;
+      std::vector<Eigen::VectorXd> x;
+      std::vector<const Eigen::VectorXd *> X;
+      Eigen::VectorXd x_star, x_star2, k, g;
+      Eigen::MatrixXd W;
+    };
+
+    typedef Eigen::Map<Eigen::MatrixXd, 0, Eigen::OuterStride<> > MatrixMap;
+
+    /** Capacity of a bucket. */
+    static int capacity(int bucket);
+
+    /** Take a free slot of a bucket. */
+    size_t allocate(int bucket);
+
+    /** Move a model to a bucket that holds at least n samples. */
+    void reserve(size_t id, int n);
+
+    double * inputs(const Model & m);
+    double * targets(const Model & m);
+    double * alpha(const Model & m);
+    MatrixMap cholesky(const Model & m);
+
+    /** Load hyperparameters and inputs of a model into scratch memory. */
+    void load(const Model & m, size_t id, Scratch & s);
+
+    /** Compute cholesky factor and alpha of a model. */
+    void factorize(size_t id, Scratch & s);
+
+    /** Solve for alpha given the cholesky factor. */
+    void update_alpha(const Model & m);
+
+    /** Make sure there is scratch memory for a number of threads. */
+    void prepare_scratch(size_t threads);
+
+    /** Model ids ordered by decreasing size. */
+    std::vector<size_t> by_size(const std::vector<size_t> & ids);
+
+    void check_id(size_t id);
+
+    size_t input_dim;
+    size_t param_dim;
+    std::string covf_def;
+
+    std::vector<Model> models;
+    std::vector<Arena> arenas;
+
+    /** Log-hyperparameters, param_dim entries per model. */
+    std::vector<double> loghyper;
+
+    std::vector<Scratch> scratch;
+
+    /** No copy and assignement */
+    GPBatch (const GPBatch &);
+    GPBatch & operator=(const GPBatch &);
+  };
+}
+
+#endif /* __GP_BATCH_H__ */
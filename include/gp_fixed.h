@@ -0,0 +1,148 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __GP_FIXED_H__
+#define __GP_FIXED_H__
+
+#include <vector>
+#include <stdexcept>
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+#include "gp.h"
+#include "cov_fixed.h"
+
+namespace libgp {
+
+  /** Gaussian process regression for inputs of fixed dimensionality D.
+   *  Inputs are stored as a contiguous array of fixed size vectors and the
+   *  kernel is evaluated through the fixed dimension specialization created
+   *  by CovFactory. If the covariance function has no such specialization
+   *  (e.g. InputDimFilter), the dynamic implementation of GaussianProcess is
+   *  used instead.
+   *  @author Manuel Blum */
+  template <int D> class GaussianProcessFixed : public GaussianProcess
+  {
+  public:
+    typedef Eigen::Matrix<double, D, 1> Input;
+
+    /** Create an instance of GaussianProcessFixed with given covariance function. */
+    GaussianProcessFixed (std::string covf_def) : GaussianProcess(D, covf_def)
+    {
+      fixed = dynamic_cast<CovFixed<D> *>(cf);
+    }
+
+    /** Copy constructor, the fixed dimension kernel refers to the cloned
+     *  covariance function of the copy. */
+    GaussianProcessFixed (const GaussianProcessFixed & gp) : GaussianProcess(gp), inputs(gp.inputs)
+    {
+      fixed = dynamic_cast<CovFixed<D> *>(cf);
+    }
+
+    virtual ~GaussianProcessFixed () {}
+
+    /** Check if the fixed dimension kernel is used. */
+    bool is_fixed()
+    {
+      return fixed != NULL;
+    }
+
+    virtual double f(const double x[])
+    {
+      if (fixed == NULL) return GaussianProcess::f(x);
+      if (sampleset->empty()) return 0;
+      compute();
+      update_alpha();
+      update_k_star_fixed(Eigen::Map<const Input>(x));
+      return k_star.dot(alpha);
+    }
+
+    virtual double var(const double x[])
+    {
+      if (fixed == NULL) return GaussianProcess::var(x);
+      if (sampleset->empty()) return 0;
+      compute();
+      update_alpha();
+      Input x_star = Eigen::Map<const Input>(x);
+      return var_fixed(x_star);
+    }
+
+    virtual Eigen::MatrixXd predict(const Eigen::MatrixXd& x, bool compute_variance = false)
+    {
+      if (fixed == NULL) return GaussianProcess::predict(x, compute_variance);
+      if (x.cols() != D) {
+        throw std::runtime_error("Input dimension mismatch");
+      }
+      if (sampleset->empty()) return Eigen::MatrixXd();
+      compute();
+      update_alpha();
+      Eigen::MatrixXd result(x.rows(), compute_variance ? 2 : 1);
+      for (int i = 0; i < x.rows(); ++i) {
+        Input x_star = x.row(i).transpose();
+        if (compute_variance) {
+          result(i, 1) = var_fixed(x_star);
+        } else {
+          update_k_star_fixed(x_star);
+        }
+        result(i, 0) = k_star.dot(alpha);
+      }
+      return result;
+    }
+
+    virtual void clear_sampleset()
+    {
+      GaussianProcess::clear_sampleset();
+      inputs.clear();
+    }
+
+  protected:
+
+    virtual void fill_kernel(int n)
+    {
+      if (fixed == NULL) return GaussianProcess::fill_kernel(n);
+      sync_inputs();
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j <= i; ++j) {
+          L(i, j) = fixed->get_fixed(inputs[i], inputs[j], i == j);
+        }
+      }
+    }
+
+  private:
+
+    /** Append samples that were added since the last synchronization. */
+    void sync_inputs()
+    {
+      for (size_t i = inputs.size(); i < sampleset->size(); ++i) {
+        inputs.push_back(sampleset->x(i));
+      }
+    }
+
+    void update_k_star_fixed(const Input & x_star)
+    {
+      sync_inputs();
+      int n = inputs.size();
+      k_star.resize(n);
+      for (int i = 0; i < n; ++i) {
+        k_star(i) = fixed->get_fixed(x_star, inputs[i], false);
+      }
+    }
+
+    double var_fixed(const Input & x_star)
+    {
+      update_k_star_fixed(x_star);
+      if (use_spectral) return fixed->get_fixed(x_star, x_star, false) - spectral.quad_form(k_star);
+      int n = inputs.size();
+      Eigen::VectorXd v = L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solve(k_star);
+      return fixed->get_fixed(x_star, x_star, false) - v.dot(v);
+    }
+
+    CovFixed<D> * fixed;
+
+    /** Contiguous copy of the training inputs. */
+    std::vector<Input, Eigen::aligned_allocator<Input> > inputs;
+  };
+}
+
+#endif /* __GP_FIXED_H__ */
@@ -0,0 +1,115 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __GP_LINEAR_H__
+#define __GP_LINEAR_H__
+
+#include <Eigen/Dense>
+
+#include "gp.h"
+
+namespace libgp {
+
+  /** Gaussian process regression for covariance functions with a finite
+   *  feature representation plus noise, e.g. CovSum(CovLinearard, CovNoise)
+   *  (see CovarianceFunction::feature_form()). With the weighted features
+   *  \f$\Phi\f$ (n x m) the kernel matrix is \f$ \Phi \Phi^T + s^2 I \f$ and
+   *  by the Woodbury identity all computations use the m x m matrix
+   *  \f$ A = \Phi^T \Phi + s^2 I \f$ instead. The sample set enters only
+   *  through \f$ \Phi^T \Phi \f$, \f$ \Phi^T y \f$ and \f$ y^T y \f$, which are
+   *  accumulated for the unweighted features. Adding a pattern costs
+   *  O(m^2), a change of hyperparameters O(m^3) and a prediction O(m^2),
+   *  independent of the number of samples.
+   *  @author Manuel Blum */
+  class LIBGP_EXPORT GaussianProcessLinear : public GaussianProcess
+  {
+  public:
+
+    /** Create an instance of GaussianProcessLinear with given input
+     *  dimensionality and covariance function. Throws if the covariance
+     *  function has no feature representation or no noise term. */
+    GaussianProcessLinear (size_t input_dim, std::string covf_def);
+
+    virtual ~GaussianProcessLinear ();
+
+    /** Fork as a copy, the state of the model is of size O(m^2). */
+    virtual GaussianProcess * fork();
+
+    /** Number of features m. */
+    size_t get_feature_dim();
+
+    virtual double f(const double x[]);
+
+    virtual double var(const double x[]);
+
+    virtual Eigen::MatrixXd predict(const Eigen::MatrixXd& x, bool compute_variance = false);
+
+    virtual void prepare();
+
+    virtual bool predict_rt(const double x[], double & mean, double * var = NULL);
+
+    virtual void add_patterns(const Eigen::MatrixXd& x, const Eigen::VectorXd& y);
+
+    virtual void add_pattern(const double x[], double y);
+
+    virtual bool set_y(size_t i, double y);
+
+    virtual void clear_sampleset();
+
+    virtual double log_likelihood();
+
+    virtual Eigen::VectorXd log_likelihood_gradient();
+
+    using GaussianProcess::log_likelihood_hessian;
+
+    /** Central differences of log_likelihood_gradient(). */
+    virtual double log_likelihood_hessian(Eigen::VectorXd & grad, Eigen::MatrixXd & hess);
+
+  protected:
+
+    /** Factorize A if hyperparameters or sample set have changed. */
+    virtual void compute();
+
+    /** The full cholesky factor is only computed on request, e.g. by
+     *  FrozenPredictor. */
+    virtual void cholesky();
+
+    /** K^-1 = (I - Phi A^-1 Phi^T) / s^2 in O(n^2 m). */
+    virtual Eigen::MatrixXd kernel_inverse();
+
+    /** Update beta = A^-1 Phi^T y. */
+    void update_beta();
+
+    /** Accumulate unweighted features and target of a new pattern. */
+    void accumulate(const Eigen::VectorXd & x, double y);
+
+    /** Number of features and index of the noise parameter. */
+    int m, noise;
+
+    /** Parameter index of each feature. */
+    Eigen::VectorXi param;
+
+    /** Sufficient statistics of the unweighted features. */
+    Eigen::MatrixXd G;
+    Eigen::VectorXd b;
+    double yy;
+
+    /** Feature weights and noise variance. */
+    Eigen::VectorXd w;
+    double s2;
+
+    /** Cholesky factorization of A. */
+    Eigen::LLT<Eigen::MatrixXd> A;
+
+    Eigen::VectorXd beta;
+
+    /** Features of the last input. */
+    Eigen::VectorXd phi;
+
+    bool features_changed;
+    bool beta_needs_update;
+  };
+}
+
+#endif /* __GP_LINEAR_H__ */
@@ -0,0 +1,102 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __GP_MULTI_H__
+#define __GP_MULTI_H__
+
+#include <Eigen/Dense>
+
+#include "gp.h"
+
+namespace libgp {
+
+  /** Gaussian process regression for several independent outputs with
+   *  common inputs and covariance function. The kernel matrix is factorized
+   *  once for all outputs. The weights of all outputs are obtained by one
+   *  multiple right-hand side solve, and the predictive variance is shared.
+   *  The methods inherited from GaussianProcess that take or return a single
+   *  target refer to the first output.
+   *  @author Manuel Blum */
+  class LIBGP_EXPORT GaussianProcessMulti : public GaussianProcess
+  {
+  public:
+
+    /** Create an instance of GaussianProcessMulti with given input and
+     *  output dimensionality and covariance function. */
+    GaussianProcessMulti (size_t input_dim, size_t output_dim, std::string covf_def);
+
+    virtual ~GaussianProcessMulti ();
+
+    /** Fork with all outputs. */
+    virtual GaussianProcess * fork();
+
+    /** Get output dimensionality. */
+    size_t get_output_dim();
+
+    /** Add multiple input-output pairs to sample set.
+     *  @param x input matrix where each row is an input vector
+     *  @param y target matrix where each row holds the outputs of one input */
+    void add_patterns(const Eigen::MatrixXd& x, const Eigen::MatrixXd& y);
+
+    /** Add input-output pair to sample set.
+     *  @param x input array
+     *  @param y output array */
+    void add_pattern(const double x[], const double y[]);
+
+    /** Only valid for a single output. */
+    virtual void add_patterns(const Eigen::MatrixXd& x, const Eigen::VectorXd& y);
+
+    /** Only valid for a single output. */
+    virtual void add_pattern(const double x[], double y);
+
+    /** Set target value of output j at index i. */
+    bool set_y(size_t i, size_t j, double y);
+
+    virtual bool set_y(size_t i, double y);
+
+    virtual void clear_sampleset();
+
+    /** Get target matrix. */
+    const Eigen::MatrixXd & get_targets();
+
+    /** Predict all outputs and optionally the shared variance.
+     *  @param x input matrix where each row is an input vector
+     *  @param var predicted variance of each input, not computed if NULL
+     *  @return Matrix with one row per input and one column per output */
+    Eigen::MatrixXd predict_outputs(const Eigen::MatrixXd& x, Eigen::VectorXd * var = NULL);
+
+    /** Sum of the log marginal likelihoods of all outputs. */
+    virtual double log_likelihood();
+
+    /** Gradient of log_likelihood(). */
+    virtual Eigen::VectorXd log_likelihood_gradient();
+
+    using GaussianProcess::log_likelihood_hessian;
+
+    /** Central differences of log_likelihood_gradient(). */
+    virtual double log_likelihood_hessian(Eigen::VectorXd & grad, Eigen::MatrixXd & hess);
+
+  protected:
+
+    /** Empty model for fork(). */
+    GaussianProcessMulti (size_t output_dim);
+
+    virtual void compute();
+
+    /** Update alpha of all outputs. */
+    void update_alphas();
+
+    size_t output_dim;
+
+    /** Target values, one row per sample. */
+    Eigen::MatrixXd Y;
+
+    /** K^-1 Y */
+    Eigen::MatrixXd alphas;
+
+    bool alphas_need_update;
+  };
+}
+
+#endif /* __GP_MULTI_H__ */
@@ -0,0 +1,58 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __LBFGSB_H__
+#define __LBFGSB_H__
+
+#include "gp.h"
+#include "objective.h"
+#include "stopping_criteria.h"
+#include <Eigen/Core>
+
+namespace libgp {
+
+/** Limited-memory quasi-Newton optimizer with box constraints on the
+ *  log-hyperparameters. The search direction is the L-BFGS direction on
+ *  the variables that are not held at a bound. A variable at a bound is
+ *  held if its gradient or its component of the direction points out of
+ *  the box. The step is found by a strong Wolfe line search that stops at
+ *  the boundary of the box.
+ *  @author Manuel Blum */
+class LBFGSB : public StoppingCriteria
+{
+public:
+  LBFGSB () {init();}
+  /** @param m number of correction pairs
+   *  @param eps_stop stop if the projected gradient is smaller (max-norm)
+   *  @param c1 sufficient decrease constant of the Wolfe conditions
+   *  @param c2 curvature constant of the Wolfe conditions */
+  void init(size_t m = 10, double eps_stop = 1e-5, double c1 = 1e-4, double c2 = 0.9);
+  /** Bounds of each log-hyperparameter, the default is [-10, 10]. */
+  void set_bounds(const Eigen::VectorXd & lower, const Eigen::VectorXd & upper);
+  /** Same bounds for all log-hyperparameters. */
+  void set_bounds(double lower, double upper);
+  /** Maximize the log marginal likelihood of gp. */
+  void maximize(GaussianProcess * gp, size_t n=100, bool verbose=1);
+  /** Maximize an arbitrary objective, e.g. LooPredictive.
+   *  @param n maximum number of iterations */
+  void maximize(Objective * objective, size_t n=100, bool verbose=1);
+private:
+  /** Find a step a in (0, a_max] along d satisfying the strong Wolfe
+   *  conditions for the minimization of -objective. On return F and g hold
+   *  the negative objective and its gradient at x + a d.
+   *  @return step, 0 if no sufficient decrease was found */
+  double line_search(Objective * objective, const Eigen::VectorXd & x, const Eigen::VectorXd & d,
+                     double F0, double dphi0, double a, double a_max, double & F, Eigen::VectorXd & g);
+  Eigen::VectorXd lower_bounds(int param_dim);
+  Eigen::VectorXd upper_bounds(int param_dim);
+  size_t m;
+  double eps_stop;
+  double c1;
+  double c2;
+  Eigen::VectorXd lower;
+  Eigen::VectorXd upper;
+};
+}
+
+#endif /* __LBFGSB_H__ */
@@ -0,0 +1,79 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __MULTI_START_H__
+#define __MULTI_START_H__
+
+#include <functional>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "gp.h"
+#include "objective.h"
+
+namespace libgp {
+
+  /** Hyperparameter optimization from several initial points, as the
+   *  marginal likelihood is multimodal. Every start optimizes its own fork
+   *  of the Gaussian process (see GaussianProcess::fork()) and the starts
+   *  run in parallel (see parallel_for()). With a cutoff the starts advance
+   *  in rounds, and starts falling too far behind the best one are
+   *  abandoned. Each round calls the optimizer anew, warm started at the
+   *  hyperparameters the previous round reached.
+   *  @author Manuel Blum */
+  class MultiStart
+  {
+  public:
+
+    /** Runs an optimizer on an objective for a number of iterations. */
+    typedef std::function<void(Objective *, size_t)> Optimizer;
+
+    /** @param optimizer called concurrently for different starts, e.g.
+     *  [](Objective * o, size_t n) { LBFGSB().maximize(o, n, false); } */
+    MultiStart (const Optimizer & optimizer);
+
+    virtual ~MultiStart ();
+
+    /** Abandon starts that are clearly losing. Every round restarts the
+     *  optimizer from the current hyperparameters of a start, so its
+     *  internal state (e.g. the step sizes of RProp, the search direction of
+     *  CG or the memory of LBFGSB) is reset and the result of a surviving
+     *  start generally differs from a single run of n iterations. Choose
+     *  round large enough for the optimizer to make progress on its own.
+     *  @param round iterations between comparisons of the starts, 0 disables the cutoff
+     *  @param margin starts more than margin below the best log-likelihood are abandoned */
+    void set_cutoff(size_t round, double margin);
+
+    /** Maximize the log marginal likelihood of gp from each start.
+     *  @param gp Gaussian process, set to the best hyperparameters found
+     *  @param starts initial log-hyperparameters, one column per start
+     *  @param n iterations per start
+     *  @param threads number of threads, 0 selects the hardware concurrency
+     *  @return log-likelihood of the best start */
+    double maximize(GaussianProcess * gp, const Eigen::MatrixXd & starts, size_t n = 100, size_t threads = 0);
+
+    /** Log-likelihood of each start reached in the last call of maximize(). */
+    const Eigen::VectorXd & get_values();
+
+    /** Final log-hyperparameters of each start, one column per start. */
+    const Eigen::MatrixXd & get_loghyper();
+
+    /** Starts abandoned in the last call of maximize(). */
+    const std::vector<bool> & get_abandoned();
+
+    /** Starts drawn uniformly from center +- scale.
+     *  @return one start per column */
+    static Eigen::MatrixXd random_starts(const Eigen::VectorXd & center, size_t k, double scale);
+
+  private:
+    Optimizer optimizer;
+    size_t round;
+    double margin;
+    Eigen::VectorXd values;
+    Eigen::MatrixXd loghyper;
+    std::vector<bool> abandoned;
+  };
+}
+
+#endif /* __MULTI_START_H__ */
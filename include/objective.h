@@ -0,0 +1,140 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __OBJECTIVE_H__
+#define __OBJECTIVE_H__
+
+#include <deque>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "gp.h"
+
+namespace libgp {
+
+  /** Objective function for hyperparameter optimization. The optimizers
+   *  (RProp, CG) maximize the objective over the log-hyperparameters
+   *  through value_and_gradient().
+   *  @author Manuel Blum */
+  class Objective
+  {
+  public:
+    Objective ();
+    virtual ~Objective () {}
+
+    /** Get current log-hyperparameters. */
+    virtual Eigen::VectorXd get_loghyper() = 0;
+
+    /** Set log-hyperparameters. */
+    virtual void set_loghyper(const Eigen::VectorXd &p) = 0;
+
+    /** Objective at the current log-hyperparameters. */
+    virtual double value() = 0;
+
+    /** Gradient with respect to the log-hyperparameters. */
+    virtual Eigen::VectorXd gradient() = 0;
+
+    /** Objective and gradient at p. The most recent evaluations are
+     *  memoized by their log-hyperparameters, revisiting a point costs no
+     *  evaluation and leaves the objective untouched. Otherwise the
+     *  log-hyperparameters are set to p and evaluate() is called.
+     *  @param p log-hyperparameters
+     *  @param grad gradient at p
+     *  @return objective at p */
+    double value_and_gradient(const Eigen::VectorXd &p, Eigen::VectorXd &grad);
+
+    /** Forget memoized evaluations. Required if the objective changes for
+     *  other reasons than its log-hyperparameters, e.g. when samples are
+     *  added. The optimizers clear the cache on entry. */
+    void clear_cache();
+
+    /** Number of calls of value_and_gradient() not answered from the cache. */
+    size_t get_evaluations();
+
+    /** Independent copy that can be evaluated concurrently, e.g. on a fork
+     *  of the Gaussian process (see GaussianProcess::fork()).
+     *  @return new instance owned by the caller, NULL if not supported (default) */
+    virtual Objective * fork();
+
+  protected:
+
+    /** Objective and gradient at the current log-hyperparameters in a
+     *  single pass. The default calls value() and gradient(). */
+    virtual double evaluate(Eigen::VectorXd &grad);
+
+  private:
+
+    struct Evaluation
+    {
+      Eigen::VectorXd p;
+      Eigen::VectorXd grad;
+      double value;
+    };
+
+    /** Most recent evaluation first. */
+    std::deque<Evaluation> cache;
+
+    size_t evaluations;
+  };
+
+  /** Log marginal likelihood of a Gaussian process, see
+   *  GaussianProcess::log_likelihood(). */
+  class MarginalLikelihood : public Objective
+  {
+  public:
+    /** @param gp Gaussian process, deleted with the objective if owned */
+    MarginalLikelihood (GaussianProcess * gp, bool owned = false);
+    virtual ~MarginalLikelihood ();
+    virtual Eigen::VectorXd get_loghyper();
+    virtual void set_loghyper(const Eigen::VectorXd &p);
+    virtual double value();
+    virtual Eigen::VectorXd gradient();
+    virtual Objective * fork();
+  protected:
+    GaussianProcess * gp;
+    bool owned;
+  };
+
+  /** Leave-one-out log predictive probability of a Gaussian process, see
+   *  GaussianProcess::loo_log_predictive(). */
+  class LooPredictive : public MarginalLikelihood
+  {
+  public:
+    LooPredictive (GaussianProcess * gp, bool owned = false);
+    virtual ~LooPredictive ();
+    virtual double value();
+    virtual Eigen::VectorXd gradient();
+    virtual Objective * fork();
+  protected:
+    /** Value and gradient from a single inversion of the kernel matrix. */
+    virtual double evaluate(Eigen::VectorXd &grad);
+  };
+
+  /** Sum of the log marginal likelihoods of several Gaussian processes
+   *  sharing one set of hyperparameters, e.g. one dataset per device
+   *  observing the same process. All models need the same covariance
+   *  function, they are set to the hyperparameters of the first one on
+   *  construction. Likelihoods and gradients of the datasets are evaluated
+   *  in parallel (see parallel_for()), largest datasets first.
+   *  @author Manuel Blum */
+  class JointLikelihood : public Objective
+  {
+  public:
+    /** @param gps Gaussian processes, not owned
+     *  @param threads number of threads, 0 selects the hardware concurrency */
+    JointLikelihood (const std::vector<GaussianProcess *> & gps, size_t threads = 0);
+    virtual ~JointLikelihood ();
+    virtual Eigen::VectorXd get_loghyper();
+    virtual void set_loghyper(const Eigen::VectorXd &p);
+    virtual double value();
+    virtual Eigen::VectorXd gradient();
+  protected:
+    /** Value and gradient of each dataset in one parallel pass. */
+    virtual double evaluate(Eigen::VectorXd &grad);
+    std::vector<GaussianProcess *> gps;
+    size_t threads;
+  };
+}
+
+#endif /* __OBJECTIVE_H__ */
@@ -0,0 +1,111 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __ONLINE_ADAPTATION_H__
+#define __ONLINE_ADAPTATION_H__
+
+#include <future>
+#include <memory>
+#include <Eigen/Dense>
+
+#include "gp.h"
+
+namespace libgp {
+
+  /** Hyperparameter adaptation for models that grow by add_pattern().
+   *  After every batch of arrivals a few Adam steps are taken on the log
+   *  marginal likelihood of the most recent samples, which costs
+   *  O(window^3) instead of O(n^3). The model keeps its hyperparameters
+   *  and its incrementally updated factorization in the meantime. Once the
+   *  adapted hyperparameters drift too far from those of the model, a
+   *  full refit with RProp is started from them on a fork of the model
+   *  (see GaussianProcess::fork()). The refit and the factorization at its
+   *  result run in a background thread, samples arriving meanwhile are
+   *  appended incrementally when the refit is installed.
+   *  @author Manuel Blum */
+  class OnlineAdaptation
+  {
+  public:
+
+    /** @param gp streaming model, must outlive the adaptation */
+    OnlineAdaptation (GaussianProcess * gp);
+
+    /** Waits for a running refit, which is discarded. */
+    virtual ~OnlineAdaptation ();
+
+    /** @param batch number of arrivals between adaptation steps
+     *  @param window number of most recent samples of the step likelihood
+     *  @param steps Adam steps per batch
+     *  @param learning_rate step size of the log-hyperparameters
+     *  @param threshold drift that triggers a full refit
+     *  @param refit_iterations RProp iterations of a full refit */
+    void init(size_t batch = 25, size_t window = 200, size_t steps = 3, double learning_rate = 0.02,
+              double threshold = 0.5, size_t refit_iterations = 30);
+
+    /** Run refits in a background thread (default) or synchronously. */
+    void set_background(bool background);
+
+    /** Add a sample to the model and call update(). */
+    void add_pattern(const double x[], double y);
+
+    /** Install a finished refit and adapt if a batch of samples was added
+     *  to the model since the last adaptation. Call after adding samples
+     *  to the model directly.
+     *  @return true if a refit was installed */
+    bool update();
+
+    /** Install the refit if it has finished.
+     *  @return true if a refit was installed */
+    bool poll();
+
+    /** Wait for a running refit and install it.
+     *  @return true if a refit was installed */
+    bool wait();
+
+    /** Start a full refit from the adapted hyperparameters, unless one is
+     *  running already. */
+    void refit();
+
+    /** True while a refit is running or waits to be installed. */
+    bool refit_pending();
+
+    /** Largest absolute difference between the adapted log-hyperparameters
+     *  and those of the model. */
+    double get_drift();
+
+    /** Adapted log-hyperparameters. */
+    const Eigen::VectorXd & get_loghyper();
+
+    /** Number of refits installed so far. */
+    size_t get_refits();
+
+  private:
+    /** Adam steps on the most recent samples. */
+    void adapt();
+    /** Move the result of the refit into the model. */
+    void install();
+
+    GaussianProcess * gp;
+    size_t batch;
+    size_t window;
+    size_t steps;
+    double learning_rate;
+    double threshold;
+    size_t refit_iterations;
+    bool background;
+    /** model of the most recent samples */
+    std::unique_ptr<GaussianProcess> recent;
+    /** fork optimized by the refit */
+    std::unique_ptr<GaussianProcess> refitted;
+    std::future<void> pending;
+    Eigen::VectorXd loghyper;
+    Eigen::VectorXd m1;
+    Eigen::VectorXd m2;
+    size_t t;
+    size_t seen;
+    size_t refits;
+  };
+}
+
+#endif /* __ONLINE_ADAPTATION_H__ */
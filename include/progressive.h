@@ -0,0 +1,69 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __PROGRESSIVE_H__
+#define __PROGRESSIVE_H__
+
+#include <functional>
+#include <vector>
+#include <Eigen/Dense>
+
+#include "gp.h"
+#include "objective.h"
+
+namespace libgp {
+
+  /** Hyperparameter optimization on geometrically growing subsets of the
+   *  samples, e.g. n/64, n/16, n/4 and n. Each stage is warm-started from
+   *  the hyperparameters of the previous one, so that most evaluations of
+   *  the optimizer happen on small subsets. The subsets are spatially
+   *  stratified: the samples are ordered along a space-filling (Morton)
+   *  curve and every k-th sample is taken, which also makes them nested.
+   *  @author Manuel Blum */
+  class Progressive
+  {
+  public:
+
+    /** Runs an optimizer on an objective for a number of iterations. */
+    typedef std::function<void(Objective *, size_t)> Optimizer;
+
+    /** @param optimizer inner optimizer of each stage, e.g.
+     *  [](Objective * o, size_t n) { CG().maximize(o, n, false); } */
+    Progressive (const Optimizer & optimizer);
+
+    virtual ~Progressive ();
+
+    /** @param stages number of stages including the full dataset
+     *  @param factor growth of the subset size from stage to stage
+     *  @param min_size smallest subset, stages below are skipped */
+    void set_stages(size_t stages = 4, size_t factor = 4, size_t min_size = 32);
+
+    /** Maximize the log marginal likelihood of gp.
+     *  @param gp Gaussian process, set to the hyperparameters of the last stage
+     *  @param n iterations of the optimizer per stage
+     *  @return log-likelihood of the full dataset */
+    double maximize(GaussianProcess * gp, size_t n = 20);
+
+    /** Subset size of each stage of the last call of maximize(). */
+    const std::vector<size_t> & get_sizes();
+
+    /** Log-likelihood reached on the subset of each stage. */
+    const std::vector<double> & get_values();
+
+    /** Samples in the order of the space-filling curve, every k-th sample
+     *  of the order is a stratified subset of size n/k.
+     *  @param X inputs, one sample per row */
+    static std::vector<size_t> stratified_order(const Eigen::MatrixXd & X);
+
+  private:
+    Optimizer optimizer;
+    size_t stages;
+    size_t factor;
+    size_t min_size;
+    std::vector<size_t> sizes;
+    std::vector<double> values;
+  };
+}
+
+#endif /* __PROGRESSIVE_H__ */
@@ -6,18 +6,23 @@
 #define __RPROP_H__
 
 #include "gp.h"
+#include "objective.h"
+#include "stopping_criteria.h"
 #include <Eigen/Core>
 
 namespace libgp {
 
 /** Gradient-based optimizer.
  *  @author Manuel Blum */
-class RProp
+class RProp : public StoppingCriteria
 {
 public:
   RProp () {init();}
   void init(double eps_stop = 0.0, double Delta0=0.1, double Deltamin=1e-6, double Deltamax=50, double etaminus=0.5, double etaplus=1.2);
+  /** Maximize the log marginal likelihood of gp. */
   void maximize(GaussianProcess * gp, size_t n=100, bool verbose=1);
+  /** Maximize an arbitrary objective, e.g. LooPredictive. */
+  void maximize(Objective * objective, size_t n=100, bool verbose=1);
 private:
   double Delta0;
   double Deltamin;
@@ -6,11 +6,14 @@
 #define __SAMPLESET_H__
 
 #include <Eigen/Dense>
+#include <memory>
 #include <vector>
 
 namespace libgp {
   
-  /** Container holding training patterns.
+  /** Container holding training patterns. Input vectors are immutable
+   *  and shared between copies of a sample set, only the targets are
+   *  copied.
    *  @author Manuel Blum */
   class SampleSet
   {
@@ -30,6 +33,9 @@ namespace libgp {
      *  @param y target value */
     void add(const double x[], double y);
     void add(const Eigen::VectorXd x, double y);
+
+    /** Reserve storage for n samples. */
+    void reserve(size_t n);
     
     /** Get input vector at index k. */
     const Eigen::VectorXd & x (size_t k);
@@ -42,6 +48,9 @@ namespace libgp {
 
     /** Get reference to vector of target values. */
     const std::vector<double>& y();
+
+    /** Get reference to vector of pointers to the input vectors. */
+    const std::vector<Eigen::VectorXd *>& x();
     
     /** Get number of samples. */
     size_t size();
@@ -57,6 +66,9 @@ namespace libgp {
 
     /** Container holding input vectors. */
     std::vector<Eigen::VectorXd *> inputs;
+
+    /** Owners of the input vectors. */
+    std::vector<std::shared_ptr<Eigen::VectorXd> > storage;
     
     /** Container holding target values. */
     std::vector<double> targets;
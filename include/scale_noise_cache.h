@@ -0,0 +1,89 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __SCALE_NOISE_CACHE_H__
+#define __SCALE_NOISE_CACHE_H__
+
+#include <Eigen/Dense>
+
+#include "cov.h"
+#include "sampleset.h"
+
+namespace libgp {
+
+  /** Eigendecomposition of the kernel matrix of covariance functions of the
+   *  form \f$ sf^2 K_0 + s^2 I \f$ (see CovarianceFunction::scale_noise_form()).
+   *  With \f$ K_0 = Q \Lambda Q^T \f$ computed once, the kernel matrix for
+   *  any signal and noise level is \f$ Q (sf^2 \Lambda + s^2 I) Q^T \f$.
+   *  Solves and quadratic forms then cost O(n^2), the log-determinant O(n).
+   *  @author Manuel Blum */
+  class ScaleNoiseCache
+  {
+  public:
+    ScaleNoiseCache ();
+
+    virtual ~ScaleNoiseCache ();
+
+    /** Check if the covariance function has the required form and its
+     *  parameters differ from previous only in signal and noise level. */
+    static bool applicable(CovarianceFunction & cf, const Eigen::VectorXd & previous);
+
+    /** Check if the decomposition holds for the covariance function and n
+     *  samples, i.e. all parameters but signal and noise level agree. */
+    bool valid(CovarianceFunction & cf, size_t n);
+
+    /** Decompose the kernel matrix of the samples. The covariance
+     *  function must have the required form. */
+    void decompose(CovarianceFunction & cf, SampleSet & samples, CovarianceFunction::Workspace & ws);
+
+    /** Take signal and noise level from the covariance function. */
+    void set_scale_noise(CovarianceFunction & cf);
+
+    /** Check if the kernel matrix is positive definite, which fails e.g.
+     *  for a singular K_0 without noise term. */
+    bool positive_definite() const;
+
+    /** Invalidate decomposition, e.g. after the samples have changed. */
+    void clear();
+
+    /** alpha = K^-1 y */
+    void solve(const Eigen::VectorXd & y, Eigen::VectorXd & alpha) const;
+
+    /** log |K| */
+    double log_det() const;
+
+    /** k^T K^-1 k */
+    double quad_form(const Eigen::VectorXd & k) const;
+
+    /** K^-1 */
+    Eigen::MatrixXd inverse() const;
+
+    /** Derivatives of the log marginal likelihood of targets y with respect
+     *  to the log signal and noise level in O(n^2), zero for a missing level. */
+    void gradient(const Eigen::VectorXd & y, double & scale_grad, double & noise_grad) const;
+
+  private:
+
+    /** Parameters of the decomposition with signal and noise level zeroed. */
+    static Eigen::VectorXd k0_params(CovarianceFunction & cf, int scale, int noise);
+
+    /** Eigenvectors of K_0. */
+    Eigen::MatrixXd Q;
+
+    /** Eigenvalues of K_0. */
+    Eigen::VectorXd lambda;
+
+    /** Eigenvalues of K. */
+    Eigen::VectorXd d;
+
+    /** Signal and noise level of d. */
+    double sf2, s2;
+
+    Eigen::VectorXd params;
+
+    int scale, noise;
+  };
+}
+
+#endif /* __SCALE_NOISE_CACHE_H__ */
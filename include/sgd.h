@@ -0,0 +1,56 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __SGD_H__
+#define __SGD_H__
+
+#include "gp.h"
+#include <random>
+#include <Eigen/Core>
+
+namespace libgp {
+
+/** Stochastic gradient optimizer for large datasets. Each step estimates
+ *  the gradient of the log marginal likelihood from a random subset of m
+ *  samples, so that a step costs O(m^3) instead of O(n^3). The update is
+ *  Adam or gradient ascent with momentum, optionally followed by a few
+ *  full-batch iterations of RProp or CG.
+ *  @author Manuel Blum */
+class SGD
+{
+public:
+  /** Full-batch optimizer run after the stochastic steps. */
+  enum Polish { NO_POLISH, POLISH_RPROP, POLISH_CG };
+
+  SGD () {init();}
+  /** @param batch_size number of samples per step
+   *  @param learning_rate initial step size
+   *  @param decay learning rate after t steps is learning_rate / (1 + decay t)
+   *  @param adam scale steps by the second moment (Adam), otherwise momentum only
+   *  @param beta1 decay rate of the first moment
+   *  @param beta2 decay rate of the second moment */
+  void init(size_t batch_size = 256, double learning_rate = 0.05, double decay = 0.0,
+            bool adam = true, double beta1 = 0.9, double beta2 = 0.999);
+  /** Full-batch polish after the stochastic steps.
+   *  @param n iterations of the full-batch optimizer */
+  void set_polish(Polish polish, size_t n = 20);
+  /** Seed of the random subsets. */
+  void seed(unsigned int seed);
+  /** Maximize the log marginal likelihood of gp.
+   *  @param n number of stochastic steps */
+  void maximize(GaussianProcess * gp, size_t n=100, bool verbose=1);
+private:
+  size_t batch_size;
+  double learning_rate;
+  double decay;
+  bool adam;
+  double beta1;
+  double beta2;
+  Polish polish;
+  size_t polish_n;
+  std::mt19937 rng;
+};
+}
+
+#endif /* __SGD_H__ */
@@ -0,0 +1,54 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __SIMD_MATH_H__
+#define __SIMD_MATH_H__
+
+#include <cstddef>
+
+#include "gp_version.h"
+
+namespace libgp {
+
+  /** Elementwise transcendental functions on arrays of doubles.
+   *  On x86-64 with GCC or Clang, AVX2 and AVX-512 variants based on
+   *  polynomial approximations are compiled in and the best variant
+   *  supported by the CPU is selected at runtime. Otherwise, or if
+   *  SCALAR is selected, the C library functions are used.
+   *
+   *  Maximum error of the vectorized variants in units in the last place:
+   *    - exp: at most 2 ulp. Results below 3.3e-308 (x < -708) are
+   *      flushed to zero, x > 709.78 gives infinity.
+   *    - log: at most 2 ulp, including subnormal inputs.
+   *    - sin: at most 3 ulp for |x| < 2^19. Larger or non-finite
+   *      arguments are passed to the C library.
+   *  Special values (NaN, infinity, zero) follow the C library.
+   *  Input and output arrays may be identical. */
+  namespace simd {
+
+    /** Instruction set variants. */
+    enum Isa { SCALAR, AVX2, AVX512 };
+
+    /** Best variant supported by compiler and CPU. */
+    LIBGP_EXPORT Isa best_isa();
+
+    /** Currently selected variant. */
+    LIBGP_EXPORT Isa get_isa();
+
+    /** Select variant, e.g. SCALAR to obtain reference results.
+     *  @return false if the variant is not supported */
+    LIBGP_EXPORT bool set_isa(Isa isa);
+
+    /** y[i] = exp(x[i]) for i = 0, ..., n-1 */
+    LIBGP_EXPORT void exp(const double x[], double y[], size_t n);
+
+    /** y[i] = log(x[i]) for i = 0, ..., n-1 */
+    LIBGP_EXPORT void log(const double x[], double y[], size_t n);
+
+    /** y[i] = sin(x[i]) for i = 0, ..., n-1 */
+    LIBGP_EXPORT void sin(const double x[], double y[], size_t n);
+  }
+}
+
+#endif /* __SIMD_MATH_H__ */
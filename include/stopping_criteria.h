@@ -0,0 +1,99 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __STOPPING_CRITERIA_H__
+#define __STOPPING_CRITERIA_H__
+
+#include <chrono>
+#include <functional>
+#include <Eigen/Core>
+
+namespace libgp {
+
+  /** Progress of an optimizer after an iteration. */
+  struct OptimizerStats
+  {
+    /** Iterations so far, counted as the n passed to maximize(). */
+    size_t iteration;
+    /** Current log-hyperparameters. */
+    Eigen::VectorXd loghyper;
+    /** Objective at loghyper, e.g. the log marginal likelihood. */
+    double value;
+    /** Norm of the gradient of the objective at loghyper. */
+    double gradient_norm;
+    /** Wall-clock time since the start of maximize() in seconds. */
+    double elapsed;
+  };
+
+  /** Wall-clock budget, early stopping and progress reporting of the
+   *  gradient-based optimizers. All criteria are disabled by default, so
+   *  that only the number of iterations limits an optimization.
+   *  @author Manuel Blum */
+  class StoppingCriteria
+  {
+  public:
+
+    /** Receives the stats of every iteration, returning false stops the
+     *  optimizer. */
+    typedef std::function<bool(const OptimizerStats &)> Callback;
+
+    /** Reasons for the end of an optimization. */
+    enum Reason { MAX_ITERATIONS, TIME_LIMIT, RELATIVE_IMPROVEMENT, GRADIENT_NORM, NO_PROGRESS, CALLBACK };
+
+    StoppingCriteria ();
+
+    virtual ~StoppingCriteria ();
+
+    /** Stop after a wall-clock duration from the start of maximize().
+     *  @param seconds maximum duration, 0 disables the limit */
+    void set_time_limit(double seconds);
+
+    /** Stop at a point in time, in addition to the time limit. */
+    void set_deadline(const std::chrono::steady_clock::time_point & deadline);
+
+    /** Remove the deadline. */
+    void clear_deadline();
+
+    /** Stop on convergence, 0 disables a criterion.
+     *  @param rel_improvement stop if the objective changes by less than
+     *  rel_improvement * max(1, |objective|) in an iteration
+     *  @param gradient_norm stop if the gradient norm falls below */
+    void set_tolerance(double rel_improvement, double gradient_norm = 0);
+
+    /** Called after every iteration, replaces the previous callback. */
+    void set_callback(const Callback & callback);
+
+    /** Why the last call of maximize() returned. */
+    Reason get_stop_reason();
+
+  protected:
+
+    /** Start the clock at the beginning of maximize().
+     *  @param value objective at the initial log-hyperparameters */
+    void start(double value);
+
+    /** True once the time limit or the deadline is reached. */
+    bool out_of_time();
+
+    /** Report an iteration to the callback and check the criteria.
+     *  @return true if the optimizer should stop */
+    bool stop(size_t iteration, const Eigen::VectorXd & loghyper, double value, const Eigen::VectorXd & gradient);
+
+    /** Record a stop for a reason detected by the optimizer itself. */
+    void stopped(Reason reason);
+
+  private:
+    double time_limit;
+    bool has_deadline;
+    std::chrono::steady_clock::time_point deadline;
+    double rel_improvement;
+    double gradient_norm;
+    Callback callback;
+    std::chrono::steady_clock::time_point started;
+    double previous;
+    Reason reason;
+  };
+}
+
+#endif /* __STOPPING_CRITERIA_H__ */
@@ -0,0 +1,45 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __TRUST_REGION_H__
+#define __TRUST_REGION_H__
+
+#include "gp.h"
+#include "stopping_criteria.h"
+#include <Eigen/Core>
+
+namespace libgp {
+
+/** Trust-region Newton optimizer using the analytic Hessian of the log
+ *  marginal likelihood (see GaussianProcess::log_likelihood_hessian()).
+ *  Every iteration factorizes the kernel matrix once, and for small
+ *  numbers of hyperparameters the method typically converges in about
+ *  ten iterations. The subproblem is solved exactly from the
+ *  eigendecomposition of the Hessian, so indefinite Hessians are handled.
+ *  @author Manuel Blum */
+class TrustRegion : public StoppingCriteria
+{
+public:
+  TrustRegion () {init();}
+  /** @param radius initial trust-region radius
+   *  @param radius_max largest trust-region radius
+   *  @param eta minimum ratio of actual to predicted improvement of accepted steps
+   *  @param eps_stop stop if the gradient is smaller (max-norm) */
+  void init(double radius = 1.0, double radius_max = 10.0, double eta = 0.1, double eps_stop = 1e-5);
+  /** Maximize the log marginal likelihood of gp.
+   *  @param n maximum number of iterations, i.e. factorizations */
+  void maximize(GaussianProcess * gp, size_t n=20, bool verbose=1);
+  /** Minimizer of g^T p + p^T B p / 2 subject to |p| <= radius.
+   *  @param B symmetric matrix
+   *  @param g gradient */
+  static Eigen::VectorXd solve_subproblem(const Eigen::MatrixXd & B, const Eigen::VectorXd & g, double radius);
+private:
+  double radius;
+  double radius_max;
+  double eta;
+  double eps_stop;
+};
+}
+
+#endif /* __TRUST_REGION_H__ */
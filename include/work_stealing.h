@@ -0,0 +1,28 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __WORK_STEALING_H__
+#define __WORK_STEALING_H__
+
+#include <cstddef>
+#include <functional>
+
+namespace libgp {
+
+  /** Run task(i, t) for i = 0, ..., count-1 on a number of threads, where t
+   *  is the index of the executing thread. The tasks are dealt round-robin
+   *  to one queue per thread. Each thread works on its own queue from the
+   *  front and steals from the back of the other queues once it runs dry,
+   *  so tasks should be ordered by decreasing cost. The first exception
+   *  thrown by a task is rethrown after all threads have finished.
+   *  @param count number of tasks
+   *  @param threads number of threads, 0 selects the hardware concurrency
+   *  @param task function called for each task */
+  void parallel_for(size_t count, size_t threads, const std::function<void(size_t, size_t)> & task);
+
+  /** Number of threads parallel_for() uses for count tasks. */
+  size_t parallel_threads(size_t count, size_t threads);
+}
+
+#endif /* __WORK_STEALING_H__ */
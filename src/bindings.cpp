@@ -5,6 +5,10 @@
 #include "cov_factory.h"
 #include "rprop.h"
 #include "cg.h"
+#include "lbfgsb.h"
+#include "sgd.h"
+#include "trust_region.h"
+#include "online_adaptation.h"
 
 namespace py = pybind11;
 
@@ -47,6 +51,16 @@ PYBIND11_MODULE(libgp_cpp, m) {
         .def("get_sampleset", &libgp::GaussianProcess::get_sampleset)
         .def("get_log_likelihood", &libgp::GaussianProcess::log_likelihood)
         .def("get_log_likelihood_gradient", &libgp::GaussianProcess::log_likelihood_gradient)
+        .def("get_log_likelihood_hessian", py::overload_cast<>(&libgp::GaussianProcess::log_likelihood_hessian))
+        .def("get_log_likelihood_batch", [](libgp::GaussianProcess& self, const Eigen::MatrixXd& theta,
+                                            bool compute_gradient, size_t threads) {
+            Eigen::MatrixXd grad;
+            Eigen::VectorXd values = self.log_likelihood_batch(theta, compute_gradient ? &grad : NULL, threads);
+            return py::make_tuple(values, grad);
+        }, py::arg("theta"), py::arg("compute_gradient") = false, py::arg("threads") = 0)
+        .def("loo_predict", &libgp::GaussianProcess::loo_predict)
+        .def("get_loo_log_predictive", py::overload_cast<>(&libgp::GaussianProcess::loo_log_predictive))
+        .def("get_loo_log_predictive_gradient", &libgp::GaussianProcess::loo_log_predictive_gradient)
         .def("get_input_dim", &libgp::GaussianProcess::get_input_dim)
         .def("set_loghyper", [](libgp::GaussianProcess& self, py::array_t<double> params) {
             py::buffer_info buf = params.request();
@@ -77,9 +91,59 @@ PYBIND11_MODULE(libgp_cpp, m) {
     py::class_<libgp::RProp>(m, "RProp")
         .def(py::init<>())
         .def("init", &libgp::RProp::init)
-        .def("maximize", &libgp::RProp::maximize);
+        .def("set_time_limit", &libgp::RProp::set_time_limit)
+        .def("set_tolerance", &libgp::RProp::set_tolerance)
+        .def("maximize", py::overload_cast<libgp::GaussianProcess *, size_t, bool>(&libgp::RProp::maximize));
 
     py::class_<libgp::CG>(m, "CG")
         .def(py::init<>())
-        .def("maximize", &libgp::CG::maximize);
+        .def("set_time_limit", &libgp::CG::set_time_limit)
+        .def("set_tolerance", &libgp::CG::set_tolerance)
+        .def("maximize", py::overload_cast<libgp::GaussianProcess *, size_t, bool>(&libgp::CG::maximize))
+        .def("set_parallel", &libgp::CG::set_parallel);
+
+    py::class_<libgp::LBFGSB>(m, "LBFGSB")
+        .def(py::init<>())
+        .def("init", &libgp::LBFGSB::init)
+        .def("set_bounds", py::overload_cast<double, double>(&libgp::LBFGSB::set_bounds))
+        .def("set_time_limit", &libgp::LBFGSB::set_time_limit)
+        .def("set_tolerance", &libgp::LBFGSB::set_tolerance)
+        .def("maximize", py::overload_cast<libgp::GaussianProcess *, size_t, bool>(&libgp::LBFGSB::maximize));
+
+    py::class_<libgp::TrustRegion>(m, "TrustRegion")
+        .def(py::init<>())
+        .def("init", &libgp::TrustRegion::init)
+        .def("set_time_limit", &libgp::TrustRegion::set_time_limit)
+        .def("set_tolerance", &libgp::TrustRegion::set_tolerance)
+        .def("maximize", &libgp::TrustRegion::maximize);
+
+    py::class_<libgp::SGD> sgd(m, "SGD");
+    sgd.def(py::init<>())
+        .def("init", &libgp::SGD::init)
+        .def("set_polish", &libgp::SGD::set_polish)
+        .def("seed", &libgp::SGD::seed)
+        .def("maximize", &libgp::SGD::maximize);
+    py::enum_<libgp::SGD::Polish>(sgd, "Polish")
+        .value("NO_POLISH", libgp::SGD::NO_POLISH)
+        .value("POLISH_RPROP", libgp::SGD::POLISH_RPROP)
+        .value("POLISH_CG", libgp::SGD::POLISH_CG);
+
+    py::class_<libgp::OnlineAdaptation>(m, "OnlineAdaptation")
+        .def(py::init<libgp::GaussianProcess *>(), py::keep_alive<1, 2>())
+        .def("init", &libgp::OnlineAdaptation::init)
+        .def("set_background", &libgp::OnlineAdaptation::set_background)
+        .def("add_pattern", [](libgp::OnlineAdaptation& self, py::array_t<double> x, double y) {
+            py::buffer_info buf = x.request();
+            if (buf.ndim != 1)
+                throw std::runtime_error("Input array must be 1-dimensional");
+            self.add_pattern(static_cast<double*>(buf.ptr), y);
+        })
+        .def("update", &libgp::OnlineAdaptation::update)
+        .def("poll", &libgp::OnlineAdaptation::poll)
+        .def("wait", &libgp::OnlineAdaptation::wait, py::call_guard<py::gil_scoped_release>())
+        .def("refit", &libgp::OnlineAdaptation::refit)
+        .def("refit_pending", &libgp::OnlineAdaptation::refit_pending)
+        .def("get_drift", &libgp::OnlineAdaptation::get_drift)
+        .def("get_loghyper", &libgp::OnlineAdaptation::get_loghyper)
+        .def("get_refits", &libgp::OnlineAdaptation::get_refits);
 }
\ No newline at end of file
@@ -6,8 +6,11 @@
  */
 
 #include "cg.h"
+#include "work_stealing.h"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 #include <Eigen/Core>
 
@@ -18,13 +21,25 @@ namespace libgp
 
 CG::CG()
 {
+	points = 1;
 }
 
 CG::~CG()
 {
 }
 
+void CG::set_parallel(size_t points)
+{
+	this->points = std::max<size_t>(1, points);
+}
+
 void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
+{
+	MarginalLikelihood objective(gp);
+	maximize(&objective, n, verbose);
+}
+
+void CG::maximize(Objective* objective, size_t n, bool verbose)
 {
 	const double INT = 0.1; // don't reevaluate within 0.1 of the limit of the current bracket
 	const double EXT = 3.0; // extrapolate maximum 3 times the current step-size
@@ -58,12 +73,32 @@ void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
 	*/
 
 
+	objective->clear_cache();
 	bool ls_failed = false;									//prev line-search failed
-	double f0 = -gp->log_likelihood();						//initial negative marginal log likelihood
-	Eigen::VectorXd df0 = -gp->log_likelihood_gradient();	//initial gradient
-	Eigen::VectorXd X = gp->covf().get_loghyper();			//hyper parameters
+	Eigen::VectorXd X = objective->get_loghyper();			//hyper parameters
+	Eigen::VectorXd df0;
+	double f0 = -objective->value_and_gradient(X, df0);	//initial negative objective
+	df0 = -df0;												//initial gradient
+
+	// evaluators of concurrent line search points, the first is the objective itself
+	std::vector<Objective *> evaluators(1, objective);
+	for (size_t k = 1; k < points; ++k)
+	{
+		Objective * forked = objective->fork();
+		if (forked == NULL) break;
+		evaluators.push_back(forked);
+	}
+	bool parallel = evaluators.size() > 1;
+
+	// step lengths, negative objectives and gradients of the last batch
+	std::vector<double> batch_x, batch_f;
+	std::vector<Eigen::VectorXd> batch_df;
+	Eigen::VectorXd X0;
+	double F0 = 0;
+	Eigen::VectorXd dF0;
 
 	if(verbose) cout << f0 << endl;
+	start(-f0);
 
 	Eigen::VectorXd s = -df0;								//initial search direction
 	double d0 = -s.dot(s);									//initial slope
@@ -77,12 +112,53 @@ void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
 	double f2 = 0, f4 = 0;
 	double d2 = 0, d4 = 0;
 
+	auto in_batch = [&](double x) {
+		return std::find(batch_x.begin(), batch_x.end(), x) != batch_x.end();
+	};
+
+	// evaluate step lengths concurrently and keep the best point
+	auto evaluate_batch = [&](const std::vector<double> & steps) {
+		batch_x = steps;
+		batch_f.resize(steps.size());
+		batch_df.resize(steps.size());
+		parallel_for(steps.size(), steps.size(), [&](size_t k, size_t) {
+			batch_f[k] = -evaluators[k]->value_and_gradient(X+s*steps[k], batch_df[k]);
+			batch_df[k] = -batch_df[k];
+		});
+		for (size_t k = 0; k < steps.size(); ++k)
+		{
+			if(batch_f[k] < F0 && batch_df[k].allFinite())
+			{
+				X0 = X+s*steps[k];
+				F0 = batch_f[k];
+				dF0 = batch_df[k];
+			}
+		}
+	};
+
+	// negative objective and gradient at step length x, from the last batch if possible
+	auto evaluate = [&](double x, double & f, Eigen::VectorXd & df) {
+		for (size_t k = 0; k < batch_x.size(); ++k)
+		{
+			if (batch_x[k] == x)
+			{
+				f = batch_f[k];
+				df = batch_df[k];
+				return;
+			}
+		}
+		f = -objective->value_and_gradient(X+s*x, df);
+		df = -df;
+	};
+
 	for (unsigned int i = 0; i < n; ++i)
 	{
+		if(out_of_time()) break;
 		//copy current values
-		Eigen::VectorXd X0 = X;
-		double F0 = f0;
-		Eigen::VectorXd dF0 = df0;
+		X0 = X;
+		F0 = f0;
+		dF0 = df0;
+		batch_x.clear();
 		unsigned int M = min(MAX, (int)(n-i));
 
 		while(1)											//keep extrapolating until necessary
@@ -96,11 +172,23 @@ void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
 
 			while( !success && M>0)
 			{
+				if(out_of_time())							// leave the line search at the best point
+				{
+					M = 0;
+					break;
+				}
 				M --;
 				i++;
-				gp->covf().set_loghyper(X+s*x3);
-				f3 = -gp->log_likelihood();
-				df3 = -gp->log_likelihood_gradient();
+				if(parallel && !in_batch(x3))				// speculate on maximal extrapolation steps
+				{
+					std::vector<double> steps(1, x3);
+					while(steps.size() < evaluators.size() && i+steps.size() <= n)
+						steps.push_back(steps.back()*EXT);
+					evaluate_batch(steps);
+					i += steps.size()-1;					// speculative points count against n
+					M = std::min<unsigned int>(M, i < n ? n-i : 0);
+				}
+				evaluate(x3, f3, df3);
 
 				if(verbose) cout << f3 << endl;
 
@@ -149,6 +237,8 @@ void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
 
 		while( ( (abs(d3) > -SIG*d0) || (f3 > f0+x3*RHO*d0) ) && (M > 0))	// keep interpolating
 		{
+			if(out_of_time())
+				break;
 			if( (d3 > 0) || (f3 > f0+x3*RHO*d0) )			// choose subinterval
 			{												// move point 3 to point 4
 				x4 = x3;
@@ -176,9 +266,47 @@ void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
 
 			x3 = std::max(std::min(x3, x4-INT*(x4-x2)), x2+INT*(x4-x2));
 
-			gp->covf().set_loghyper(X+s*x3);
-			f3 = -gp->log_likelihood();
-			df3 = -gp->log_likelihood_gradient();
+			if(parallel)
+			{
+				// interpolated point and equally spaced points inside the bracket
+				std::vector<double> steps(1, x3);
+				double lo = x2+INT*(x4-x2), hi = x4-INT*(x4-x2);
+				for (size_t k = 1; k < evaluators.size() && i+k < n; ++k)
+					steps.push_back(lo + (hi-lo)*k/evaluators.size());
+				evaluate_batch(steps);
+				i += steps.size()-1;						// additional points count against n
+				// accept the best point satisfying the Wolfe-Powell conditions
+				int accept = -1;
+				for (size_t k = 0; k < steps.size(); ++k)
+				{
+					double dk = batch_df[k].dot(s);
+					if( (abs(dk) <= -SIG*d0) && (batch_f[k] <= f0+steps[k]*RHO*d0)
+					    && (accept < 0 || batch_f[k] < batch_f[accept]) )
+						accept = k;
+				}
+				if(accept >= 0)
+					x3 = steps[accept];
+				else
+				{
+					// otherwise narrow the bracket, the first point that
+					// qualifies as point 4 is classified in the next iteration
+					std::sort(steps.begin(), steps.end());
+					for (size_t k = 0; k < steps.size(); ++k)
+					{
+						double fk, dk;
+						Eigen::VectorXd dfk;
+						evaluate(steps[k], fk, dfk);
+						dk = dfk.dot(s);
+						x3 = steps[k];
+						if( (dk > 0) || (fk > f0+steps[k]*RHO*d0) )
+							break;
+						x2 = steps[k];
+						f2 = fk;
+						d2 = dk;
+					}
+				}
+			}
+			evaluate(x3, f3, df3);								// memoized, points are not evaluated twice
 
 			if(f3 < F0)												// keep best values
 			{
@@ -191,6 +319,8 @@ void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
 
 			M--;
 			i++;
+			if(parallel)
+				M = std::min<unsigned int>(M, i < n ? n-i : 0);
 			d3 = df3.dot(s);										// new slope
 		}
 
@@ -210,6 +340,8 @@ void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
 
 			x3 = x3 * std::min(RATIO, d3/(d0-std::numeric_limits< double >::min()));	// slope ratio but max RATIO
 			ls_failed = false;																// this line search did not fail
+			if(stop(i, X, -f0, df0))
+				break;
 		}
 		else
 		{														// restore best point so far
@@ -219,8 +351,13 @@ void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
 
 			if(verbose) cout << f0 << endl;
 
-			if(ls_failed || i >= n)								// line search failed twice in a row
-				break;											// or we ran out of time, so we give up
+			if(ls_failed)										// line search failed twice in a row
+			{
+				stopped(NO_PROGRESS);
+				break;
+			}
+			if(i >= n || out_of_time())							// or we ran out of time, so we give up
+				break;
 
 			s = -df0;
 			d0 = -s.dot(s);										// try steepest
@@ -230,7 +367,9 @@ void CG::maximize(GaussianProcess* gp, size_t n, bool verbose)
 
 
 	}
-	gp->covf().set_loghyper(X);
+	for (size_t k = 1; k < evaluators.size(); ++k)
+		delete evaluators[k];
+	objective->set_loghyper(X);
 }
 
 }
@@ -3,11 +3,101 @@
 // All rights reserved.
 
 #include "cov.h"
+#include "cov_factory.h"
 #include "gp_utils.h"
 
+#include <stdexcept>
+
 namespace libgp
 {
   
+  Eigen::VectorXd & CovarianceFunction::Workspace::acquire(int n)
+  {
+    if (used == pool.size()) pool.push_back(Eigen::VectorXd());
+    Eigen::VectorXd & v = pool[used++];
+    if (v.size() != n) v.resize(n);
+    return v;
+  }
+
+  void CovarianceFunction::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                          Eigen::Ref<Eigen::VectorXd> grad, Workspace &ws)
+  {
+    Eigen::VectorXd & g = ws.acquire(param_dim);
+    k = get(x1, x2);
+    this->grad(x1, x2, g);
+    grad = g;
+    ws.release();
+  }
+
+  void CovarianceFunction::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    const double h = 1e-5;
+    Eigen::VectorXd p0 = loghyper, p = loghyper, g_plus(param_dim), g_minus(param_dim);
+    bool changed = loghyper_changed;
+    for (size_t i = 0; i < param_dim; ++i) {
+      p(i) = p0(i) + h;
+      set_loghyper(p);
+      grad(x1, x2, g_plus);
+      p(i) = p0(i) - h;
+      set_loghyper(p);
+      grad(x1, x2, g_minus);
+      p(i) = p0(i);
+      hess.col(i) = (g_plus - g_minus) / (2*h);
+    }
+    set_loghyper(p0);
+    loghyper_changed = changed;
+    hess = (0.5 * (hess + hess.transpose())).eval();
+  }
+
+  void CovarianceFunction::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                                   Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] Workspace &ws)
+  {
+    for (int i = 0; i < k.size(); ++i) k(i) = get(x, *X[i]);
+  }
+
+  bool CovarianceFunction::scale_noise_form(int &scale, int &noise)
+  {
+    scale = noise = -1;
+    return false;
+  }
+
+  bool CovarianceFunction::feature_form(int &features, int &noise)
+  {
+    features = 0;
+    noise = -1;
+    return false;
+  }
+
+  void CovarianceFunction::features([[maybe_unused]] const Eigen::VectorXd &x,
+                                    [[maybe_unused]] Eigen::Ref<Eigen::VectorXd> phi)
+  {
+    throw std::runtime_error(to_string() + " has no feature representation");
+  }
+
+  void CovarianceFunction::feature_params([[maybe_unused]] Eigen::Ref<Eigen::VectorXi> param)
+  {
+    throw std::runtime_error(to_string() + " has no feature representation");
+  }
+
+  bool CovarianceFunction::get_row_from_distances([[maybe_unused]] const Eigen::Ref<const Eigen::VectorXd> &d2,
+                                                  [[maybe_unused]] bool self,
+                                                  [[maybe_unused]] Eigen::Ref<Eigen::VectorXd> k,
+                                                  [[maybe_unused]] Workspace &ws)
+  {
+    return false;
+  }
+
+  bool CovarianceFunction::supports_distances()
+  {
+    return false;
+  }
+
+  void CovarianceFunction::squared_distances(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                                             Eigen::Ref<Eigen::VectorXd> d)
+  {
+    for (int i = 0; i < d.size(); ++i) d(i) = (x - *X[i]).squaredNorm();
+  }
+
   size_t CovarianceFunction::get_param_dim()
   {
     return param_dim;
@@ -37,6 +127,14 @@ namespace libgp
   }
 
   
+  CovarianceFunction * CovarianceFunction::clone()
+  {
+    CovarianceFunction * copy = CovFactory().create(input_dim, to_string());
+    copy->set_loghyper(loghyper);
+    copy->loghyper_changed = loghyper_changed;
+    return copy;
+  }
+
   Eigen::VectorXd CovarianceFunction::draw_random_sample(Eigen::MatrixXd &X)
   {
     assert (X.cols() == int(input_dim));  
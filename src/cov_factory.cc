@@ -20,6 +20,11 @@
 #include "cov_periodic_matern3_iso.h"
 #include "cov_periodic.h"
 #include "input_dim_filter.h"
+#include "cov_fixed.h"
+#include "cov_static.h"
+
+#include <algorithm>
+#include <utility>
 
 namespace libgp {
   
@@ -37,8 +42,52 @@ namespace libgp {
     registry["CovPeriodicMatern3iso"] = & create_func<CovPeriodicMatern3iso>;
     registry["CovPeriodic"] = & create_func<CovPeriodic>;
     registry["InputDimFilter"] = & create_func<InputDimFilter>;
+    register_fixed<CovMatern3isoFixed>("CovMatern3iso");
+    register_fixed<CovMatern5isoFixed>("CovMatern5iso");
+    register_fixed<CovNoiseFixed>("CovNoise");
+    register_fixed<CovRQisoFixed>("CovRQiso");
+    register_fixed<CovSEardFixed>("CovSEard");
+    register_fixed<CovSEisoFixed>("CovSEiso");
+    register_fixed<CovSumFixed>("CovSum");
+    register_fixed<CovProdFixed>("CovProd");
+    register_static<expr::Sum<expr::SEiso, expr::Noise> >();
+    register_static<expr::Sum<expr::SEard, expr::Noise> >();
+    register_static<expr::Sum<expr::Matern3iso, expr::Noise> >();
+    register_static<expr::Sum<expr::Matern5iso, expr::Noise> >();
+    register_static<expr::Sum<expr::RQiso, expr::Noise> >();
+    register_static<expr::Sum<expr::Linearone, expr::Noise> >();
+    register_static<expr::Sum<expr::Sum<expr::SEiso, expr::Linearone>, expr::Noise> >();
+    register_static<expr::Sum<expr::Prod<expr::SEiso, expr::Linearone>, expr::Noise> >();
+    register_static<expr::Sum<expr::Sum<expr::Filter<0, expr::SEiso>, expr::Filter<1, expr::SEiso> >, expr::Noise> >();
+  }
+
+  template <template <int> class ClassName, int... D>
+  static std::vector<CovFactory::create_func_def> fixed_creators(std::integer_sequence<int, D...>)
+  {
+    return std::vector<CovFactory::create_func_def>{ & create_func<ClassName<D + 1> >... };
+  }
+
+  template <template <int> class ClassName>
+  void CovFactory::register_fixed(const std::string & func)
+  {
+    fixed_registry[func] = fixed_creators<ClassName>(std::make_integer_sequence<int, max_fixed_dim>());
   }
   
+  template <class Expr, int... D>
+  static std::vector<CovFactory::create_func_def> static_creators(std::integer_sequence<int, D...>)
+  {
+    return std::vector<CovFactory::create_func_def>{ & create_func<CovStatic<Expr> >,
+                                                     & create_func<CovStaticFixed<Expr, D + 1> >... };
+  }
+
+  template <class Expr>
+  void CovFactory::register_static()
+  {
+    std::string key = Expr().to_string();
+    key.erase(std::remove(key.begin(), key.end(), ' '), key.end());
+    static_registry[key] = static_creators<Expr>(std::make_integer_sequence<int, max_fixed_dim>());
+  }
+
   CovFactory::~CovFactory () {};
   
   libgp::CovarianceFunction* CovFactory::create(size_t input_dim, const std::string key) {
@@ -48,6 +97,9 @@ namespace libgp {
     //remove whitespace 
     std::string trimmed = key;
     for(size_t i=0; i<trimmed.length(); i++) if(trimmed[i] == ' ') trimmed.erase(i,1);
+
+    // common compositions are precompiled, the tree below is the fallback
+    if ((covf = create_static(trimmed, input_dim)) != NULL) return covf;
     
     // find parenthesis
     size_t left = trimmed.find_first_of('(');
@@ -70,13 +122,14 @@ namespace libgp {
       std::cerr << "fatal error while parsing covariance function: " << func << " not found" << std::endl;
       exit(0);
     } 
-    covf = registry.find(func)->second();
     if (left == right) {
+      covf = create_instance(func, input_dim, true);
       if (!covf->init(input_dim)) {
         delete covf;
         return NULL;
       }
     } else if (sep == 0) {
+      covf = it->second();
       size_t sep = arg.find_first_of('/');
       int filter = atoi(arg.substr(1,sep-1).c_str());
       std::string second = arg.substr(sep+1, arg.length() - sep - 2);
@@ -85,9 +138,12 @@ namespace libgp {
         return NULL;
       }
     } else {
-      if (!covf->init(input_dim, 
-            create(input_dim, arg.substr(1,sep-1)), 
-            create(input_dim, arg.substr(sep+1, arg.length()-sep-2)))) {
+      CovarianceFunction * first = create(input_dim, arg.substr(1,sep-1));
+      CovarianceFunction * second = create(input_dim, arg.substr(sep+1, arg.length()-sep-2));
+      // composites are specialized if both operands are
+      covf = create_instance(func, input_dim, dynamic_cast<CovFixedBase *>(first) != NULL
+                                              && dynamic_cast<CovFixedBase *>(second) != NULL);
+      if (!covf->init(input_dim, first, second)) {
         delete covf;
         return NULL;
       }
@@ -95,6 +151,27 @@ namespace libgp {
     return covf;
   }
 
+  CovarianceFunction * CovFactory::create_instance(const std::string & func, size_t input_dim, bool fixed)
+  {
+    std::map<std::string, std::vector<create_func_def> >::iterator it = fixed_registry.find(func);
+    if (fixed && it != fixed_registry.end() && input_dim >= 1 && input_dim <= it->second.size()) {
+      return it->second[input_dim - 1]();
+    }
+    return registry.find(func)->second();
+  }
+
+  CovarianceFunction * CovFactory::create_static(const std::string & trimmed, size_t input_dim)
+  {
+    std::map<std::string, std::vector<create_func_def> >::iterator it = static_registry.find(trimmed);
+    if (it == static_registry.end()) return NULL;
+    CovarianceFunction * covf = it->second[input_dim < it->second.size() ? input_dim : 0]();
+    if (!covf->init(input_dim)) {
+      delete covf;
+      return NULL;
+    }
+    return covf;
+  }
+
   std::vector<std::string> CovFactory::list()
   {
     std::vector<std::string> products;
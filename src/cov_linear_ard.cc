@@ -31,6 +31,40 @@ namespace libgp
     grad = -2*x1.cwiseQuotient(ell).cwiseProduct(x2.cwiseQuotient(ell));
   }
   
+  void CovLinearard::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                    Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    k = 0;
+    for (size_t i = 0; i < input_dim; ++i) {
+      grad(i) = x1(i) * x2(i) / (ell(i) * ell(i));
+      k += grad(i);
+    }
+    grad *= -2;
+  }
+  
+  bool CovLinearard::feature_form(int &features, int &noise)
+  {
+    features = input_dim;
+    noise = -1;
+    return true;
+  }
+
+  void CovLinearard::features(const Eigen::VectorXd &x, Eigen::Ref<Eigen::VectorXd> phi)
+  {
+    phi = x;
+  }
+
+  void CovLinearard::feature_params(Eigen::Ref<Eigen::VectorXi> param)
+  {
+    for (size_t i = 0; i < input_dim; ++i) param(i) = i;
+  }
+
+  void CovLinearard::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    hess.setZero();
+    hess.diagonal() = 4*x1.cwiseQuotient(ell).cwiseProduct(x2.cwiseQuotient(ell));
+  }
+  
   void CovLinearard::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -41,5 +75,10 @@ namespace libgp
   {
     return "CovLinearard";
   }
+
+  CovarianceFunction * CovLinearard::clone()
+  {
+    return new CovLinearard(*this);
+  }
 }
 
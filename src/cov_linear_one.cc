@@ -31,6 +31,36 @@ namespace libgp
     grad << -2*it2*(1+x1.dot(x2));
   }
   
+  void CovLinearone::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                    Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    k = it2*(1+x1.dot(x2));
+    grad(0) = -2*k;
+  }
+  
+  bool CovLinearone::feature_form(int &features, int &noise)
+  {
+    features = input_dim + 1;
+    noise = -1;
+    return true;
+  }
+
+  void CovLinearone::features(const Eigen::VectorXd &x, Eigen::Ref<Eigen::VectorXd> phi)
+  {
+    phi(0) = 1;
+    phi.tail(input_dim) = x;
+  }
+
+  void CovLinearone::feature_params(Eigen::Ref<Eigen::VectorXi> param)
+  {
+    param.setZero();
+  }
+
+  void CovLinearone::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    hess(0,0) = 4*it2*(1+x1.dot(x2));
+  }
+  
   void CovLinearone::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -41,5 +71,10 @@ namespace libgp
   {
     return "CovLinearone";
   }
+
+  CovarianceFunction * CovLinearone::clone()
+  {
+    return new CovLinearone(*this);
+  }
   
 }
@@ -3,6 +3,7 @@
 // All rights reserved.
 
 #include "cov_matern3_iso.h"
+#include "simd_math.h"
 #include <cmath>
 
 namespace libgp
@@ -35,6 +36,61 @@ namespace libgp
     grad << k*z*z, 2*k*(1+z);
   }
   
+  void CovMatern3iso::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                     Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    double z = (x1-x2).norm()*sqrt3/ell;
+    double e = sf2*exp(-z);
+    k = e*(1+z);
+    grad(0) = e*z*z;
+    grad(1) = 2*k;
+  }
+  
+  void CovMatern3iso::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                              Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+  {
+    Eigen::VectorXd & e = ws.acquire(k.size());
+    squared_distances(x, X, k);
+    k = k.cwiseSqrt()*(sqrt3/ell);
+    e = -k;
+    simd::exp(e.data(), e.data(), e.size());
+    k = (sf2*e.array()*(1+k.array())).matrix();
+    ws.release();
+  }
+  
+  bool CovMatern3iso::get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, [[maybe_unused]] bool self,
+                                               Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+  {
+    Eigen::VectorXd & e = ws.acquire(k.size());
+    k = d2.cwiseSqrt()*(sqrt3/ell);
+    e = -k;
+    simd::exp(e.data(), e.data(), e.size());
+    k = (sf2*e.array()*(1+k.array())).matrix();
+    ws.release();
+    return true;
+  }
+  
+  bool CovMatern3iso::supports_distances()
+  {
+    return true;
+  }
+  
+  bool CovMatern3iso::scale_noise_form(int &scale, int &noise)
+  {
+    scale = 1;
+    noise = -1;
+    return true;
+  }
+  
+  void CovMatern3iso::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    double z = (x1-x2).norm()*sqrt3/ell;
+    double e = sf2*exp(-z);
+    hess(0,0) = e*z*z*(z-2);
+    hess(0,1) = hess(1,0) = 2*e*z*z;
+    hess(1,1) = 4*e*(1+z);
+  }
+  
   void CovMatern3iso::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -46,5 +102,10 @@ namespace libgp
   {
     return "CovMatern3iso";
   }
+
+  CovarianceFunction * CovMatern3iso::clone()
+  {
+    return new CovMatern3iso(*this);
+  }
   
 }
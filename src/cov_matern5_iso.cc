@@ -3,6 +3,7 @@
 // All rights reserved.
 
 #include "cov_matern5_iso.h"
+#include "simd_math.h"
 #include <cmath>
 
 namespace libgp
@@ -36,6 +37,63 @@ namespace libgp
     grad << k*(z_square + z_square*z)/3, 2*k*(1+z+z_square/3);
   }
   
+  void CovMatern5iso::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                     Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    double z = (x1-x2).norm()*sqrt5/ell;
+    double e = sf2*exp(-z);
+    double z_square = z*z;
+    k = e*(1+z+z_square/3);
+    grad(0) = e*(z_square + z_square*z)/3;
+    grad(1) = 2*k;
+  }
+  
+  void CovMatern5iso::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                              Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+  {
+    Eigen::VectorXd & e = ws.acquire(k.size());
+    squared_distances(x, X, k);
+    k = k.cwiseSqrt()*(sqrt5/ell);
+    e = -k;
+    simd::exp(e.data(), e.data(), e.size());
+    k = (sf2*e.array()*(1+k.array()+k.array().square()/3)).matrix();
+    ws.release();
+  }
+  
+  bool CovMatern5iso::get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, [[maybe_unused]] bool self,
+                                               Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+  {
+    Eigen::VectorXd & e = ws.acquire(k.size());
+    k = d2.cwiseSqrt()*(sqrt5/ell);
+    e = -k;
+    simd::exp(e.data(), e.data(), e.size());
+    k = (sf2*e.array()*(1+k.array()+k.array().square()/3)).matrix();
+    ws.release();
+    return true;
+  }
+  
+  bool CovMatern5iso::supports_distances()
+  {
+    return true;
+  }
+  
+  bool CovMatern5iso::scale_noise_form(int &scale, int &noise)
+  {
+    scale = 1;
+    noise = -1;
+    return true;
+  }
+  
+  void CovMatern5iso::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    double z = (x1-x2).norm()*sqrt5/ell;
+    double e = sf2*exp(-z);
+    double z_square = z*z;
+    hess(0,0) = e*z_square*(z_square - 2*z - 2)/3;
+    hess(0,1) = hess(1,0) = 2*e*(z_square + z_square*z)/3;
+    hess(1,1) = 4*e*(1+z+z_square/3);
+  }
+  
   void CovMatern5iso::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -47,5 +105,10 @@ namespace libgp
   {
     return "CovMatern5iso";
   }
+
+  CovarianceFunction * CovMatern5iso::clone()
+  {
+    return new CovMatern5iso(*this);
+  }
   
 }
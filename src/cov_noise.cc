@@ -33,6 +33,56 @@ namespace libgp
     else grad(0) = 0.0;
   }
   
+  void CovNoise::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    k = (&x1 == &x2) ? s2 : 0.0;
+    grad(0) = 2*k;
+  }
+  
+  void CovNoise::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                         Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] Workspace &ws)
+  {
+    for (int i = 0; i < k.size(); ++i) k(i) = (X[i] == &x) ? s2 : 0.0;
+  }
+  
+  bool CovNoise::get_row_from_distances([[maybe_unused]] const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                          Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] Workspace &ws)
+  {
+    k.setZero();
+    if (self && k.size() > 0) k(0) = s2;
+    return true;
+  }
+  
+  bool CovNoise::supports_distances()
+  {
+    return true;
+  }
+  
+  bool CovNoise::scale_noise_form(int &scale, int &noise)
+  {
+    scale = -1;
+    noise = 0;
+    return true;
+  }
+  
+  bool CovNoise::feature_form(int &features, int &noise)
+  {
+    features = 0;
+    noise = 0;
+    return true;
+  }
+
+  void CovNoise::features([[maybe_unused]] const Eigen::VectorXd &x,
+                          [[maybe_unused]] Eigen::Ref<Eigen::VectorXd> phi) {}
+
+  void CovNoise::feature_params([[maybe_unused]] Eigen::Ref<Eigen::VectorXi> param) {}
+
+  void CovNoise::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    hess(0,0) = (&x1 == &x2) ? 4*s2 : 0.0;
+  }
+  
   void CovNoise::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -43,6 +93,11 @@ namespace libgp
   {
     return "CovNoise";
   }
+
+  CovarianceFunction * CovNoise::clone()
+  {
+    return new CovNoise(*this);
+  }
   
   double CovNoise::get_threshold()
   {
@@ -3,6 +3,7 @@
 // All rights reserved.
 
 #include "cov_periodic.h"
+#include "simd_math.h"
 #include <cmath>
 
 namespace libgp
@@ -34,6 +35,34 @@ namespace libgp
     grad << 4*sf2*exp(-2*s*s)*s*s, 2*sf2*exp(-2*s*s), 0;// 4*sf2/ell*exp(-2*s*s)*s*cos(k)*k;
   }
   
+  void CovPeriodic::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                   Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    double s = sin(M_PI * (x1-x2).norm() / T) / ell;
+    k = sf2*exp(-2*s*s);
+    grad(0) = 4*k*s*s;
+    grad(1) = 2*k;
+    grad(2) = 0;
+  }
+  
+  void CovPeriodic::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                            Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] Workspace &ws)
+  {
+    squared_distances(x, X, k);
+    k = k.cwiseSqrt()*(M_PI/T);
+    simd::sin(k.data(), k.data(), k.size());
+    k = k.array().square().matrix()*(-2/(ell*ell));
+    simd::exp(k.data(), k.data(), k.size());
+    k *= sf2;
+  }
+  
+  bool CovPeriodic::scale_noise_form(int &scale, int &noise)
+  {
+    scale = 1;
+    noise = -1;
+    return true;
+  }
+  
   void CovPeriodic::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -46,5 +75,10 @@ namespace libgp
   {
     return "CovPeriodic";
   }
+
+  CovarianceFunction * CovPeriodic::clone()
+  {
+    return new CovPeriodic(*this);
+  }
   
 }
@@ -3,6 +3,7 @@
 // All rights reserved.
 
 #include "cov_periodic_matern3_iso.h"
+#include "simd_math.h"
 #include <cmath>
 
 namespace libgp
@@ -35,6 +36,39 @@ namespace libgp
     grad << sf2*s*s*exp(-s), 2*sf2*(1+s)*exp(-s), sf2*exp(-s)*s*sqrt3*k*cos(k)/ell/T;
   }
   
+  void CovPeriodicMatern3iso::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                             Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    double r = M_PI * (x1-x2).norm() / T;
+    double s = sqrt3*fabs((sin(r) / ell));
+    double e = sf2*exp(-s);
+    k = e*(1+s);
+    grad(0) = e*s*s;
+    grad(1) = 2*k;
+    grad(2) = e*s*sqrt3*r*cos(r)/ell/T;
+  }
+  
+  void CovPeriodicMatern3iso::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                                      Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+  {
+    Eigen::VectorXd & e = ws.acquire(k.size());
+    squared_distances(x, X, k);
+    k = k.cwiseSqrt()*(M_PI/T);
+    simd::sin(k.data(), k.data(), k.size());
+    k = k.cwiseAbs()*(sqrt3/ell);
+    e = -k;
+    simd::exp(e.data(), e.data(), e.size());
+    k = (sf2*(1+k.array())*e.array()).matrix();
+    ws.release();
+  }
+  
+  bool CovPeriodicMatern3iso::scale_noise_form(int &scale, int &noise)
+  {
+    scale = 1;
+    noise = -1;
+    return true;
+  }
+  
   void CovPeriodicMatern3iso::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -47,5 +81,10 @@ namespace libgp
   {
     return "CovPeriodicMatern3iso";
   }
+
+  CovarianceFunction * CovPeriodicMatern3iso::clone()
+  {
+    return new CovPeriodicMatern3iso(*this);
+  }
   
 }
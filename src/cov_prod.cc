@@ -46,6 +46,58 @@ namespace libgp
     grad.tail(param_dim_second) = grad_second * first->get(x1, x2);
   }
   
+  void CovProd::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                               Eigen::Ref<Eigen::VectorXd> grad, Workspace &ws)
+  {
+    double k_first, k_second;
+    first->value_and_grad(x1, x2, k_first, grad.head(param_dim_first), ws);
+    second->value_and_grad(x1, x2, k_second, grad.tail(param_dim_second), ws);
+    grad.head(param_dim_first) *= k_second;
+    grad.tail(param_dim_second) *= k_first;
+    k = k_first * k_second;
+  }
+  
+  void CovProd::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                        Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+  {
+    Eigen::VectorXd & k_second = ws.acquire(k.size());
+    first->get_row(x, X, k, ws);
+    second->get_row(x, X, k_second, ws);
+    k = k.cwiseProduct(k_second);
+    ws.release();
+  }
+  
+  void CovProd::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    Eigen::VectorXd grad_first(param_dim_first);
+    Eigen::VectorXd grad_second(param_dim_second);
+    first->grad(x1, x2, grad_first);
+    second->grad(x1, x2, grad_second);
+    double k_first = first->get(x1, x2), k_second = second->get(x1, x2);
+    first->hessian(x1, x2, hess.topLeftCorner(param_dim_first, param_dim_first));
+    second->hessian(x1, x2, hess.bottomRightCorner(param_dim_second, param_dim_second));
+    hess.topLeftCorner(param_dim_first, param_dim_first) *= k_second;
+    hess.bottomRightCorner(param_dim_second, param_dim_second) *= k_first;
+    hess.topRightCorner(param_dim_first, param_dim_second) = grad_first * grad_second.transpose();
+    hess.bottomLeftCorner(param_dim_second, param_dim_first) = grad_second * grad_first.transpose();
+  }
+  
+  bool CovProd::get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                         Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+  {
+    Eigen::VectorXd & k_second = ws.acquire(k.size());
+    bool supported = second->get_row_from_distances(d2, self, k_second, ws)
+                     && first->get_row_from_distances(d2, self, k, ws);
+    if (supported) k = k.cwiseProduct(k_second);
+    ws.release();
+    return supported;
+  }
+  
+  bool CovProd::supports_distances()
+  {
+    return first->supports_distances() && second->supports_distances();
+  }
+  
   void CovProd::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -57,4 +109,14 @@ namespace libgp
   {
     return "CovProd("+first->to_string()+", "+second->to_string()+")";
   }
+
+  CovarianceFunction * CovProd::clone()
+  {
+    // the parameters of the copied children are already set
+    CovProd * copy = new CovProd();
+    copy->init(input_dim, first->clone(), second->clone());
+    copy->loghyper = loghyper;
+    copy->loghyper_changed = loghyper_changed;
+    return copy;
+  }
 }
@@ -3,6 +3,7 @@
 // All rights reserved.
 
 #include "cov_rq_iso.h"
+#include "simd_math.h"
 #include <cmath>
 
 namespace libgp
@@ -35,6 +36,68 @@ namespace libgp
     grad << sf2*z*pow(k, -alpha-1), 2*sf2_k, sf2_k*(0.5*z/k-alpha*log(k));
   }
   
+  void CovRQiso::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    double z = (x1-x2).squaredNorm()/(ell*ell);
+    double b = 1+0.5*z/alpha;
+    double log_b = log(b);
+    k = sf2*exp(-alpha*log_b);
+    grad(0) = k*z/b;
+    grad(1) = 2*k;
+    grad(2) = k*(0.5*z/b-alpha*log_b);
+  }
+  
+  void CovRQiso::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                         Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] Workspace &ws)
+  {
+    squared_distances(x, X, k);
+    k = (1+k.array()*(0.5/(alpha*ell*ell))).matrix();
+    simd::log(k.data(), k.data(), k.size());
+    k *= -alpha;
+    simd::exp(k.data(), k.data(), k.size());
+    k *= sf2;
+  }
+  
+  bool CovRQiso::get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, [[maybe_unused]] bool self,
+                                          Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] Workspace &ws)
+  {
+    k = (1+d2.array()*(0.5/(alpha*ell*ell))).matrix();
+    simd::log(k.data(), k.data(), k.size());
+    k *= -alpha;
+    simd::exp(k.data(), k.data(), k.size());
+    k *= sf2;
+    return true;
+  }
+  
+  bool CovRQiso::supports_distances()
+  {
+    return true;
+  }
+  
+  bool CovRQiso::scale_noise_form(int &scale, int &noise)
+  {
+    scale = 1;
+    noise = -1;
+    return true;
+  }
+  
+  void CovRQiso::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    double z = (x1-x2).squaredNorm()/(ell*ell);
+    double u = 0.5*z/alpha;
+    double b = 1+u;
+    double k = sf2*pow(b, -alpha);
+    double g0 = k*z/b;
+    double g2 = k*(0.5*z/b - alpha*log(b));
+    hess(0,0) = g0*g0/k - 2*k*z/(b*b);
+    hess(0,1) = hess(1,0) = 2*g0;
+    hess(0,2) = hess(2,0) = g0*g2/k + k*z*u/(b*b);
+    hess(1,1) = 4*k;
+    hess(1,2) = hess(2,1) = 2*g2;
+    hess(2,2) = g2*g2/k + k*alpha*(u*u/(b*b) + u/b - log(b));
+  }
+  
   void CovRQiso::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -47,5 +110,10 @@ namespace libgp
   {
     return "CovRQiso";
   }
+
+  CovarianceFunction * CovRQiso::clone()
+  {
+    return new CovRQiso(*this);
+  }
   
 }
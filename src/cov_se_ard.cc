@@ -3,6 +3,7 @@
 // All rights reserved.
 
 #include "cov_se_ard.h"
+#include "simd_math.h"
 #include <cmath>
 
 namespace libgp
@@ -35,6 +36,47 @@ namespace libgp
     grad(input_dim) = 2.0 * k;
   }
   
+  void CovSEard::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    double z = 0;
+    for (size_t i = 0; i < input_dim; ++i) {
+      double d = (x1(i)-x2(i))/ell(i);
+      grad(i) = d*d;
+      z += grad(i);
+    }
+    k = sf2*exp(-0.5*z);
+    grad.head(input_dim) *= k;
+    grad(input_dim) = 2*k;
+  }
+  
+  void CovSEard::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                         Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] Workspace &ws)
+  {
+    for (int i = 0; i < k.size(); ++i) k(i) = (x - *X[i]).cwiseQuotient(ell).squaredNorm();
+    k *= -0.5;
+    simd::exp(k.data(), k.data(), k.size());
+    k *= sf2;
+  }
+  
+  bool CovSEard::scale_noise_form(int &scale, int &noise)
+  {
+    scale = input_dim;
+    noise = -1;
+    return true;
+  }
+  
+  void CovSEard::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    Eigen::VectorXd z = (x1-x2).cwiseQuotient(ell).array().square();
+    double k = sf2*exp(-0.5*z.sum());
+    hess.topLeftCorner(input_dim, input_dim) = k * z * z.transpose();
+    hess.topLeftCorner(input_dim, input_dim).diagonal() -= 2 * k * z;
+    hess.col(input_dim).head(input_dim) = 2 * k * z;
+    hess.row(input_dim).head(input_dim) = 2 * k * z.transpose();
+    hess(input_dim, input_dim) = 4 * k;
+  }
+  
   void CovSEard::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -46,5 +88,10 @@ namespace libgp
   {
     return "CovSEard";
   }
+
+  CovarianceFunction * CovSEard::clone()
+  {
+    return new CovSEard(*this);
+  }
 }
 
@@ -3,6 +3,7 @@
 // All rights reserved.
 
 #include "cov_se_iso.h"
+#include "simd_math.h"
 #include <cmath>
 
 namespace libgp
@@ -34,6 +35,54 @@ namespace libgp
     grad << k*z, 2*k;
   }
   
+  void CovSEiso::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                Eigen::Ref<Eigen::VectorXd> grad, [[maybe_unused]] Workspace &ws)
+  {
+    double z = (x1-x2).squaredNorm()/(ell*ell);
+    k = sf2*exp(-0.5*z);
+    grad(0) = k*z;
+    grad(1) = 2*k;
+  }
+  
+  void CovSEiso::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                         Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] Workspace &ws)
+  {
+    squared_distances(x, X, k);
+    k *= -0.5/(ell*ell);
+    simd::exp(k.data(), k.data(), k.size());
+    k *= sf2;
+  }
+  
+  bool CovSEiso::get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, [[maybe_unused]] bool self,
+                                          Eigen::Ref<Eigen::VectorXd> k, [[maybe_unused]] Workspace &ws)
+  {
+    k = d2*(-0.5/(ell*ell));
+    simd::exp(k.data(), k.data(), k.size());
+    k *= sf2;
+    return true;
+  }
+  
+  bool CovSEiso::supports_distances()
+  {
+    return true;
+  }
+  
+  bool CovSEiso::scale_noise_form(int &scale, int &noise)
+  {
+    scale = 1;
+    noise = -1;
+    return true;
+  }
+  
+  void CovSEiso::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    double z = (x1-x2).squaredNorm()/(ell*ell);
+    double k = sf2*exp(-0.5*z);
+    hess(0,0) = k*z*(z-2);
+    hess(0,1) = hess(1,0) = 2*k*z;
+    hess(1,1) = 4*k;
+  }
+  
   void CovSEiso::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -45,5 +94,10 @@ namespace libgp
   {
     return "CovSEiso";
   }
+
+  CovarianceFunction * CovSEiso::clone()
+  {
+    return new CovSEiso(*this);
+  }
   
 }
@@ -46,6 +46,95 @@ namespace libgp
     grad.tail(param_dim_second) = grad_second;
   }
   
+  void CovSum::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                              Eigen::Ref<Eigen::VectorXd> grad, Workspace &ws)
+  {
+    double k_first, k_second;
+    first->value_and_grad(x1, x2, k_first, grad.head(param_dim_first), ws);
+    second->value_and_grad(x1, x2, k_second, grad.tail(param_dim_second), ws);
+    k = k_first + k_second;
+  }
+  
+  void CovSum::get_row(const Eigen::VectorXd &x, const Eigen::VectorXd * const X[],
+                       Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+  {
+    Eigen::VectorXd & k_second = ws.acquire(k.size());
+    first->get_row(x, X, k, ws);
+    second->get_row(x, X, k_second, ws);
+    k += k_second;
+    ws.release();
+  }
+  
+  bool CovSum::get_row_from_distances(const Eigen::Ref<const Eigen::VectorXd> &d2, bool self,
+                                        Eigen::Ref<Eigen::VectorXd> k, Workspace &ws)
+  {
+    Eigen::VectorXd & k_second = ws.acquire(k.size());
+    bool supported = second->get_row_from_distances(d2, self, k_second, ws)
+                     && first->get_row_from_distances(d2, self, k, ws);
+    if (supported) k += k_second;
+    ws.release();
+    return supported;
+  }
+  
+  bool CovSum::supports_distances()
+  {
+    return first->supports_distances() && second->supports_distances();
+  }
+  
+  bool CovSum::scale_noise_form(int &scale, int &noise)
+  {
+    int scale_first, noise_first, scale_second, noise_second;
+    scale = noise = -1;
+    if (!first->scale_noise_form(scale_first, noise_first)
+        || !second->scale_noise_form(scale_second, noise_second)) return false;
+    // at most one signal and one noise term
+    if ((scale_first >= 0 && scale_second >= 0) || (noise_first >= 0 && noise_second >= 0)) return false;
+    if (scale_first >= 0) scale = scale_first;
+    if (scale_second >= 0) scale = param_dim_first + scale_second;
+    if (noise_first >= 0) noise = noise_first;
+    if (noise_second >= 0) noise = param_dim_first + noise_second;
+    return true;
+  }
+  
+  bool CovSum::feature_form(int &features, int &noise)
+  {
+    int features_first, noise_first, features_second, noise_second;
+    features = 0;
+    noise = -1;
+    if (!first->feature_form(features_first, noise_first)
+        || !second->feature_form(features_second, noise_second)) return false;
+    // at most one noise term
+    if (noise_first >= 0 && noise_second >= 0) return false;
+    features = features_first + features_second;
+    if (noise_first >= 0) noise = noise_first;
+    if (noise_second >= 0) noise = param_dim_first + noise_second;
+    return true;
+  }
+
+  void CovSum::features(const Eigen::VectorXd &x, Eigen::Ref<Eigen::VectorXd> phi)
+  {
+    int features_first, noise_first;
+    first->feature_form(features_first, noise_first);
+    first->features(x, phi.head(features_first));
+    second->features(x, phi.tail(phi.size() - features_first));
+  }
+
+  void CovSum::feature_params(Eigen::Ref<Eigen::VectorXi> param)
+  {
+    int features_first, noise_first;
+    first->feature_form(features_first, noise_first);
+    first->feature_params(param.head(features_first));
+    second->feature_params(param.tail(param.size() - features_first));
+    param.tail(param.size() - features_first).array() += param_dim_first;
+  }
+
+  void CovSum::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    hess.setZero();
+    first->hessian(x1, x2, hess.topLeftCorner(param_dim_first, param_dim_first));
+    second->hessian(x1, x2, hess.bottomRightCorner(param_dim_second, param_dim_second));
+  }
+  
   void CovSum::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -57,4 +146,14 @@ namespace libgp
   {
     return "CovSum("+first->to_string()+", "+second->to_string()+")";
   }
+
+  CovarianceFunction * CovSum::clone()
+  {
+    // the parameters of the copied children are already set
+    CovSum * copy = new CovSum();
+    copy->init(input_dim, first->clone(), second->clone());
+    copy->loghyper = loghyper;
+    copy->loghyper_changed = loghyper_changed;
+    return copy;
+  }
 }
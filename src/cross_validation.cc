@@ -0,0 +1,120 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "cross_validation.h"
+#include "work_stealing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace libgp {
+
+  CrossValidation::CrossValidation (GaussianProcess & gp)
+  {
+    size_t n = gp.get_sampleset_size();
+    if (n == 0) return;
+    gp.compute();
+    K_inv = gp.kernel_inverse();
+    const std::vector<double> & targets = gp.sampleset->y();
+    y = Eigen::Map<const Eigen::VectorXd>(targets.data(), n);
+    alpha = K_inv * y;
+  }
+
+  CrossValidation::~CrossValidation () {}
+
+  std::vector<FoldResult> CrossValidation::evaluate(const std::vector<Fold> & folds, size_t threads)
+  {
+    for (size_t f = 0; f < folds.size(); ++f) {
+      if (folds[f].test.empty()) throw std::runtime_error("Fold without test samples");
+      for (size_t i : folds[f].test) {
+        if (i >= static_cast<size_t>(y.size())) throw std::runtime_error("Sample index out of range");
+      }
+      for (size_t i : folds[f].excluded) {
+        if (i >= static_cast<size_t>(y.size())) throw std::runtime_error("Sample index out of range");
+      }
+      // a repeated sample makes the held-out block of K^-1 singular
+      std::vector<size_t> H(folds[f].test);
+      H.insert(H.end(), folds[f].excluded.begin(), folds[f].excluded.end());
+      std::sort(H.begin(), H.end());
+      if (std::adjacent_find(H.begin(), H.end()) != H.end()) {
+        throw std::runtime_error("Sample held out twice in a fold");
+      }
+    }
+    std::vector<FoldResult> results(folds.size());
+    // largest held-out blocks first, their sizes may differ
+    std::vector<size_t> order(folds.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return folds[a].test.size() + folds[a].excluded.size() > folds[b].test.size() + folds[b].excluded.size();
+    });
+    parallel_for(folds.size(), threads, [&](size_t k, size_t) {
+      results[order[k]] = evaluate(folds[order[k]]);
+    });
+    return results;
+  }
+
+  FoldResult CrossValidation::evaluate(const Fold & fold)
+  {
+    // held-out block, test samples first
+    std::vector<size_t> H(fold.test);
+    H.insert(H.end(), fold.excluded.begin(), fold.excluded.end());
+    int h = H.size(), m = fold.test.size();
+    Eigen::MatrixXd B(h, h);
+    Eigen::VectorXd a(h), y_H(h);
+    for (int i = 0; i < h; ++i) {
+      for (int j = 0; j < h; ++j) B(i, j) = K_inv(H[i], H[j]);
+      a(i) = alpha(H[i]);
+      y_H(i) = y(H[i]);
+    }
+    // Sigma_H = B^-1 and mu_H = y_H - B^-1 alpha_H
+    Eigen::LLT<Eigen::MatrixXd> llt(B);
+    FoldResult result;
+    result.valid = llt.info() == Eigen::Success && B.allFinite();
+    if (!result.valid) {
+      double nan = std::numeric_limits<double>::quiet_NaN();
+      result.mean = Eigen::VectorXd::Constant(m, nan);
+      result.var = Eigen::VectorXd::Constant(m, nan);
+      result.rmse = result.nlpd = nan;
+      return result;
+    }
+    Eigen::MatrixXd Sigma = llt.solve(Eigen::MatrixXd::Identity(h, h));
+    Eigen::VectorXd mu = y_H - llt.solve(a);
+    result.mean = mu.head(m);
+    result.var = Sigma.diagonal().head(m);
+    Eigen::ArrayXd r2 = (y_H.head(m) - result.mean).array().square();
+    result.rmse = sqrt(r2.mean());
+    result.nlpd = (0.5 * (2 * M_PI * result.var.array()).log() + 0.5 * r2 / result.var.array()).mean();
+    return result;
+  }
+
+  std::vector<Fold> CrossValidation::kfold(size_t n, size_t k, size_t gap)
+  {
+    if (k == 0 || k > n) throw std::runtime_error("Invalid number of folds");
+    std::vector<Fold> folds(k);
+    for (size_t f = 0; f < k; ++f) {
+      size_t begin = f * n / k, end = (f + 1) * n / k;
+      for (size_t i = begin; i < end; ++i) folds[f].test.push_back(i);
+      for (size_t i = begin > gap ? begin - gap : 0; i < begin; ++i) folds[f].excluded.push_back(i);
+      for (size_t i = end; i < std::min(n, end + gap); ++i) folds[f].excluded.push_back(i);
+    }
+    return folds;
+  }
+
+  std::vector<Fold> CrossValidation::from_assignment(const std::vector<int> & assignment)
+  {
+    std::vector<Fold> folds;
+    for (size_t i = 0; i < assignment.size(); ++i) {
+      if (assignment[i] < 0) continue;
+      if (static_cast<size_t>(assignment[i]) >= folds.size()) folds.resize(assignment[i] + 1);
+      folds[assignment[i]].test.push_back(i);
+    }
+    // fold ids need not be contiguous
+    folds.erase(std::remove_if(folds.begin(), folds.end(), [](const Fold & fold) { return fold.test.empty(); }),
+                folds.end());
+    return folds;
+  }
+}
@@ -0,0 +1,164 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "data_reader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace libgp {
+
+  DataReader::DataReader (const char * filename, size_t buffer_size)
+  {
+    file = std::fopen(filename, "rb");
+    buffer.resize(buffer_size + 1);
+    buffer[0] = '\0';
+    pos = end = 0;
+    eof = (file == NULL);
+    target_column = 0;
+    line_number = 0;
+  }
+
+  DataReader::~DataReader ()
+  {
+    if (file != NULL) std::fclose(file);
+  }
+
+  bool DataReader::is_open()
+  {
+    return file != NULL;
+  }
+
+  void DataReader::set_target_column(int column)
+  {
+    target_column = column;
+  }
+
+  bool DataReader::fill()
+  {
+    while (!eof && std::memchr(&buffer[pos], '\n', end - pos) == NULL) {
+      // move incomplete line to the front and grow the buffer if it is full
+      std::memmove(&buffer[0], &buffer[pos], end - pos);
+      end -= pos;
+      pos = 0;
+      if (end + 1 == buffer.size()) buffer.resize(2 * buffer.size());
+      size_t count = std::fread(&buffer[end], 1, buffer.size() - end - 1, file);
+      if (count == 0) eof = true;
+      end += count;
+      buffer[end] = '\0';
+    }
+    return pos < end;
+  }
+
+  bool DataReader::read_line(std::string & line)
+  {
+    const char * first;
+    const char * last;
+    if (!next_line(first, last)) return false;
+    line.assign(first, last);
+    return true;
+  }
+
+  bool DataReader::next_line(const char *& first, const char *& last)
+  {
+    while (fill()) {
+      const char * begin = &buffer[pos];
+      const char * newline = static_cast<const char *>(std::memchr(begin, '\n', end - pos));
+      const char * stop = newline != NULL ? newline : &buffer[end];
+      pos = stop - &buffer[0] + (newline != NULL);
+      line_number++;
+      // strip leading whitespace and trailing carriage returns
+      while (begin < stop && (*begin == ' ' || *begin == '\t')) begin++;
+      while (stop > begin && (stop[-1] == '\r' || stop[-1] == ' ' || stop[-1] == '\t')) stop--;
+      // ignore empty lines and comments
+      if (begin == stop || *begin == '#') continue;
+      first = begin;
+      last = stop;
+      return true;
+    }
+    return false;
+  }
+
+  const char * DataReader::parse(const char * first, const char * last, double & value)
+  {
+    if (first < last && *first == '+') first++;
+#if defined(__cpp_lib_to_chars)
+    std::from_chars_result result = std::from_chars(first, last, value);
+    if (result.ec != std::errc()) return first;
+    return result.ptr;
+#else
+    // numbers are always followed by a separator, newline or the
+    // terminating zero of the buffer, hence strtod stays within the line
+    char * stop;
+    value = std::strtod(first, &stop);
+    return stop > last ? last : stop;
+#endif
+  }
+
+  size_t DataReader::read(size_t input_dim, Eigen::MatrixXd & x, Eigen::VectorXd & y, size_t max_rows)
+  {
+    size_t cols = input_dim + 1;
+    size_t target = target_column < 0 ? cols + target_column : target_column;
+    if (target >= cols) {
+      throw std::runtime_error("Target column out of range");
+    }
+    size_t rows = 0;
+    size_t capacity = std::min<size_t>(max_rows, 1024);
+    x.resize(capacity, input_dim);
+    y.resize(capacity);
+    const char * first;
+    const char * last;
+    while (rows < max_rows && next_line(first, last)) {
+      row.clear();
+      while (first < last) {
+        double value;
+        const char * next = parse(first, last, value);
+        if (next == first) {
+          std::ostringstream msg;
+          msg << "Invalid number in line " << line_number;
+          throw std::runtime_error(msg.str());
+        }
+        row.push_back(value);
+        // skip separators
+        first = next;
+        while (first < last && (*first == ' ' || *first == '\t' || *first == ',')) first++;
+      }
+      if (row.size() != cols) {
+        std::ostringstream msg;
+        msg << "Expected " << cols << " columns in line " << line_number
+            << " but found " << row.size();
+        throw std::runtime_error(msg.str());
+      }
+      if (rows == capacity) {
+        capacity = std::min(2 * capacity, max_rows);
+        x.conservativeResize(capacity, Eigen::NoChange);
+        y.conservativeResize(capacity);
+      }
+      y(rows) = row[target];
+      for (size_t j = 0, k = 0; j < cols; ++j) {
+        if (j != target) x(rows, k++) = row[j];
+      }
+      rows++;
+    }
+    x.conservativeResize(rows, Eigen::NoChange);
+    y.conservativeResize(rows);
+    return rows;
+  }
+
+  size_t DataReader::import(GaussianProcess & gp, size_t block_size)
+  {
+    Eigen::MatrixXd x;
+    Eigen::VectorXd y;
+    size_t total = 0, rows;
+    while ((rows = read(gp.get_input_dim(), x, y, block_size)) > 0) {
+      gp.add_patterns(x, y);
+      total += rows;
+    }
+    return total;
+  }
+}
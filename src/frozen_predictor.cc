@@ -0,0 +1,200 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "frozen_predictor.h"
+#include "cov_factory.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace libgp {
+
+  static const char frozen_magic[8] = {'L', 'I', 'B', 'G', 'P', 'F', 'P', '1'};
+
+  template <typename T> static void write_value(std::ofstream & out, T value)
+  {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <typename T> static T read_value(std::ifstream & in)
+  {
+    T value;
+    in.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return value;
+  }
+
+  FrozenPredictor::FrozenPredictor (GaussianProcess & gp, bool with_variance)
+  {
+    input_dim = gp.get_input_dim();
+    CovFactory factory;
+    cf = factory.create(input_dim, gp.covf().to_string());
+    cf->set_loghyper(gp.covf().get_loghyper());
+    variance = with_variance;
+    size_t n = gp.get_sampleset_size();
+    X.resize(input_dim, n);
+    for (size_t i = 0; i < n; ++i) X.col(i) = gp.sampleset->x(i);
+    if (n == 0) return;
+    gp.cholesky();
+    gp.update_alpha();
+    alpha = gp.alpha;
+    if (with_variance) {
+      L_inv = Eigen::MatrixXd::Identity(n, n);
+      gp.L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(L_inv);
+    }
+  }
+
+  FrozenPredictor::FrozenPredictor (const char * filename)
+  {
+    cf = NULL;
+    std::ifstream infile(filename, std::ios::binary);
+    char magic[sizeof(frozen_magic)];
+    infile.read(magic, sizeof(magic));
+    if (!infile || std::memcmp(magic, frozen_magic, sizeof(magic)) != 0) {
+      throw std::runtime_error(std::string("Not a frozen predictor: ") + filename);
+    }
+    input_dim = read_value<uint64_t>(infile);
+    uint64_t n = read_value<uint64_t>(infile);
+    variance = read_value<uint8_t>(infile) != 0;
+    std::string covf_def(read_value<uint64_t>(infile), ' ');
+    infile.read(&covf_def[0], covf_def.size());
+    if (!infile) throw std::runtime_error(std::string("Truncated file: ") + filename);
+    CovFactory factory;
+    cf = factory.create(input_dim, covf_def);
+    Eigen::VectorXd params(cf->get_param_dim());
+    infile.read(reinterpret_cast<char *>(params.data()), params.size() * sizeof(double));
+    cf->set_loghyper(params);
+    X.resize(input_dim, n);
+    infile.read(reinterpret_cast<char *>(X.data()), X.size() * sizeof(double));
+    alpha.resize(n);
+    infile.read(reinterpret_cast<char *>(alpha.data()), n * sizeof(double));
+    if (variance) {
+      // only the lower triangle is stored, column by column
+      L_inv.setZero(n, n);
+      for (uint64_t j = 0; j < n; ++j) {
+        infile.read(reinterpret_cast<char *>(&L_inv(j, j)), (n - j) * sizeof(double));
+      }
+    }
+    if (!infile) {
+      delete cf;
+      throw std::runtime_error(std::string("Truncated file: ") + filename);
+    }
+  }
+
+  FrozenPredictor::~FrozenPredictor ()
+  {
+    if (cf != NULL) delete cf;
+  }
+
+  void FrozenPredictor::write(const char * filename) const
+  {
+    std::ofstream outfile(filename, std::ios::binary);
+    uint64_t n = X.cols();
+    std::string covf_def = cf->to_string();
+    Eigen::VectorXd params = cf->get_loghyper();
+    outfile.write(frozen_magic, sizeof(frozen_magic));
+    write_value<uint64_t>(outfile, input_dim);
+    write_value<uint64_t>(outfile, n);
+    write_value<uint8_t>(outfile, has_variance());
+    write_value<uint64_t>(outfile, covf_def.size());
+    outfile.write(covf_def.data(), covf_def.size());
+    outfile.write(reinterpret_cast<const char *>(params.data()), params.size() * sizeof(double));
+    outfile.write(reinterpret_cast<const char *>(X.data()), X.size() * sizeof(double));
+    outfile.write(reinterpret_cast<const char *>(alpha.data()), alpha.size() * sizeof(double));
+    if (has_variance()) {
+      for (uint64_t j = 0; j < n; ++j) {
+        outfile.write(reinterpret_cast<const char *>(&L_inv(j, j)), (n - j) * sizeof(double));
+      }
+    }
+    if (!outfile) throw std::runtime_error(std::string("Could not write ") + filename);
+  }
+
+  FrozenPredictor::Workspace FrozenPredictor::workspace() const
+  {
+    Workspace ws;
+    ws.x_star.resize(input_dim);
+    ws.x_train.resize(input_dim);
+    ws.k_star.resize(X.cols());
+    ws.v.resize(L_inv.rows());
+    return ws;
+  }
+
+  void FrozenPredictor::update_k_star(Workspace & ws) const
+  {
+    for (int i = 0; i < X.cols(); ++i) {
+      ws.x_train = X.col(i);
+      ws.k_star(i) = cf->get(ws.x_star, ws.x_train);
+    }
+  }
+
+  double FrozenPredictor::latent_var(Workspace & ws) const
+  {
+    ws.v.noalias() = L_inv.triangularView<Eigen::Lower>() * ws.k_star;
+    // as in GaussianProcess::var() the prior variance is evaluated on two
+    // distinct vectors, hence without the contribution of CovNoise
+    ws.x_train = ws.x_star;
+    return cf->get(ws.x_star, ws.x_train) - ws.v.squaredNorm();
+  }
+
+  void FrozenPredictor::predict(const Eigen::MatrixXd & x, Eigen::Ref<Eigen::VectorXd> mean,
+                                Eigen::Ref<Eigen::VectorXd> var, Workspace & ws) const
+  {
+    if (x.cols() != static_cast<int>(input_dim)) {
+      throw std::runtime_error("Input dimension mismatch");
+    }
+    bool compute_variance = var.size() > 0;
+    if (compute_variance && !has_variance()) {
+      throw std::runtime_error("Predictor was frozen without variance");
+    }
+    for (int i = 0; i < x.rows(); ++i) {
+      if (X.cols() == 0) {
+        mean(i) = 0;
+        if (compute_variance) var(i) = 0;
+        continue;
+      }
+      ws.x_star = x.row(i).transpose();
+      update_k_star(ws);
+      mean(i) = ws.k_star.dot(alpha);
+      if (compute_variance) {
+        var(i) = latent_var(ws);
+      }
+    }
+  }
+
+  double FrozenPredictor::f(const double x[], Workspace & ws) const
+  {
+    if (X.cols() == 0) return 0;
+    ws.x_star = Eigen::Map<const Eigen::VectorXd>(x, input_dim);
+    update_k_star(ws);
+    return ws.k_star.dot(alpha);
+  }
+
+  double FrozenPredictor::var(const double x[], Workspace & ws) const
+  {
+    if (!has_variance()) {
+      throw std::runtime_error("Predictor was frozen without variance");
+    }
+    if (X.cols() == 0) return 0;
+    ws.x_star = Eigen::Map<const Eigen::VectorXd>(x, input_dim);
+    update_k_star(ws);
+    return latent_var(ws);
+  }
+
+  bool FrozenPredictor::has_variance() const
+  {
+    return variance;
+  }
+
+  size_t FrozenPredictor::size() const
+  {
+    return X.cols();
+  }
+
+  size_t FrozenPredictor::get_input_dim() const
+  {
+    return input_dim;
+  }
+}
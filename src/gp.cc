@@ -4,6 +4,8 @@
 
 #include "gp.h"
 #include "cov_factory.h"
+#include "data_reader.h"
+#include "work_stealing.h"
 
 #include <iostream>
 #include <fstream>
@@ -11,6 +13,11 @@
 #include <cmath>
 #include <iomanip>
 #include <ctime>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
 
 namespace libgp {
   
@@ -21,6 +28,11 @@ namespace libgp {
   {
       sampleset = NULL;
       cf = NULL;
+      alpha_needs_update = false;
+      stats_need_update = true;
+      use_spectral = false;
+      scale_noise_cache = false;
+      factorized_n = 0;
   }
 
   GaussianProcess::GaussianProcess (size_t input_dim, std::string covf_def)
@@ -33,54 +45,52 @@ namespace libgp {
     cf->loghyper_changed = 0;
     sampleset = new SampleSet(input_dim);
     L.resize(initial_L_size, initial_L_size);
+    alpha_needs_update = false;
+    stats_need_update = true;
+    use_spectral = false;
+    scale_noise_cache = false;
+    factorized_n = 0;
   }
   
   GaussianProcess::GaussianProcess (const char * filename) 
   {
     sampleset = NULL;
     cf = NULL;
+    alpha_needs_update = false;
+    stats_need_update = true;
+    use_spectral = false;
+    scale_noise_cache = false;
+    factorized_n = 0;
     int stage = 0;
-    std::ifstream infile;
-    double y;
-    infile.open(filename);
+    DataReader reader(filename);
     std::string s;
-    double * x = NULL;
     L.resize(initial_L_size, initial_L_size);
-    while (infile.good()) {
-      getline(infile, s);
-      // ignore empty lines and comments
-      if (s.length() != 0 && s.at(0) != '#') {
-        std::stringstream ss(s);
-        if (stage > 2) {
-          ss >> y;
-          for(size_t j = 0; j < input_dim; ++j) {
-            ss >> x[j];
-          }
-          add_pattern(x, y);
-        } else if (stage == 0) {
-          ss >> input_dim;
-          sampleset = new SampleSet(input_dim);
-          x = new double[input_dim];
-        } else if (stage == 1) {
-          CovFactory factory;
-          cf = factory.create(input_dim, s);
-          cf->loghyper_changed = 0;
-        } else if (stage == 2) {
-          Eigen::VectorXd params(cf->get_param_dim());
-          for (size_t j = 0; j<cf->get_param_dim(); ++j) {
-            ss >> params[j];
-          }
-          cf->set_loghyper(params);
+    while (stage < 3 && reader.read_line(s)) {
+      std::stringstream ss(s);
+      if (stage == 0) {
+        ss >> input_dim;
+        sampleset = new SampleSet(input_dim);
+      } else if (stage == 1) {
+        CovFactory factory;
+        cf = factory.create(input_dim, s);
+        cf->loghyper_changed = 0;
+      } else if (stage == 2) {
+        Eigen::VectorXd params(cf->get_param_dim());
+        for (size_t j = 0; j<cf->get_param_dim(); ++j) {
+          ss >> params[j];
         }
-        stage++;
+        cf->set_loghyper(params);
       }
+      stage++;
     }
-    infile.close();
     if (stage < 3) {
       std::cerr << "fatal error while reading " << filename << std::endl;
       exit(EXIT_FAILURE);
     }
-    delete [] x;
+    // read all patterns at once and factorize the kernel matrix only once
+    Eigen::MatrixXd x;
+    Eigen::VectorXd y;
+    if (reader.read(input_dim, x, y) > 0) add_patterns(x, y);
   }
   
   GaussianProcess::GaussianProcess(const GaussianProcess& gp)
@@ -91,14 +101,37 @@ namespace libgp {
     k_star = gp.k_star;
     alpha_needs_update = gp.alpha_needs_update;
     L = gp.L;
+    L_inv_y = gp.L_inv_y;
+    log_det_K = gp.log_det_K;
+    y_K_inv_y = gp.y_K_inv_y;
+    stats_need_update = gp.stats_need_update;
+    use_spectral = false;
+    scale_noise_cache = gp.scale_noise_cache;
+    factorized_n = 0;
     
     // copy covariance function
-    CovFactory factory;
-    cf = factory.create(gp.input_dim, gp.cf->to_string());
-    cf->loghyper_changed = gp.cf->loghyper_changed;
-    cf->set_loghyper(gp.cf->get_loghyper());
+    cf = gp.cf->clone();
+    // L is not valid if the original used the eigendecomposition
+    cf->loghyper_changed = gp.cf->loghyper_changed || gp.use_spectral;
   }
   
+  GaussianProcess * GaussianProcess::fork()
+  {
+    GaussianProcess * gp = new GaussianProcess();
+    fork_to(gp);
+    return gp;
+  }
+
+  void GaussianProcess::fork_to(GaussianProcess * gp)
+  {
+    gp->input_dim = input_dim;
+    gp->sampleset = new SampleSet(*sampleset);
+    gp->cf = cf->clone();
+    gp->scale_noise_cache = scale_noise_cache;
+    // factorize on first use
+    gp->cf->loghyper_changed = true;
+  }
+
   GaussianProcess::~GaussianProcess ()
   {
     // free memory
@@ -123,6 +156,7 @@ namespace libgp {
     compute();
     update_alpha();
     update_k_star(x_star);
+    if (use_spectral) return cf->get(x_star, x_star) - spectral.quad_form(k_star);
     int n = sampleset->size();
     Eigen::VectorXd v = L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solve(k_star);
     return cf->get(x_star, x_star) - v.dot(v);	
@@ -146,7 +180,9 @@ namespace libgp {
       double x_star = k_star.dot(alpha);
       result(i, 0) = x_star;
       
-      if (compute_variance) {
+      if (compute_variance && use_spectral) {
+        result(i, 1) = cf->get(x.row(i), x.row(i)) - spectral.quad_form(k_star);
+      } else if (compute_variance) {
         int n = sampleset->size();
         Eigen::VectorXd v = L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solve(k_star);
         double variance = cf->get(x.row(i), x.row(i)) - v.dot(v);
@@ -156,32 +192,117 @@ namespace libgp {
     return result;
   }
 
+  void GaussianProcess::prepare()
+  {
+    size_t n = sampleset->size();
+    if (n > 0) {
+      cholesky();
+      update_alpha();
+    }
+    k_star.resize(n);
+    rt_x.resize(input_dim);
+    rt_x2.resize(input_dim);
+    rt_v.resize(n);
+  }
+
+  bool GaussianProcess::predict_rt(const double x[], double & mean, double * var)
+  {
+    int n = sampleset->size();
+    if (cf->loghyper_changed || use_spectral || (n > 0 && alpha_needs_update) || rt_v.size() != n
+        || rt_x.size() != static_cast<int>(input_dim)) {
+      return false;
+    }
+    mean = 0;
+    if (var != NULL) *var = 0;
+    if (n == 0) return true;
+    rt_x = Eigen::Map<const Eigen::VectorXd>(x, input_dim);
+    for (int i = 0; i < n; ++i) {
+      k_star(i) = cf->get(rt_x, sampleset->x(i));
+    }
+    mean = k_star.dot(alpha);
+    if (var != NULL) {
+      rt_v = k_star;
+      L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(rt_v);
+      // distinct vectors as in var(), i.e. without the noise term
+      rt_x2 = rt_x;
+      *var = cf->get(rt_x, rt_x2) - rt_v.squaredNorm();
+    }
+    return true;
+  }
+
   void GaussianProcess::compute()
   {
     // can previously computed values be used?
     if (!cf->loghyper_changed) return;
     cf->loghyper_changed = false;
     int n = sampleset->size();
-    // resize L if necessary
-    if (n > L.rows()) L.resize(n + initial_L_size, n + initial_L_size);
-    // compute kernel matrix (lower triangle)
-    for(size_t i = 0; i < sampleset->size(); ++i) {
-      for(size_t j = 0; j <= i; ++j) {
-        L(i, j) = cf->get(sampleset->x(i), sampleset->x(j));
+    // hyperparameters set back to those of L, e.g. by an optimizer
+    if (n > 0 && n == factorized_n && cf->get_loghyper() == factorized_loghyper) {
+      if (use_spectral) {
+        use_spectral = false;
+        alpha_needs_update = true;
+      }
+      return;
+    }
+    // only signal and/or noise level changed: reuse the eigendecomposition
+    if (n > 0 && n == factorized_n && ScaleNoiseCache::applicable(*cf, factorized_loghyper)) {
+      if (spectral.valid(*cf, n)) spectral.set_scale_noise(*cf);
+      else if (scale_noise_cache) spectral.decompose(*cf, *sampleset, cov_ws);
+      // without noise term K may be singular where the cholesky factor is not
+      if (spectral.valid(*cf, n) && spectral.positive_definite()) {
+        use_spectral = true;
+        alpha_needs_update = true;
+        return;
       }
     }
+    factorize();
+  }
+
+  void GaussianProcess::set_scale_noise_cache(bool enable)
+  {
+    scale_noise_cache = enable;
+  }
+
+  void GaussianProcess::factorize()
+  {
+    int n = sampleset->size();
+    // resize L if necessary
+    if (n > L.rows()) L.resize(n + initial_L_size, n + initial_L_size);
+    fill_kernel(n);
     // perform cholesky factorization
     //solver.compute(K.selfadjointView<Eigen::Lower>());
     L.topLeftCorner(n, n) = L.topLeftCorner(n, n).selfadjointView<Eigen::Lower>().llt().matrixL();
     alpha_needs_update = true;
+    stats_need_update = true;
+    mark_factorized();
+  }
+
+  void GaussianProcess::fill_kernel(int n)
+  {
+    // compute kernel matrix (lower triangle) column by column
+    const Eigen::VectorXd * const * X = sampleset->x().data();
+    for(int i = 0; i < n; ++i) {
+      cf->get_row(*X[i], X + i, L.col(i).segment(i, n - i), cov_ws);
+    }
+  }
+
+  void GaussianProcess::cholesky()
+  {
+    compute();
+    if (use_spectral) factorize();
+  }
+
+  void GaussianProcess::mark_factorized()
+  {
+    use_spectral = false;
+    factorized_loghyper = cf->get_loghyper();
+    factorized_n = sampleset->size();
   }
   
   void GaussianProcess::update_k_star(const Eigen::VectorXd &x_star)
   {
     k_star.resize(sampleset->size());
-    for(size_t i = 0; i < sampleset->size(); ++i) {
-      k_star(i) = cf->get(x_star, sampleset->x(i));
-    }
+    if (k_star.size() > 0) cf->get_row(x_star, sampleset->x().data(), k_star, cov_ws);
   }
 
   void GaussianProcess::update_alpha()
@@ -194,10 +315,29 @@ namespace libgp {
     const std::vector<double>& targets = sampleset->y();
     Eigen::Map<const Eigen::VectorXd> y(&targets[0], sampleset->size());
     int n = sampleset->size();
-    alpha = L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solve(y);
+    if (use_spectral) {
+      spectral.solve(y, alpha);
+      return;
+    }
+    // L^-1 y is maintained incrementally, only the backward solve remains
+    update_stats();
+    alpha = L_inv_y;
     L.topLeftCorner(n, n).triangularView<Eigen::Lower>().adjoint().solveInPlace(alpha);
   }
 
+  void GaussianProcess::update_stats()
+  {
+    // can previously computed values be used?
+    if (!stats_need_update) return;
+    stats_need_update = false;
+    const std::vector<double>& targets = sampleset->y();
+    int n = sampleset->size();
+    Eigen::Map<const Eigen::VectorXd> y(targets.data(), n);
+    L_inv_y = L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solve(y);
+    log_det_K = 2 * L.diagonal().head(n).array().log().sum();
+    y_K_inv_y = L_inv_y.squaredNorm();
+  }
+
   void GaussianProcess::add_patterns(const Eigen::MatrixXd& x, const Eigen::VectorXd& y) 
   {
     if (x.rows() != y.size()) {
@@ -207,27 +347,73 @@ namespace libgp {
       throw std::runtime_error("Input dimension mismatch");
     }
     
-    // Add all patterns to sample set first
-    for (int i = 0; i < x.rows(); ++i) {
-      sampleset->add(x.row(i).data(), y(i));
+    size_t n = sampleset->size();
+    size_t m = x.rows();
+    if (m == 0) return;
+    spectral.clear();
+    sampleset->reserve(n + m);
+    for (size_t i = 0; i < m; ++i) {
+      sampleset->add(x.row(i).transpose(), y(i));
+    }
+    alpha_needs_update = true;
+    // factorize from scratch if there is no valid factorization
+    if (n == 0 || cf->loghyper_changed) {
+      cf->loghyper_changed = true;
+      compute();
+      return;
+    }
+    if (use_spectral) {
+      factorize();
+      return;
+    }
+    // otherwise extend the cholesky factor by a block of m rows
+    if (n + m > static_cast<std::size_t>(L.rows())) {
+      L.conservativeResize(n + m + initial_L_size, n + m + initial_L_size);
+    }
+    const Eigen::VectorXd * const * X = sampleset->x().data();
+    for (size_t j = 0; j < n + m; ++j) {
+      size_t i = std::max(j, n);
+      cf->get_row(*X[j], X + i, L.col(j).segment(i, n + m - i), cov_ws);
+    }
+    // L21 = K21 L11^-T and L22 = chol(K22 - L21 L21^T)
+    Eigen::Block<Eigen::MatrixXd> L21 = L.block(n, 0, m, n);
+    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().transpose().solveInPlace<Eigen::OnTheRight>(L21);
+    L.block(n, n, m, m).selfadjointView<Eigen::Lower>().rankUpdate(L21, -1);
+    L.block(n, n, m, m) = L.block(n, n, m, m).selfadjointView<Eigen::Lower>().llt().matrixL();
+    mark_factorized();
+    // extend L^-1 y by L22^-1 (y2 - L21 L11^-1 y1)
+    if (!stats_need_update) {
+      L_inv_y.conservativeResize(n + m);
+      L_inv_y.tail(m) = y - L21 * L_inv_y.head(n);
+      L.block(n, n, m, m).triangularView<Eigen::Lower>().solveInPlace(L_inv_y.tail(m));
+      log_det_K += 2 * L.diagonal().segment(n, m).array().log().sum();
+      y_K_inv_y += L_inv_y.tail(m).squaredNorm();
     }
-    cf->loghyper_changed = true;
-    compute();
-
-    return; 
   }
 
   void GaussianProcess::add_pattern(const double x[], double y)
   {
     int n = sampleset->size();
     sampleset->add(x, y);
+    spectral.clear();
     // create kernel matrix if sampleset is empty
     if (n == 0) {
+      // forks start without a buffer
+      if (L.rows() == 0) L.resize(initial_L_size, initial_L_size);
       L(0,0) = sqrt(cf->get(sampleset->x(0), sampleset->x(0)));
       cf->loghyper_changed = false;
+      mark_factorized();
+      L_inv_y.resize(1);
+      L_inv_y(0) = y / L(0,0);
+      log_det_K = 2 * log(L(0,0));
+      y_K_inv_y = L_inv_y(0) * L_inv_y(0);
+      stats_need_update = false;
     // recompute kernel matrix if necessary
     } else if (cf->loghyper_changed) {
       compute();
+    // cholesky factor is not available
+    } else if (use_spectral) {
+      factorize();
     // update kernel matrix 
     } else {
       Eigen::VectorXd k(n);
@@ -242,14 +428,35 @@ namespace libgp {
       L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(k);
       L.block(n,0,1,n) = k.transpose();
       L(n,n) = sqrt(kappa - k.dot(k));
+      mark_factorized();
+      // append to L^-1 y in O(n)
+      if (!stats_need_update) {
+        L_inv_y.conservativeResize(n + 1);
+        L_inv_y(n) = (y - k.dot(L_inv_y.head(n))) / L(n,n);
+        log_det_K += 2 * log(L(n,n));
+        y_K_inv_y += L_inv_y(n) * L_inv_y(n);
+      }
     }
     alpha_needs_update = true;
   }
 
   bool GaussianProcess::set_y(size_t i, double y) 
   {
+    if (i >= sampleset->size()) return false;
+    double delta = y - sampleset->y(i);
     if(sampleset->set_y(i,y)) {
       alpha_needs_update = true;
+      int n = sampleset->size();
+      // only entries i..n-1 of L^-1 y change, by L^-1 delta e_i
+      if (!stats_need_update && !cf->loghyper_changed && !use_spectral && factorized_n == n) {
+        Eigen::VectorXd d = Eigen::VectorXd::Zero(n - i);
+        d(0) = delta;
+        L.block(i, i, n - i, n - i).triangularView<Eigen::Lower>().solveInPlace(d);
+        L_inv_y.tail(n - i) += d;
+        y_K_inv_y = L_inv_y.squaredNorm();
+      } else {
+        stats_need_update = true;
+      }
       return 1;
     }
     return false;
@@ -263,6 +470,10 @@ namespace libgp {
   void GaussianProcess::clear_sampleset()
   {
     sampleset->clear();
+    spectral.clear();
+    stats_need_update = true;
+    use_spectral = false;
+    factorized_n = 0;
   }
   
   Eigen::MatrixXd GaussianProcess::get_sampleset()
@@ -318,32 +529,210 @@ namespace libgp {
   double GaussianProcess::log_likelihood()
   {
     compute();
-    update_alpha();
     int n = sampleset->size();
-    const std::vector<double>& targets = sampleset->y();
-    Eigen::Map<const Eigen::VectorXd> y(&targets[0], sampleset->size());
-    double det = 2 * L.diagonal().head(n).array().log().sum();
-    return -0.5*y.dot(alpha) - 0.5*det - 0.5*n*log2pi;
+    if (use_spectral) {
+      update_alpha();
+      const std::vector<double>& targets = sampleset->y();
+      Eigen::Map<const Eigen::VectorXd> y(&targets[0], sampleset->size());
+      return -0.5*y.dot(alpha) - 0.5*spectral.log_det() - 0.5*n*log2pi;
+    }
+    // y^T K^-1 y and log |K| are maintained incrementally
+    update_stats();
+    return -0.5*y_K_inv_y - 0.5*log_det_K - 0.5*n*log2pi;
   }
 
   Eigen::VectorXd GaussianProcess::log_likelihood_gradient() 
   {
     compute();
     update_alpha();
+    int scale, noise;
+    if (use_spectral && cf->scale_noise_form(scale, noise)) {
+      size_t p = cf->get_param_dim();
+      Eigen::VectorXd grad = Eigen::VectorXd::Zero(p);
+      // K^-1 is only needed for the parameters of K_0
+      if (p > static_cast<size_t>((scale >= 0) + (noise >= 0))) {
+        grad = trace_gradient(alpha * alpha.transpose() - kernel_inverse());
+      }
+      double scale_grad, noise_grad;
+      scale_noise_gradient(scale_grad, noise_grad);
+      if (scale >= 0) grad(scale) = scale_grad;
+      if (noise >= 0) grad(noise) = noise_grad;
+      return grad;
+    }
+    Eigen::MatrixXd W = alpha * alpha.transpose() - kernel_inverse();
+    return trace_gradient(W);
+  }
+
+  bool GaussianProcess::scale_noise_gradient(double & scale_grad, double & noise_grad)
+  {
+    int scale, noise;
+    if (!cf->scale_noise_form(scale, noise)) return false;
+    compute();
+    if (use_spectral) {
+      Eigen::Map<const Eigen::VectorXd> y(sampleset->y().data(), sampleset->size());
+      spectral.gradient(y, scale_grad, noise_grad);
+      return true;
+    }
+    Eigen::VectorXd grad = log_likelihood_gradient();
+    scale_grad = scale >= 0 ? grad(scale) : 0;
+    noise_grad = noise >= 0 ? grad(noise) : 0;
+    return true;
+  }
+
+  Eigen::MatrixXd GaussianProcess::log_likelihood_hessian()
+  {
+    Eigen::VectorXd grad;
+    Eigen::MatrixXd hess;
+    log_likelihood_hessian(grad, hess);
+    return hess;
+  }
+
+  double GaussianProcess::log_likelihood_hessian(Eigen::VectorXd & grad, Eigen::MatrixXd & hess)
+  {
     size_t n = sampleset->size();
-    Eigen::VectorXd grad = Eigen::VectorXd::Zero(cf->get_param_dim());
-    Eigen::VectorXd g(grad.size());
-    Eigen::MatrixXd W = Eigen::MatrixXd::Identity(n, n);
+    size_t p = cf->get_param_dim();
+    double value = log_likelihood();
+    update_alpha();
+    Eigen::MatrixXd K_inv = kernel_inverse();
+    Eigen::MatrixXd W = alpha * alpha.transpose() - K_inv;
+    // kernel matrix derivatives dK_j and the term tr(W d2K_ij) / 2
+    std::vector<Eigen::MatrixXd> dK(p, Eigen::MatrixXd(n, n));
+    grad = Eigen::VectorXd::Zero(p);
+    hess = Eigen::MatrixXd::Zero(p, p);
+    Eigen::VectorXd g(p);
+    Eigen::MatrixXd h(p, p);
+    CovarianceFunction::Workspace ws;
+    double k;
+    for(size_t i = 0; i < n; ++i) {
+      for(size_t j = 0; j <= i; ++j) {
+        cf->value_and_grad(sampleset->x(i), sampleset->x(j), k, g, ws);
+        cf->hessian(sampleset->x(i), sampleset->x(j), h);
+        double w = (i == j) ? 0.5*W(i,j) : W(i,j);
+        grad += w * g;
+        hess += w * h;
+        for (size_t a = 0; a < p; ++a) dK[a](i,j) = dK[a](j,i) = g(a);
+      }
+    }
+    // d/dtheta_j of the gradient terms alpha^T dK_i alpha / 2 and -tr(K^-1 dK_i) / 2
+    std::vector<Eigen::MatrixXd> K_inv_dK(p);
+    Eigen::MatrixXd dK_alpha(n, p);
+    for (size_t a = 0; a < p; ++a) {
+      K_inv_dK[a] = K_inv * dK[a];
+      dK_alpha.col(a) = dK[a] * alpha;
+    }
+    Eigen::MatrixXd quad = dK_alpha.transpose() * K_inv * dK_alpha;
+    for (size_t a = 0; a < p; ++a) {
+      for (size_t b = 0; b <= a; ++b) {
+        double tr = (K_inv_dK[a].array() * K_inv_dK[b].transpose().array()).sum();
+        hess(a,b) += 0.5*tr - quad(a,b);
+        hess(b,a) = hess(a,b);
+      }
+    }
+    return value;
+  }
 
-    // compute kernel matrix inverse
-    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(W);
-    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().transpose().solveInPlace(W);
+  double GaussianProcess::numerical_hessian(Eigen::VectorXd & grad, Eigen::MatrixXd & hess)
+  {
+    const double h = 1e-5;
+    Eigen::VectorXd params0 = cf->get_loghyper(), params = params0;
+    size_t p = params.size();
+    hess.resize(p, p);
+    for (size_t i = 0; i < p; ++i) {
+      params(i) = params0(i) + h;
+      cf->set_loghyper(params);
+      Eigen::VectorXd g_plus = log_likelihood_gradient();
+      params(i) = params0(i) - h;
+      cf->set_loghyper(params);
+      Eigen::VectorXd g_minus = log_likelihood_gradient();
+      params(i) = params0(i);
+      hess.col(i) = (g_plus - g_minus) / (2*h);
+    }
+    cf->set_loghyper(params0);
+    hess = (0.5 * (hess + hess.transpose())).eval();
+    grad = log_likelihood_gradient();
+    return log_likelihood();
+  }
 
-    W = alpha * alpha.transpose() - W;
+  Eigen::VectorXd GaussianProcess::log_likelihood_batch(const Eigen::MatrixXd & theta, Eigen::MatrixXd * grad,
+                                                        size_t threads)
+  {
+    size_t p = cf->get_param_dim();
+    if (theta.cols() != static_cast<int>(p)) {
+      throw std::runtime_error("Parameter dimension mismatch");
+    }
+    size_t count = theta.rows();
+    int n = sampleset->size();
+    Eigen::VectorXd values(count);
+    if (grad != NULL) grad->resize(count, p);
+    const Eigen::VectorXd * const * X = sampleset->x().data();
+    Eigen::Map<const Eigen::VectorXd> y(sampleset->y().data(), n);
+    // one copy of the covariance function and kernel matrix per thread
+    size_t workers = parallel_threads(count, threads);
+    std::vector<std::unique_ptr<CovarianceFunction> > covf(workers);
+    std::vector<CovarianceFunction::Workspace> ws(workers);
+    std::vector<Eigen::MatrixXd> K(workers);
+    for (size_t t = 0; t < workers; ++t) covf[t].reset(cf->clone());
+    // squared distances of the lower triangle, shared by all candidates
+    bool distances = cf->supports_distances();
+    Eigen::MatrixXd D;
+    if (distances) {
+      D.resize(n, n);
+      for (int j = 0; j < n; ++j) {
+        for (int i = j; i < n; ++i) D(i, j) = (*X[i] - *X[j]).squaredNorm();
+      }
+    }
+    parallel_for(count, workers, [&](size_t c, size_t t) {
+      CovarianceFunction & f = *covf[t];
+      f.set_loghyper(theta.row(c).transpose());
+      K[t].resize(n, n);
+      for (int j = 0; j < n; ++j) {
+        if (distances) f.get_row_from_distances(D.col(j).segment(j, n - j), true, K[t].col(j).segment(j, n - j), ws[t]);
+        else f.get_row(*X[j], X + j, K[t].col(j).segment(j, n - j), ws[t]);
+      }
+      Eigen::LLT<Eigen::Ref<Eigen::MatrixXd> > llt(K[t]);
+      if (llt.info() != Eigen::Success) {
+        values(c) = -std::numeric_limits<double>::infinity();
+        if (grad != NULL) grad->row(c).setConstant(std::numeric_limits<double>::quiet_NaN());
+        return;
+      }
+      Eigen::VectorXd a = llt.solve(y);
+      values(c) = -0.5*y.dot(a) - K[t].diagonal().array().log().sum() - 0.5*n*log2pi;
+      if (grad != NULL) {
+        Eigen::MatrixXd W = llt.solve(Eigen::MatrixXd::Identity(n, n));
+        W = a * a.transpose() - W;
+        grad->row(c) = trace_gradient(W, f, ws[t]).transpose();
+      }
+    });
+    return values;
+  }
+
+  Eigen::MatrixXd GaussianProcess::kernel_inverse()
+  {
+    if (use_spectral) return spectral.inverse();
+    int n = sampleset->size();
+    Eigen::MatrixXd K_inv = Eigen::MatrixXd::Identity(n, n);
+    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(K_inv);
+    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().transpose().solveInPlace(K_inv);
+    return K_inv;
+  }
+
+  Eigen::VectorXd GaussianProcess::trace_gradient(const Eigen::MatrixXd & W)
+  {
+    CovarianceFunction::Workspace ws;
+    return trace_gradient(W, *cf, ws);
+  }
+
+  Eigen::VectorXd GaussianProcess::trace_gradient(const Eigen::MatrixXd & W, CovarianceFunction & covf,
+                                                  CovarianceFunction::Workspace & ws)
+  {
+    size_t n = sampleset->size();
+    Eigen::VectorXd grad = Eigen::VectorXd::Zero(covf.get_param_dim());
+    Eigen::VectorXd g(grad.size());
+    double k;
 
     for(size_t i = 0; i < n; ++i) {
       for(size_t j = 0; j <= i; ++j) {
-        cf->grad(sampleset->x(i), sampleset->x(j), g);
+        covf.value_and_grad(sampleset->x(i), sampleset->x(j), k, g, ws);
         if (i==j) grad += W(i,j) * g * 0.5;
         else      grad += W(i,j) * g;
       }
@@ -351,4 +740,58 @@ namespace libgp {
 
     return grad;
   }
+
+  Eigen::MatrixXd GaussianProcess::loo_predict()
+  {
+    int n = sampleset->size();
+    Eigen::MatrixXd result(n, 2);
+    if (n == 0) return result;
+    compute();
+    Eigen::MatrixXd K_inv = kernel_inverse();
+    Eigen::Map<const Eigen::VectorXd> y(sampleset->y().data(), n);
+    // mu_i = y_i - alpha_i / [K^-1]_ii and sigma_i^2 = 1 / [K^-1]_ii
+    result.col(1) = K_inv.diagonal().cwiseInverse();
+    result.col(0) = y - (K_inv * y).cwiseProduct(result.col(1));
+    return result;
+  }
+
+  double GaussianProcess::loo_log_predictive()
+  {
+    int n = sampleset->size();
+    Eigen::MatrixXd loo = loo_predict();
+    Eigen::Map<const Eigen::VectorXd> y(sampleset->y().data(), n);
+    return -0.5 * loo.col(1).array().log().sum()
+           - 0.5 * ((y - loo.col(0)).array().square() / loo.col(1).array()).sum()
+           - 0.5 * n * log2pi;
+  }
+
+  Eigen::VectorXd GaussianProcess::loo_log_predictive_gradient()
+  {
+    Eigen::VectorXd grad;
+    loo_log_predictive(grad);
+    return grad;
+  }
+
+  double GaussianProcess::loo_log_predictive(Eigen::VectorXd & grad)
+  {
+    int n = sampleset->size();
+    if (n == 0) {
+      grad = Eigen::VectorXd::Zero(cf->get_param_dim());
+      return 0;
+    }
+    compute();
+    Eigen::MatrixXd K_inv = kernel_inverse();
+    Eigen::Map<const Eigen::VectorXd> y(sampleset->y().data(), n);
+    Eigen::VectorXd a = K_inv * y;
+    Eigen::VectorXd d = K_inv.diagonal();
+    // Rasmussen & Williams (5.13) rewritten as sum_ab W_ab dK_ab / 2
+    Eigen::VectorXd v = K_inv * a.cwiseQuotient(d);
+    Eigen::VectorXd c = (1 + a.array().square() / d.array()) / d.array();
+    Eigen::MatrixXd W = v * a.transpose();
+    W = W + W.transpose() - K_inv * c.asDiagonal() * K_inv;
+    grad = trace_gradient(W);
+    // sigma_i^2 = 1 / d_i and y_i - mu_i = a_i / d_i
+    return 0.5 * d.array().log().sum() - 0.5 * (a.array().square() / d.array()).sum()
+           - 0.5 * n * log2pi;
+  }
 }
@@ -0,0 +1,379 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp_batch.h"
+#include "cov_factory.h"
+#include "work_stealing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace libgp {
+
+  const double log2pi = log(2*M_PI);
+
+  GPBatch::GPBatch (size_t input_dim, std::string covf_def)
+  {
+    this->input_dim = input_dim;
+    prepare_scratch(1);
+    scratch[0].cf = CovFactory().create(input_dim, covf_def);
+    this->covf_def = scratch[0].cf->to_string();
+    param_dim = scratch[0].cf->get_param_dim();
+  }
+
+  GPBatch::~GPBatch ()
+  {
+    for (size_t t = 0; t < scratch.size(); ++t) delete scratch[t].cf;
+  }
+
+  size_t GPBatch::add_model()
+  {
+    Model m;
+    m.bucket = 0;
+    m.slot = allocate(0);
+    m.n = 0;
+    m.factorized = true;
+    models.push_back(m);
+    loghyper.resize(loghyper.size() + param_dim, 0.0);
+    return models.size() - 1;
+  }
+
+  size_t GPBatch::get_model_count()
+  {
+    return models.size();
+  }
+
+  size_t GPBatch::get_input_dim()
+  {
+    return input_dim;
+  }
+
+  size_t GPBatch::get_param_dim()
+  {
+    return param_dim;
+  }
+
+  size_t GPBatch::get_sampleset_size(size_t id)
+  {
+    check_id(id);
+    return models[id].n;
+  }
+
+  void GPBatch::add_pattern(size_t id, const double x[], double y)
+  {
+    check_id(id);
+    Model & m = models[id];
+    int n = m.n;
+    reserve(id, n + 1);
+    std::copy(x, x + input_dim, inputs(m) + n * input_dim);
+    targets(m)[n] = y;
+    m.n = n + 1;
+    if (!m.factorized) return;
+    // append a row to the cholesky factor as in GaussianProcess::add_pattern
+    Scratch & s = scratch[0];
+    load(m, id, s);
+    s.k.resize(n + 1);
+    s.cf->get_row(s.x[n], s.X.data(), s.k, s.ws);
+    MatrixMap L = cholesky(m);
+    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(s.k.head(n));
+    L.row(n).head(n) = s.k.head(n).transpose();
+    L(n, n) = sqrt(s.k(n) - s.k.head(n).squaredNorm());
+    update_alpha(m);
+  }
+
+  void GPBatch::add_patterns(size_t id, const Eigen::MatrixXd & x, const Eigen::VectorXd & y)
+  {
+    check_id(id);
+    if (x.rows() != y.size()) {
+      throw std::runtime_error("Number of input patterns must match number of target values");
+    }
+    if (x.cols() != static_cast<int>(input_dim)) {
+      throw std::runtime_error("Input dimension mismatch");
+    }
+    Model & m = models[id];
+    reserve(id, m.n + x.rows());
+    Eigen::Map<Eigen::MatrixXd>(inputs(m), input_dim, m.n + x.rows()).rightCols(x.rows()) = x.transpose();
+    Eigen::Map<Eigen::VectorXd>(targets(m), m.n + x.rows()).tail(x.rows()) = y;
+    m.n += x.rows();
+    m.factorized = false;
+  }
+
+  void GPBatch::clear_sampleset(size_t id)
+  {
+    check_id(id);
+    Model & m = models[id];
+    arenas[m.bucket].free.push_back(m.slot);
+    m.bucket = 0;
+    m.slot = allocate(0);
+    m.n = 0;
+    m.factorized = true;
+  }
+
+  Eigen::VectorXd GPBatch::get_loghyper(size_t id)
+  {
+    check_id(id);
+    return Eigen::Map<const Eigen::VectorXd>(&loghyper[id * param_dim], param_dim);
+  }
+
+  void GPBatch::set_loghyper(size_t id, const Eigen::VectorXd & p)
+  {
+    check_id(id);
+    if (p.size() != static_cast<int>(param_dim)) {
+      throw std::runtime_error("Parameter dimension mismatch");
+    }
+    Eigen::Map<Eigen::VectorXd>(&loghyper[id * param_dim], param_dim) = p;
+    models[id].factorized = false;
+  }
+
+  void GPBatch::set_loghyper(const Eigen::MatrixXd & p)
+  {
+    if (p.rows() != static_cast<int>(param_dim) || p.cols() != static_cast<int>(models.size())) {
+      throw std::runtime_error("Parameter dimension mismatch");
+    }
+    Eigen::Map<Eigen::MatrixXd>(loghyper.data(), param_dim, models.size()) = p;
+    for (size_t i = 0; i < models.size(); ++i) models[i].factorized = false;
+  }
+
+  void GPBatch::compute(size_t threads)
+  {
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < models.size(); ++i) {
+      if (!models[i].factorized) ids.push_back(i);
+    }
+    ids = by_size(ids);
+    prepare_scratch(parallel_threads(ids.size(), threads));
+    parallel_for(ids.size(), threads, [&](size_t i, size_t t) {
+      factorize(ids[i], scratch[t]);
+    });
+  }
+
+  Eigen::MatrixXd GPBatch::predict(const std::vector<size_t> & id, const Eigen::MatrixXd & x,
+                                   bool compute_variance, size_t threads)
+  {
+    if (id.size() != static_cast<size_t>(x.rows())) {
+      throw std::runtime_error("Number of model ids must match number of inputs");
+    }
+    if (x.cols() != static_cast<int>(input_dim)) {
+      throw std::runtime_error("Input dimension mismatch");
+    }
+    for (size_t q = 0; q < id.size(); ++q) check_id(id[q]);
+    compute(threads);
+    // group the queries by model, one task per model
+    std::vector<size_t> queries(id.size());
+    for (size_t q = 0; q < queries.size(); ++q) queries[q] = q;
+    std::stable_sort(queries.begin(), queries.end(),
+                     [&](size_t a, size_t b) { return id[a] < id[b]; });
+    std::vector<size_t> begin;
+    for (size_t q = 0; q < queries.size(); ++q) {
+      if (q == 0 || id[queries[q]] != id[queries[q - 1]]) begin.push_back(q);
+    }
+    std::vector<size_t> tasks(begin.size());
+    for (size_t i = 0; i < tasks.size(); ++i) tasks[i] = i;
+    begin.push_back(queries.size());
+    // most expensive models first
+    auto cost = [&](size_t i) {
+      double n = models[id[queries[begin[i]]]].n;
+      return (n + 1) * (n + 1) * (begin[i + 1] - begin[i]);
+    };
+    std::stable_sort(tasks.begin(), tasks.end(),
+                     [&](size_t a, size_t b) { return cost(a) > cost(b); });
+    Eigen::MatrixXd result(x.rows(), compute_variance ? 2 : 1);
+    prepare_scratch(parallel_threads(tasks.size(), threads));
+    parallel_for(tasks.size(), threads, [&](size_t i, size_t t) {
+      Scratch & s = scratch[t];
+      size_t model = id[queries[begin[tasks[i]]]];
+      const Model & m = models[model];
+      int n = m.n;
+      load(m, model, s);
+      s.k.resize(n);
+      Eigen::Map<const Eigen::VectorXd> a(alpha(m), n);
+      MatrixMap L = cholesky(m);
+      for (size_t j = begin[tasks[i]]; j < begin[tasks[i] + 1]; ++j) {
+        size_t q = queries[j];
+        s.x_star = x.row(q).transpose();
+        s.cf->get_row(s.x_star, s.X.data(), s.k, s.ws);
+        result(q, 0) = s.k.dot(a);
+        if (compute_variance) {
+          // distinct vectors, i.e. without the noise term
+          s.x_star2 = s.x_star;
+          L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(s.k);
+          result(q, 1) = s.cf->get(s.x_star, s.x_star2) - s.k.squaredNorm();
+        }
+      }
+    });
+    return result;
+  }
+
+  Eigen::VectorXd GPBatch::log_likelihood(size_t threads)
+  {
+    compute(threads);
+    Eigen::VectorXd result(models.size());
+    for (size_t i = 0; i < models.size(); ++i) {
+      const Model & m = models[i];
+      Eigen::Map<const Eigen::VectorXd> y(targets(m), m.n), a(alpha(m), m.n);
+      double det = 2 * cholesky(m).diagonal().head(m.n).array().log().sum();
+      result(i) = -0.5*y.dot(a) - 0.5*det - 0.5*m.n*log2pi;
+    }
+    return result;
+  }
+
+  Eigen::MatrixXd GPBatch::log_likelihood_gradient(size_t threads)
+  {
+    compute(threads);
+    std::vector<size_t> ids(models.size());
+    for (size_t i = 0; i < ids.size(); ++i) ids[i] = i;
+    ids = by_size(ids);
+    Eigen::MatrixXd grad(param_dim, models.size());
+    prepare_scratch(parallel_threads(ids.size(), threads));
+    parallel_for(ids.size(), threads, [&](size_t i, size_t t) {
+      Scratch & s = scratch[t];
+      const Model & m = models[ids[i]];
+      int n = m.n;
+      load(m, ids[i], s);
+      // W = alpha alpha^T - K^-1
+      MatrixMap L = cholesky(m);
+      Eigen::Map<const Eigen::VectorXd> a(alpha(m), n);
+      s.W.setIdentity(n, n);
+      L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solveInPlace(s.W);
+      L.topLeftCorner(n, n).triangularView<Eigen::Lower>().transpose().solveInPlace(s.W);
+      s.W = a * a.transpose() - s.W;
+      s.g.resize(param_dim);
+      grad.col(ids[i]).setZero();
+      double k;
+      for (int r = 0; r < n; ++r) {
+        for (int c = 0; c <= r; ++c) {
+          s.cf->value_and_grad(s.x[r], s.x[c], k, s.g, s.ws);
+          grad.col(ids[i]) += (r == c ? 0.5 : 1.0) * s.W(r, c) * s.g;
+        }
+      }
+    });
+    return grad;
+  }
+
+  int GPBatch::capacity(int bucket)
+  {
+    return (bucket % 2 == 0 ? 16 : 24) << (bucket / 2);
+  }
+
+  size_t GPBatch::allocate(int bucket)
+  {
+    while (static_cast<int>(arenas.size()) <= bucket) {
+      Arena arena;
+      arena.capacity = capacity(arenas.size());
+      arena.stride = arena.capacity * (input_dim + 2 + arena.capacity);
+      arena.slots = 0;
+      arenas.push_back(arena);
+    }
+    Arena & arena = arenas[bucket];
+    if (!arena.free.empty()) {
+      size_t slot = arena.free.back();
+      arena.free.pop_back();
+      return slot;
+    }
+    arena.data.resize((arena.slots + 1) * arena.stride);
+    return arena.slots++;
+  }
+
+  void GPBatch::reserve(size_t id, int n)
+  {
+    Model & m = models[id];
+    if (capacity(m.bucket) >= n) return;
+    int bucket = m.bucket;
+    while (capacity(bucket) < n) ++bucket;
+    Model moved = m;
+    moved.bucket = bucket;
+    moved.slot = allocate(bucket);
+    // copy after allocation, which may move the data of the new arena
+    std::copy(inputs(m), inputs(m) + m.n * input_dim, inputs(moved));
+    std::copy(targets(m), targets(m) + m.n, targets(moved));
+    std::copy(alpha(m), alpha(m) + m.n, alpha(moved));
+    cholesky(moved).topLeftCorner(m.n, m.n) = cholesky(m).topLeftCorner(m.n, m.n);
+    arenas[m.bucket].free.push_back(m.slot);
+    m = moved;
+  }
+
+  double * GPBatch::inputs(const Model & m)
+  {
+    Arena & arena = arenas[m.bucket];
+    return arena.data.data() + m.slot * arena.stride;
+  }
+
+  double * GPBatch::targets(const Model & m)
+  {
+    return inputs(m) + arenas[m.bucket].capacity * input_dim;
+  }
+
+  double * GPBatch::alpha(const Model & m)
+  {
+    return targets(m) + arenas[m.bucket].capacity;
+  }
+
+  GPBatch::MatrixMap GPBatch::cholesky(const Model & m)
+  {
+    int c = arenas[m.bucket].capacity;
+    return MatrixMap(alpha(m) + c, c, c, Eigen::OuterStride<>(c));
+  }
+
+  void GPBatch::load(const Model & m, size_t id, Scratch & s)
+  {
+    s.cf->set_loghyper(&loghyper[id * param_dim]);
+    if (s.x.size() < static_cast<size_t>(m.n)) s.x.resize(m.n);
+    s.X.resize(m.n);
+    const double * x = inputs(m);
+    for (int i = 0; i < m.n; ++i) {
+      s.x[i] = Eigen::Map<const Eigen::VectorXd>(x + i * input_dim, input_dim);
+      s.X[i] = &s.x[i];
+    }
+  }
+
+  void GPBatch::factorize(size_t id, Scratch & s)
+  {
+    Model & m = models[id];
+    int n = m.n;
+    load(m, id, s);
+    // lower triangle of the kernel matrix, column by column
+    MatrixMap L = cholesky(m);
+    for (int j = 0; j < n; ++j) {
+      s.cf->get_row(s.x[j], s.X.data() + j, L.col(j).segment(j, n - j), s.ws);
+    }
+    Eigen::Ref<Eigen::MatrixXd> K(L.topLeftCorner(n, n));
+    Eigen::LLT<Eigen::Ref<Eigen::MatrixXd> > llt(K);
+    if (llt.info() != Eigen::Success) {
+      throw std::runtime_error("Kernel matrix is not positive definite");
+    }
+    update_alpha(m);
+    m.factorized = true;
+  }
+
+  void GPBatch::update_alpha(const Model & m)
+  {
+    Eigen::Map<Eigen::VectorXd> a(alpha(m), m.n);
+    a = Eigen::Map<const Eigen::VectorXd>(targets(m), m.n);
+    MatrixMap L = cholesky(m);
+    L.topLeftCorner(m.n, m.n).triangularView<Eigen::Lower>().solveInPlace(a);
+    L.topLeftCorner(m.n, m.n).triangularView<Eigen::Lower>().transpose().solveInPlace(a);
+  }
+
+  void GPBatch::prepare_scratch(size_t threads)
+  {
+    while (scratch.size() < threads) {
+      scratch.push_back(Scratch());
+      scratch.back().cf = scratch.size() > 1 ? CovFactory().create(input_dim, covf_def) : NULL;
+    }
+  }
+
+  std::vector<size_t> GPBatch::by_size(const std::vector<size_t> & ids)
+  {
+    std::vector<size_t> sorted(ids);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [&](size_t a, size_t b) { return models[a].n > models[b].n; });
+    return sorted;
+  }
+
+  void GPBatch::check_id(size_t id)
+  {
+    if (id >= models.size()) throw std::runtime_error("Model id out of range");
+  }
+}
@@ -0,0 +1,260 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp_linear.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace libgp {
+
+  const double log2pi = log(2*M_PI);
+
+  GaussianProcessLinear::GaussianProcessLinear (size_t input_dim, std::string covf_def)
+    : GaussianProcess(input_dim, covf_def)
+  {
+    if (!cf->feature_form(m, noise)) {
+      throw std::runtime_error(cf->to_string() + " has no feature representation");
+    }
+    if (noise < 0) {
+      throw std::runtime_error("GaussianProcessLinear requires a noise term");
+    }
+    param.resize(m);
+    cf->feature_params(param);
+    G = Eigen::MatrixXd::Zero(m, m);
+    b = Eigen::VectorXd::Zero(m);
+    yy = 0;
+    w.resize(m);
+    phi.resize(m);
+    beta = Eigen::VectorXd::Zero(m);
+    // the n x n cholesky factor is only needed on request
+    L.resize(0, 0);
+    features_changed = true;
+    beta_needs_update = true;
+  }
+
+  GaussianProcessLinear::~GaussianProcessLinear () {}
+
+  GaussianProcess * GaussianProcessLinear::fork()
+  {
+    return new GaussianProcessLinear(*this);
+  }
+
+  size_t GaussianProcessLinear::get_feature_dim()
+  {
+    return m;
+  }
+
+  double GaussianProcessLinear::f(const double x[])
+  {
+    if (sampleset->empty()) return 0;
+    compute();
+    update_beta();
+    cf->features(Eigen::Map<const Eigen::VectorXd>(x, input_dim), phi);
+    return phi.cwiseProduct(w).dot(beta);
+  }
+
+  double GaussianProcessLinear::var(const double x[])
+  {
+    if (sampleset->empty()) return 0;
+    compute();
+    cf->features(Eigen::Map<const Eigen::VectorXd>(x, input_dim), phi);
+    // k** - k*^T K^-1 k* = s^2 phi^T A^-1 phi
+    phi = phi.cwiseProduct(w);
+    A.matrixL().solveInPlace(phi);
+    return s2 * phi.squaredNorm();
+  }
+
+  Eigen::MatrixXd GaussianProcessLinear::predict(const Eigen::MatrixXd& x, bool compute_variance)
+  {
+    if (x.cols() != static_cast<int>(input_dim)) {
+      throw std::runtime_error("Input dimension mismatch");
+    }
+    if (sampleset->empty()) return Eigen::MatrixXd();
+    compute();
+    update_beta();
+    Eigen::MatrixXd result(x.rows(), compute_variance ? 2 : 1);
+    for (int i = 0; i < x.rows(); ++i) {
+      cf->features(x.row(i).transpose(), phi);
+      phi = phi.cwiseProduct(w);
+      result(i, 0) = phi.dot(beta);
+      if (compute_variance) {
+        A.matrixL().solveInPlace(phi);
+        result(i, 1) = s2 * phi.squaredNorm();
+      }
+    }
+    return result;
+  }
+
+  void GaussianProcessLinear::prepare()
+  {
+    compute();
+    update_beta();
+    rt_x.resize(input_dim);
+    rt_v.resize(m);
+  }
+
+  bool GaussianProcessLinear::predict_rt(const double x[], double & mean, double * var)
+  {
+    if (cf->loghyper_changed || features_changed || beta_needs_update || rt_v.size() != m
+        || rt_x.size() != static_cast<int>(input_dim)) {
+      return false;
+    }
+    mean = 0;
+    if (var != NULL) *var = 0;
+    if (sampleset->empty()) return true;
+    rt_x = Eigen::Map<const Eigen::VectorXd>(x, input_dim);
+    cf->features(rt_x, rt_v);
+    rt_v = rt_v.cwiseProduct(w);
+    mean = rt_v.dot(beta);
+    if (var != NULL) {
+      A.matrixL().solveInPlace(rt_v);
+      *var = s2 * rt_v.squaredNorm();
+    }
+    return true;
+  }
+
+  void GaussianProcessLinear::accumulate(const Eigen::VectorXd & x, double y)
+  {
+    cf->features(x, phi);
+    G.noalias() += phi * phi.transpose();
+    b += y * phi;
+    yy += y * y;
+  }
+
+  void GaussianProcessLinear::add_patterns(const Eigen::MatrixXd& x, const Eigen::VectorXd& y)
+  {
+    if (x.rows() != y.size()) {
+      throw std::runtime_error("Number of input patterns must match number of target values");
+    }
+    if (x.cols() != static_cast<int>(input_dim)) {
+      throw std::runtime_error("Input dimension mismatch");
+    }
+    size_t n = sampleset->size();
+    sampleset->reserve(n + x.rows());
+    for (int i = 0; i < x.rows(); ++i) {
+      sampleset->add(x.row(i).transpose(), y(i));
+      accumulate(sampleset->x(n + i), y(i));
+    }
+    // A is factorized once for the whole batch
+    features_changed = true;
+    alpha_needs_update = true;
+    // the cholesky factor of the base class does not cover the new patterns
+    stats_need_update = true;
+  }
+
+  void GaussianProcessLinear::add_pattern(const double x[], double y)
+  {
+    size_t n = sampleset->size();
+    sampleset->add(x, y);
+    accumulate(sampleset->x(n), y);
+    // rank one update of A if it is up to date
+    if (!cf->loghyper_changed && !features_changed) {
+      phi = phi.cwiseProduct(w);
+      A.rankUpdate(phi);
+      beta_needs_update = true;
+    } else {
+      features_changed = true;
+    }
+    alpha_needs_update = true;
+    stats_need_update = true;
+  }
+
+  bool GaussianProcessLinear::set_y(size_t i, double y)
+  {
+    if (i >= sampleset->size()) return false;
+    double y_old = sampleset->y(i);
+    if (!GaussianProcess::set_y(i, y)) return false;
+    cf->features(sampleset->x(i), phi);
+    b += (y - y_old) * phi;
+    yy += y * y - y_old * y_old;
+    beta_needs_update = true;
+    return true;
+  }
+
+  void GaussianProcessLinear::clear_sampleset()
+  {
+    GaussianProcess::clear_sampleset();
+    G.setZero();
+    b.setZero();
+    yy = 0;
+    features_changed = true;
+  }
+
+  void GaussianProcessLinear::compute()
+  {
+    if (!cf->loghyper_changed && !features_changed) return;
+    cf->loghyper_changed = false;
+    features_changed = false;
+    Eigen::VectorXd p = cf->get_loghyper();
+    for (int j = 0; j < m; ++j) w(j) = exp(-p(param(j)));
+    s2 = exp(2 * p(noise));
+    // A = W G W + s^2 I
+    Eigen::MatrixXd M = w.asDiagonal() * G * w.asDiagonal();
+    M.diagonal().array() += s2;
+    A.compute(M);
+    beta_needs_update = true;
+  }
+
+  void GaussianProcessLinear::cholesky()
+  {
+    compute();
+    factorize();
+  }
+
+  Eigen::MatrixXd GaussianProcessLinear::kernel_inverse()
+  {
+    int n = sampleset->size();
+    Eigen::MatrixXd V(m, n);
+    for (int i = 0; i < n; ++i) {
+      cf->features(sampleset->x(i), phi);
+      V.col(i) = phi.cwiseProduct(w);
+    }
+    A.matrixL().solveInPlace(V);
+    Eigen::MatrixXd K_inv = -V.transpose() * V;
+    K_inv.diagonal().array() += 1;
+    return K_inv / s2;
+  }
+
+  void GaussianProcessLinear::update_beta()
+  {
+    if (!beta_needs_update) return;
+    beta_needs_update = false;
+    beta = A.solve(w.cwiseProduct(b));
+  }
+
+  double GaussianProcessLinear::log_likelihood()
+  {
+    compute();
+    update_beta();
+    int n = sampleset->size();
+    // y^T K^-1 y = (y^T y - b^T W A^-1 W b) / s^2
+    double quad = (yy - w.cwiseProduct(b).dot(beta)) / s2;
+    // log |K| = (n - m) log s^2 + log |A|
+    double det = (n - m) * log(s2) + 2 * A.matrixLLT().diagonal().array().log().sum();
+    return -0.5*quad - 0.5*det - 0.5*n*log2pi;
+  }
+
+  double GaussianProcessLinear::log_likelihood_hessian(Eigen::VectorXd & grad, Eigen::MatrixXd & hess)
+  {
+    return numerical_hessian(grad, hess);
+  }
+
+  Eigen::VectorXd GaussianProcessLinear::log_likelihood_gradient()
+  {
+    compute();
+    update_beta();
+    int n = sampleset->size();
+    Eigen::VectorXd grad = Eigen::VectorXd::Zero(cf->get_param_dim());
+    Eigen::MatrixXd A_inv = A.solve(Eigen::MatrixXd::Identity(m, m));
+    // Phi^T alpha = beta and Phi^T K^-1 Phi = I - s^2 A^-1
+    for (int j = 0; j < m; ++j) {
+      grad(param(j)) -= beta(j) * beta(j) - 1 + s2 * A_inv(j, j);
+    }
+    // s^2 (alpha^T alpha - tr K^-1)
+    grad(noise) += (yy - w.cwiseProduct(b).dot(beta)) / s2 - beta.squaredNorm()
+                   - (n - m) - s2 * A_inv.trace();
+    return grad;
+  }
+}
@@ -0,0 +1,188 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp_multi.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace libgp {
+
+  const double log2pi = log(2*M_PI);
+
+  GaussianProcessMulti::GaussianProcessMulti (size_t input_dim, size_t output_dim, std::string covf_def)
+    : GaussianProcess(input_dim, covf_def)
+  {
+    if (output_dim == 0) throw std::runtime_error("Output dimension must be positive");
+    this->output_dim = output_dim;
+    Y.resize(0, output_dim);
+    alphas_need_update = true;
+  }
+
+  GaussianProcessMulti::GaussianProcessMulti (size_t output_dim)
+  {
+    this->output_dim = output_dim;
+    alphas_need_update = true;
+  }
+
+  GaussianProcessMulti::~GaussianProcessMulti () {}
+
+  GaussianProcess * GaussianProcessMulti::fork()
+  {
+    GaussianProcessMulti * gp = new GaussianProcessMulti(output_dim);
+    fork_to(gp);
+    gp->Y = Y;
+    return gp;
+  }
+
+  size_t GaussianProcessMulti::get_output_dim()
+  {
+    return output_dim;
+  }
+
+  void GaussianProcessMulti::add_patterns(const Eigen::MatrixXd& x, const Eigen::MatrixXd& y)
+  {
+    if (y.cols() != static_cast<int>(output_dim)) {
+      throw std::runtime_error("Output dimension mismatch");
+    }
+    // the sample set holds the first output, the factor is shared
+    GaussianProcess::add_patterns(x, y.col(0));
+    size_t n = Y.rows();
+    Y.conservativeResize(n + y.rows(), Eigen::NoChange);
+    Y.bottomRows(y.rows()) = y;
+    alphas_need_update = true;
+  }
+
+  void GaussianProcessMulti::add_pattern(const double x[], const double y[])
+  {
+    GaussianProcess::add_pattern(x, y[0]);
+    size_t n = Y.rows();
+    Y.conservativeResize(n + 1, Eigen::NoChange);
+    Y.row(n) = Eigen::Map<const Eigen::RowVectorXd>(y, output_dim);
+    alphas_need_update = true;
+  }
+
+  void GaussianProcessMulti::add_patterns(const Eigen::MatrixXd& x, const Eigen::VectorXd& y)
+  {
+    if (output_dim != 1) throw std::runtime_error("Output dimension mismatch");
+    add_patterns(x, Eigen::MatrixXd(y));
+  }
+
+  void GaussianProcessMulti::add_pattern(const double x[], double y)
+  {
+    if (output_dim != 1) throw std::runtime_error("Output dimension mismatch");
+    add_pattern(x, &y);
+  }
+
+  bool GaussianProcessMulti::set_y(size_t i, size_t j, double y)
+  {
+    if (i >= static_cast<size_t>(Y.rows()) || j >= output_dim) return false;
+    if (j == 0) GaussianProcess::set_y(i, y);
+    Y(i, j) = y;
+    alphas_need_update = true;
+    return true;
+  }
+
+  bool GaussianProcessMulti::set_y(size_t i, double y)
+  {
+    return set_y(i, 0, y);
+  }
+
+  void GaussianProcessMulti::clear_sampleset()
+  {
+    GaussianProcess::clear_sampleset();
+    Y.resize(0, output_dim);
+    alphas_need_update = true;
+  }
+
+  const Eigen::MatrixXd & GaussianProcessMulti::get_targets()
+  {
+    return Y;
+  }
+
+  void GaussianProcessMulti::compute()
+  {
+    // the factor only changes with the hyperparameters, added patterns and
+    // changed targets mark the weights themselves
+    if (cf->loghyper_changed) alphas_need_update = true;
+    GaussianProcess::compute();
+  }
+
+  void GaussianProcessMulti::update_alphas()
+  {
+    if (!alphas_need_update) return;
+    alphas_need_update = false;
+    int n = sampleset->size();
+    if (use_spectral) {
+      alphas.resize(n, output_dim);
+      Eigen::VectorXd a;
+      for (size_t j = 0; j < output_dim; ++j) {
+        spectral.solve(Y.col(j), a);
+        alphas.col(j) = a;
+      }
+      return;
+    }
+    // one solve with multiple right-hand sides
+    alphas = L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solve(Y);
+    L.topLeftCorner(n, n).triangularView<Eigen::Lower>().adjoint().solveInPlace(alphas);
+  }
+
+  Eigen::MatrixXd GaussianProcessMulti::predict_outputs(const Eigen::MatrixXd& x, Eigen::VectorXd * var)
+  {
+    if (x.cols() != static_cast<int>(input_dim)) {
+      throw std::runtime_error("Input dimension mismatch");
+    }
+    int n = sampleset->size();
+    if (var != NULL) var->setZero(x.rows());
+    if (n == 0) return Eigen::MatrixXd::Zero(x.rows(), output_dim);
+    compute();
+    update_alphas();
+    // kernel vectors of all test inputs
+    Eigen::MatrixXd K_star(n, x.rows());
+    Eigen::VectorXd x_star;
+    for (int i = 0; i < x.rows(); ++i) {
+      x_star = x.row(i).transpose();
+      cf->get_row(x_star, sampleset->x().data(), K_star.col(i), cov_ws);
+    }
+    if (var != NULL) {
+      // distinct vectors as in var(), i.e. without the noise term
+      Eigen::VectorXd x_star2;
+      for (int i = 0; i < x.rows(); ++i) {
+        x_star = x.row(i).transpose();
+        x_star2 = x_star;
+        (*var)(i) = cf->get(x_star, x_star2);
+      }
+      if (use_spectral) {
+        for (int i = 0; i < x.rows(); ++i) (*var)(i) -= spectral.quad_form(K_star.col(i));
+      } else {
+        Eigen::MatrixXd V = L.topLeftCorner(n, n).triangularView<Eigen::Lower>().solve(K_star);
+        *var -= V.colwise().squaredNorm().transpose();
+      }
+    }
+    return K_star.transpose() * alphas;
+  }
+
+  double GaussianProcessMulti::log_likelihood()
+  {
+    int n = sampleset->size();
+    compute();
+    update_alphas();
+    double det = use_spectral ? spectral.log_det() : 2 * L.diagonal().head(n).array().log().sum();
+    double quad = Y.cwiseProduct(alphas).sum();
+    return -0.5*quad - 0.5*output_dim*det - 0.5*output_dim*n*log2pi;
+  }
+
+  double GaussianProcessMulti::log_likelihood_hessian(Eigen::VectorXd & grad, Eigen::MatrixXd & hess)
+  {
+    return numerical_hessian(grad, hess);
+  }
+
+  Eigen::VectorXd GaussianProcessMulti::log_likelihood_gradient()
+  {
+    compute();
+    update_alphas();
+    Eigen::MatrixXd W = alphas * alphas.transpose() - output_dim * kernel_inverse();
+    return trace_gradient(W);
+  }
+}
@@ -34,6 +34,23 @@ namespace libgp
     nested->grad(x1.segment(filter, 1), x2.segment(filter, 1), grad);
   }
   
+  void InputDimFilter::value_and_grad(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, double &k,
+                                      Eigen::Ref<Eigen::VectorXd> grad, Workspace &ws)
+  {
+    // distinct vectors as in get()
+    Eigen::VectorXd & y1 = ws.acquire(1);
+    Eigen::VectorXd & y2 = ws.acquire(1);
+    y1(0) = x1(filter);
+    y2(0) = x2(filter);
+    nested->value_and_grad(y1, y2, k, grad, ws);
+    ws.release(2);
+  }
+  
+  void InputDimFilter::hessian(const Eigen::VectorXd &x1, const Eigen::VectorXd &x2, Eigen::Ref<Eigen::MatrixXd> hess)
+  {
+    nested->hessian(x1.segment(filter, 1), x2.segment(filter, 1), hess);
+  }
+  
   void InputDimFilter::set_loghyper(const Eigen::VectorXd &p)
   {
     CovarianceFunction::set_loghyper(p);
@@ -46,5 +63,14 @@ namespace libgp
     is <<  "InputDimFilter(" << filter << "/" << nested->to_string() << ")";
     return is.str();
   }
+
+  CovarianceFunction * InputDimFilter::clone()
+  {
+    InputDimFilter * copy = new InputDimFilter();
+    copy->init(input_dim, filter, nested->clone());
+    copy->loghyper = loghyper;
+    copy->loghyper_changed = loghyper_changed;
+    return copy;
+  }
 }
 
@@ -0,0 +1,232 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "lbfgsb.h"
+
+namespace libgp {
+
+/** Maximum number of evaluations per line search. */
+const int max_line_search = 20;
+
+void LBFGSB::init(size_t m, double eps_stop, double c1, double c2)
+{
+  this->m = m;
+  this->eps_stop = eps_stop;
+  this->c1 = c1;
+  this->c2 = c2;
+  set_bounds(-10, 10);
+}
+
+void LBFGSB::set_bounds(const Eigen::VectorXd & lower, const Eigen::VectorXd & upper)
+{
+  if (lower.size() != upper.size() || (lower.array() > upper.array()).any()) {
+    throw std::runtime_error("Invalid bounds");
+  }
+  this->lower = lower;
+  this->upper = upper;
+}
+
+void LBFGSB::set_bounds(double lower, double upper)
+{
+  set_bounds(Eigen::VectorXd::Constant(1, lower), Eigen::VectorXd::Constant(1, upper));
+}
+
+Eigen::VectorXd LBFGSB::lower_bounds(int param_dim)
+{
+  if (lower.size() == 1) return Eigen::VectorXd::Constant(param_dim, lower(0));
+  if (lower.size() != param_dim) throw std::runtime_error("Bounds dimension mismatch");
+  return lower;
+}
+
+Eigen::VectorXd LBFGSB::upper_bounds(int param_dim)
+{
+  if (upper.size() == 1) return Eigen::VectorXd::Constant(param_dim, upper(0));
+  if (upper.size() != param_dim) throw std::runtime_error("Bounds dimension mismatch");
+  return upper;
+}
+
+void LBFGSB::maximize(GaussianProcess * gp, size_t n, bool verbose)
+{
+  MarginalLikelihood objective(gp);
+  maximize(&objective, n, verbose);
+}
+
+void LBFGSB::maximize(Objective * objective, size_t n, bool verbose)
+{
+  objective->clear_cache();
+  Eigen::VectorXd x = objective->get_loghyper();
+  int param_dim = x.size();
+  Eigen::VectorXd lo = lower_bounds(param_dim), up = upper_bounds(param_dim);
+  x = x.cwiseMax(lo).cwiseMin(up);
+  // minimize the negative objective
+  Eigen::VectorXd g, g_new;
+  double F = -objective->value_and_gradient(x, g);
+  g = -g;
+  if (verbose) std::cout << 0 << " " << F << std::endl;
+  start(-F);
+  std::deque<Eigen::VectorXd> S, Y;
+
+  for (size_t i = 0; i < n; ++i) {
+    // projected gradient
+    if ((x - (x - g).cwiseMax(lo).cwiseMin(up)).lpNorm<Eigen::Infinity>() < eps_stop) {
+      stopped(GRADIENT_NORM);
+      break;
+    }
+    // variables held at a bound
+    Eigen::VectorXd free = Eigen::VectorXd::Ones(param_dim);
+    for (int j = 0; j < param_dim; ++j) {
+      if ((x(j) <= lo(j) && g(j) > 0) || (x(j) >= up(j) && g(j) < 0)) free(j) = 0;
+    }
+    Eigen::VectorXd steepest = -g.cwiseProduct(free);
+    Eigen::VectorXd d;
+    for (bool held = true; held; ) {
+      // two-loop recursion on the free variables
+      Eigen::VectorXd q = g.cwiseProduct(free);
+      std::vector<double> a(S.size()), rho(S.size());
+      for (size_t k = 0; k < S.size(); ++k) {
+        double sy = S[k].cwiseProduct(free).dot(Y[k]);
+        rho[k] = sy > 0 ? 1 / sy : 0;
+        a[k] = rho[k] * S[k].cwiseProduct(free).dot(q);
+        q -= a[k] * Y[k].cwiseProduct(free);
+      }
+      if (!S.empty() && rho[0] > 0) {
+        q *= 1 / (rho[0] * Y[0].cwiseProduct(free).squaredNorm());
+      }
+      for (size_t k = S.size(); k-- > 0; ) {
+        double b = rho[k] * Y[k].cwiseProduct(free).dot(q);
+        q += (a[k] - b) * S[k].cwiseProduct(free);
+      }
+      d = -q.cwiseProduct(free);
+      // variables at a bound whose direction leaves the box are held as
+      // well, the direction is recomputed on the remaining variables
+      held = false;
+      for (int j = 0; j < param_dim; ++j) {
+        if (free(j) != 0 && ((x(j) <= lo(j) && d(j) < 0) || (x(j) >= up(j) && d(j) > 0))) {
+          free(j) = 0;
+          held = true;
+        }
+      }
+    }
+    double dphi0 = g.dot(d);
+    if (!(dphi0 < 0)) {
+      // no descent direction, restart from steepest descent
+      S.clear();
+      Y.clear();
+      d = steepest;
+      dphi0 = g.dot(d);
+    }
+    // largest step inside the box
+    double a_max = std::numeric_limits<double>::infinity();
+    for (int j = 0; j < param_dim; ++j) {
+      if (d(j) < 0) a_max = std::min(a_max, (lo(j) - x(j)) / d(j));
+      else if (d(j) > 0) a_max = std::min(a_max, (up(j) - x(j)) / d(j));
+    }
+    if (!(a_max > 0)) {
+      stopped(NO_PROGRESS);
+      break;
+    }
+    double a0 = S.empty() ? std::min(1.0, 1 / d.norm()) : 1.0;
+    double F_new;
+    double step = line_search(objective, x, d, F, dphi0, std::min(a0, a_max), a_max, F_new, g_new);
+    if (step == 0) {
+      if (S.empty()) {
+        stopped(NO_PROGRESS);
+        break;
+      }
+      // retry with steepest descent
+      S.clear();
+      Y.clear();
+      continue;
+    }
+    Eigen::VectorXd x_new = (x + step * d).cwiseMax(lo).cwiseMin(up);
+    Eigen::VectorXd s = x_new - x, y = g_new - g;
+    if (s.dot(y) > std::numeric_limits<double>::epsilon() * y.squaredNorm()) {
+      if (S.size() == m) {
+        S.pop_back();
+        Y.pop_back();
+      }
+      S.push_front(s);
+      Y.push_front(y);
+    }
+    x = x_new;
+    F = F_new;
+    g = g_new;
+    if (verbose) std::cout << i + 1 << " " << F << std::endl;
+    if (stop(i + 1, x, -F, g)) break;
+  }
+  objective->set_loghyper(x);
+}
+
+double LBFGSB::line_search(Objective * objective, const Eigen::VectorXd & x, const Eigen::VectorXd & d,
+                           double F0, double dphi0, double a, double a_max, double & F, Eigen::VectorXd & g)
+{
+  // phi(a) = -objective(x + a d), evaluations are memoized by the objective
+  auto phi = [&](double a, double & F, Eigen::VectorXd & g) {
+    F = -objective->value_and_gradient(x + a * d, g);
+    g = -g;
+    return g.dot(d);
+  };
+  double a_lo = 0, F_lo = F0, dphi_lo = dphi0;
+  double a_hi = 0, F_hi = 0, dphi_hi = 0;
+  bool bracketed = false;
+  int evals = 0;
+  // bracketing phase (Nocedal & Wright, algorithm 3.5)
+  while (evals < max_line_search) {
+    double dphi = phi(a, F, g);
+    ++evals;
+    if (!(F <= F0 + c1 * a * dphi0) || (evals > 1 && F >= F_lo)) {
+      a_hi = a; F_hi = F; dphi_hi = dphi;
+      bracketed = true;
+      break;
+    }
+    if (std::abs(dphi) <= -c2 * dphi0) return a;
+    if (dphi >= 0) {
+      a_hi = a_lo; F_hi = F_lo; dphi_hi = dphi_lo;
+      a_lo = a; F_lo = F; dphi_lo = dphi;
+      bracketed = true;
+      break;
+    }
+    a_lo = a; F_lo = F; dphi_lo = dphi;
+    // sufficient decrease at the boundary of the box
+    if (a >= a_max) return a;
+    a = std::min(2 * a, a_max);
+  }
+  // zoom phase (algorithm 3.6) with safeguarded cubic interpolation
+  while (bracketed && evals < max_line_search) {
+    double h = a_hi - a_lo;
+    double d1 = dphi_lo + dphi_hi - 3 * (F_lo - F_hi) / (a_lo - a_hi);
+    double d2 = std::sqrt(d1 * d1 - dphi_lo * dphi_hi);
+    double a_new = a_hi - (a_hi - a_lo) * (dphi_hi + d2 - d1) / (dphi_hi - dphi_lo + 2 * d2);
+    double lo = std::min(a_lo, a_hi), hi = std::max(a_lo, a_hi);
+    if (!(a_new > lo + 0.1 * (hi - lo) && a_new < hi - 0.1 * (hi - lo))) a_new = a_lo + 0.5 * h;
+    a = a_new;
+    double dphi = phi(a, F, g);
+    ++evals;
+    if (!(F <= F0 + c1 * a * dphi0) || F >= F_lo) {
+      a_hi = a; F_hi = F; dphi_hi = dphi;
+    } else {
+      if (std::abs(dphi) <= -c2 * dphi0) return a;
+      if (dphi * (a_hi - a_lo) >= 0) {
+        a_hi = a_lo; F_hi = F_lo; dphi_hi = dphi_lo;
+      }
+      a_lo = a; F_lo = F; dphi_lo = dphi;
+    }
+  }
+  // accept the best point with sufficient decrease
+  if (a_lo > 0) {
+    phi(a_lo, F, g);
+    return a_lo;
+  }
+  return 0;
+}
+
+}
@@ -0,0 +1,96 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "multi_start.h"
+#include "work_stealing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace libgp {
+
+  MultiStart::MultiStart (const Optimizer & optimizer)
+    : optimizer(optimizer), round(0), margin(0) {}
+
+  MultiStart::~MultiStart () {}
+
+  void MultiStart::set_cutoff(size_t round, double margin)
+  {
+    this->round = round;
+    this->margin = margin;
+  }
+
+  double MultiStart::maximize(GaussianProcess * gp, const Eigen::MatrixXd & starts, size_t n, size_t threads)
+  {
+    size_t k = starts.cols();
+    if (k == 0) throw std::runtime_error("MultiStart requires at least one start");
+    if (starts.rows() != static_cast<int>(gp->covf().get_param_dim())) {
+      throw std::runtime_error("Parameter dimension mismatch");
+    }
+    std::vector<std::unique_ptr<GaussianProcess> > forks;
+    std::vector<std::unique_ptr<MarginalLikelihood> > objectives;
+    for (size_t i = 0; i < k; ++i) {
+      forks.emplace_back(gp->fork());
+      forks[i]->covf().set_loghyper(starts.col(i));
+      objectives.emplace_back(new MarginalLikelihood(forks[i].get()));
+    }
+    values = Eigen::VectorXd::Constant(k, -std::numeric_limits<double>::infinity());
+    loghyper = starts;
+    abandoned.assign(k, false);
+    size_t step = round > 0 ? round : n;
+    for (size_t done = 0; done < n; done += step) {
+      size_t iterations = std::min(step, n - done);
+      std::vector<size_t> active;
+      for (size_t i = 0; i < k; ++i) {
+        if (!abandoned[i]) active.push_back(i);
+      }
+      parallel_for(active.size(), threads, [&](size_t j, size_t) {
+        size_t i = active[j];
+        // restarts the optimizer from where the previous round stopped
+        optimizer(objectives[i].get(), iterations);
+        values(i) = forks[i]->log_likelihood();
+        loghyper.col(i) = forks[i]->covf().get_loghyper();
+      });
+      if (round == 0) break;
+      double best = -std::numeric_limits<double>::infinity();
+      for (size_t i : active) {
+        if (values(i) > best) best = values(i);
+      }
+      for (size_t i : active) {
+        if (!(values(i) >= best - margin)) abandoned[i] = true;
+      }
+    }
+    size_t best = 0;
+    for (size_t i = 1; i < k; ++i) {
+      if (values(i) > values(best) || std::isnan(values(best))) best = i;
+    }
+    gp->covf().set_loghyper(loghyper.col(best));
+    return values(best);
+  }
+
+  const Eigen::VectorXd & MultiStart::get_values()
+  {
+    return values;
+  }
+
+  const Eigen::MatrixXd & MultiStart::get_loghyper()
+  {
+    return loghyper;
+  }
+
+  const std::vector<bool> & MultiStart::get_abandoned()
+  {
+    return abandoned;
+  }
+
+  Eigen::MatrixXd MultiStart::random_starts(const Eigen::VectorXd & center, size_t k, double scale)
+  {
+    Eigen::MatrixXd starts = scale * Eigen::MatrixXd::Random(center.size(), k);
+    starts.colwise() += center;
+    return starts;
+  }
+}
@@ -0,0 +1,178 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "objective.h"
+#include "work_stealing.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace libgp {
+
+  /** Number of memoized evaluations, enough for the points of a line search. */
+  const size_t objective_cache_size = 8;
+
+  Objective::Objective () : evaluations(0) {}
+
+  double Objective::value_and_gradient(const Eigen::VectorXd &p, Eigen::VectorXd &grad)
+  {
+    for (size_t i = 0; i < cache.size(); ++i) {
+      if (cache[i].p.size() == p.size() && cache[i].p == p) {
+        grad = cache[i].grad;
+        return cache[i].value;
+      }
+    }
+    set_loghyper(p);
+    double value = evaluate(grad);
+    ++evaluations;
+    if (cache.size() == objective_cache_size) cache.pop_back();
+    cache.push_front(Evaluation());
+    cache.front().p = p;
+    cache.front().grad = grad;
+    cache.front().value = value;
+    return value;
+  }
+
+  void Objective::clear_cache()
+  {
+    cache.clear();
+  }
+
+  size_t Objective::get_evaluations()
+  {
+    return evaluations;
+  }
+
+  Objective * Objective::fork()
+  {
+    return NULL;
+  }
+
+  double Objective::evaluate(Eigen::VectorXd &grad)
+  {
+    double v = value();
+    grad = gradient();
+    return v;
+  }
+
+  MarginalLikelihood::MarginalLikelihood (GaussianProcess * gp, bool owned) : gp(gp), owned(owned) {}
+
+  MarginalLikelihood::~MarginalLikelihood ()
+  {
+    if (owned) delete gp;
+  }
+
+  Objective * MarginalLikelihood::fork()
+  {
+    return new MarginalLikelihood(gp->fork(), true);
+  }
+
+  Eigen::VectorXd MarginalLikelihood::get_loghyper()
+  {
+    return gp->covf().get_loghyper();
+  }
+
+  void MarginalLikelihood::set_loghyper(const Eigen::VectorXd &p)
+  {
+    gp->covf().set_loghyper(p);
+  }
+
+  double MarginalLikelihood::value()
+  {
+    return gp->log_likelihood();
+  }
+
+  Eigen::VectorXd MarginalLikelihood::gradient()
+  {
+    return gp->log_likelihood_gradient();
+  }
+
+  LooPredictive::LooPredictive (GaussianProcess * gp, bool owned) : MarginalLikelihood(gp, owned) {}
+
+  LooPredictive::~LooPredictive () {}
+
+  Objective * LooPredictive::fork()
+  {
+    return new LooPredictive(gp->fork(), true);
+  }
+
+  double LooPredictive::value()
+  {
+    return gp->loo_log_predictive();
+  }
+
+  Eigen::VectorXd LooPredictive::gradient()
+  {
+    return gp->loo_log_predictive_gradient();
+  }
+
+  double LooPredictive::evaluate(Eigen::VectorXd &grad)
+  {
+    return gp->loo_log_predictive(grad);
+  }
+
+  JointLikelihood::JointLikelihood (const std::vector<GaussianProcess *> & gps, size_t threads)
+    : threads(threads)
+  {
+    if (gps.empty()) throw std::runtime_error("JointLikelihood requires at least one model");
+    for (size_t i = 1; i < gps.size(); ++i) {
+      if (gps[i]->covf().to_string() != gps[0]->covf().to_string()) {
+        throw std::runtime_error("Models must share the covariance function");
+      }
+    }
+    // largest datasets first for load balancing
+    this->gps = gps;
+    std::stable_sort(this->gps.begin(), this->gps.end(), [](GaussianProcess * a, GaussianProcess * b) {
+      return a->get_sampleset_size() > b->get_sampleset_size();
+    });
+    set_loghyper(gps[0]->covf().get_loghyper());
+  }
+
+  JointLikelihood::~JointLikelihood () {}
+
+  Eigen::VectorXd JointLikelihood::get_loghyper()
+  {
+    return gps[0]->covf().get_loghyper();
+  }
+
+  void JointLikelihood::set_loghyper(const Eigen::VectorXd &p)
+  {
+    for (size_t i = 0; i < gps.size(); ++i) gps[i]->covf().set_loghyper(p);
+  }
+
+  double JointLikelihood::value()
+  {
+    // summed in a fixed order so that the result does not depend on scheduling
+    std::vector<double> values(gps.size());
+    parallel_for(gps.size(), threads, [&](size_t i, size_t) {
+      values[i] = gps[i]->log_likelihood();
+    });
+    double sum = 0;
+    for (size_t i = 0; i < values.size(); ++i) sum += values[i];
+    return sum;
+  }
+
+  Eigen::VectorXd JointLikelihood::gradient()
+  {
+    Eigen::MatrixXd grads(gps[0]->covf().get_param_dim(), gps.size());
+    parallel_for(gps.size(), threads, [&](size_t i, size_t) {
+      grads.col(i) = gps[i]->log_likelihood_gradient();
+    });
+    return grads.rowwise().sum();
+  }
+
+  double JointLikelihood::evaluate(Eigen::VectorXd &grad)
+  {
+    std::vector<double> values(gps.size());
+    Eigen::MatrixXd grads(gps[0]->covf().get_param_dim(), gps.size());
+    parallel_for(gps.size(), threads, [&](size_t i, size_t) {
+      values[i] = gps[i]->log_likelihood();
+      grads.col(i) = gps[i]->log_likelihood_gradient();
+    });
+    grad = grads.rowwise().sum();
+    double sum = 0;
+    for (size_t i = 0; i < values.size(); ++i) sum += values[i];
+    return sum;
+  }
+}
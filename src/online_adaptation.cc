@@ -0,0 +1,210 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "online_adaptation.h"
+#include "rprop.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <typeinfo>
+
+namespace libgp {
+
+  OnlineAdaptation::OnlineAdaptation (GaussianProcess * gp)
+    : gp(gp), background(true), t(0), refits(0)
+  {
+    init();
+    recent.reset(gp->GaussianProcess::fork());
+    recent->clear_sampleset();
+    loghyper = gp->covf().get_loghyper();
+    m1 = Eigen::VectorXd::Zero(loghyper.size());
+    m2 = Eigen::VectorXd::Zero(loghyper.size());
+    seen = gp->get_sampleset_size();
+  }
+
+  OnlineAdaptation::~OnlineAdaptation ()
+  {
+    if (pending.valid()) pending.wait();
+  }
+
+  void OnlineAdaptation::init(size_t batch, size_t window, size_t steps, double learning_rate,
+                              double threshold, size_t refit_iterations)
+  {
+    this->batch = std::max<size_t>(1, batch);
+    this->window = window;
+    this->steps = steps;
+    this->learning_rate = learning_rate;
+    this->threshold = threshold;
+    this->refit_iterations = refit_iterations;
+  }
+
+  void OnlineAdaptation::set_background(bool background)
+  {
+    this->background = background;
+  }
+
+  void OnlineAdaptation::add_pattern(const double x[], double y)
+  {
+    gp->add_pattern(x, y);
+    update();
+  }
+
+  bool OnlineAdaptation::update()
+  {
+    size_t installed = refits;
+    poll();
+    size_t n = gp->get_sampleset_size();
+    // the sample set was cleared
+    if (n < seen) seen = n;
+    if (n - seen >= batch) {
+      seen = n;
+      adapt();
+      if (get_drift() > threshold) refit();
+    }
+    return refits > installed;
+  }
+
+  bool OnlineAdaptation::poll()
+  {
+    if (!pending.valid() || pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return false;
+    }
+    try {
+      pending.get();
+    } catch (...) {
+      refitted.reset();
+      throw;
+    }
+    install();
+    return true;
+  }
+
+  bool OnlineAdaptation::wait()
+  {
+    if (!pending.valid()) return false;
+    pending.wait();
+    return poll();
+  }
+
+  void OnlineAdaptation::refit()
+  {
+    if (refitted || gp->get_sampleset_size() == 0) return;
+    refitted.reset(gp->fork());
+    refitted->covf().set_loghyper(loghyper);
+    GaussianProcess * model = refitted.get();
+    size_t n = refit_iterations;
+    // the fork owns its targets and covariance function, the shared input
+    // vectors are immutable, so the model can grow in the meantime
+    auto task = [model, n]() {
+      RProp rprop;
+      rprop.maximize(model, n, false);
+      model->prepare();
+    };
+    if (background) {
+      pending = std::async(std::launch::async, task);
+    } else {
+      task();
+      install();
+    }
+  }
+
+  bool OnlineAdaptation::refit_pending()
+  {
+    return refitted != nullptr;
+  }
+
+  double OnlineAdaptation::get_drift()
+  {
+    return (loghyper - gp->covf().get_loghyper()).lpNorm<Eigen::Infinity>();
+  }
+
+  const Eigen::VectorXd & OnlineAdaptation::get_loghyper()
+  {
+    return loghyper;
+  }
+
+  size_t OnlineAdaptation::get_refits()
+  {
+    return refits;
+  }
+
+  void OnlineAdaptation::adapt()
+  {
+    size_t n = gp->get_sampleset_size();
+    size_t w = std::min(window, n);
+    if (w == 0 || steps == 0) return;
+    SampleSet & samples = *gp->sampleset;
+    Eigen::MatrixXd X(w, gp->get_input_dim());
+    Eigen::VectorXd y(w);
+    for (size_t i = 0; i < w; ++i) {
+      X.row(i) = samples.x(n - w + i).transpose();
+      y(i) = samples.y(n - w + i);
+    }
+    recent->clear_sampleset();
+    recent->covf().set_loghyper(loghyper);
+    recent->add_patterns(X, y);
+    for (size_t s = 0; s < steps; ++s) {
+      if (s > 0) recent->covf().set_loghyper(loghyper);
+      // gradient per sample as in SGD
+      Eigen::VectorXd grad = recent->log_likelihood_gradient() / w;
+      if (!grad.allFinite()) break;
+      ++t;
+      m1 = 0.9 * m1 + 0.1 * grad;
+      m2 = 0.999 * m2 + 0.001 * grad.cwiseAbs2();
+      Eigen::VectorXd m1_hat = m1 / (1 - std::pow(0.9, t));
+      Eigen::VectorXd m2_hat = m2 / (1 - std::pow(0.999, t));
+      loghyper += learning_rate * m1_hat.cwiseQuotient((m2_hat.cwiseSqrt().array() + 1e-8).matrix());
+    }
+  }
+
+  void OnlineAdaptation::install()
+  {
+    GaussianProcess & r = *refitted;
+    SampleSet & samples = *gp->sampleset;
+    size_t n = samples.size(), m = r.sampleset->size();
+    loghyper = r.covf().get_loghyper();
+    // the factorization of the fork can be moved into a plain model whose
+    // first m samples are still those the refit started from
+    bool extend = typeid(*gp) == typeid(GaussianProcess) && n >= m
+      && !r.cf->loghyper_changed && !r.use_spectral;
+    for (size_t i = 0; extend && i < m; ++i) {
+      extend = samples.x()[i] == r.sampleset->x()[i];
+    }
+    if (extend) {
+      for (size_t i = 0; i < m; ++i) {
+        if (r.sampleset->y(i) != samples.y(i)) r.set_y(i, samples.y(i));
+      }
+      // samples that arrived during the refit extend the factor block-wise
+      if (n > m) {
+        Eigen::MatrixXd X(n - m, gp->get_input_dim());
+        Eigen::VectorXd y(n - m);
+        for (size_t i = m; i < n; ++i) {
+          X.row(i - m) = samples.x(i).transpose();
+          y(i - m) = samples.y(i);
+        }
+        r.add_patterns(X, y);
+      }
+      gp->cf->set_loghyper(loghyper);
+      gp->cf->loghyper_changed = false;
+      gp->L.swap(r.L);
+      gp->L_inv_y.swap(r.L_inv_y);
+      gp->alpha.swap(r.alpha);
+      gp->log_det_K = r.log_det_K;
+      gp->y_K_inv_y = r.y_K_inv_y;
+      gp->stats_need_update = r.stats_need_update;
+      gp->alpha_needs_update = r.alpha_needs_update;
+      gp->spectral.clear();
+      gp->mark_factorized();
+    } else {
+      // the model factorizes on next use
+      gp->covf().set_loghyper(loghyper);
+    }
+    refitted.reset();
+    m1.setZero();
+    m2.setZero();
+    t = 0;
+    refits++;
+  }
+}
@@ -0,0 +1,109 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "progressive.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace libgp {
+
+  Progressive::Progressive (const Optimizer & optimizer)
+    : optimizer(optimizer)
+  {
+    set_stages();
+  }
+
+  Progressive::~Progressive () {}
+
+  void Progressive::set_stages(size_t stages, size_t factor, size_t min_size)
+  {
+    if (stages == 0 || factor < 2) throw std::runtime_error("Invalid stages");
+    this->stages = stages;
+    this->factor = factor;
+    this->min_size = min_size;
+  }
+
+  double Progressive::maximize(GaussianProcess * gp, size_t n)
+  {
+    size_t size = gp->get_sampleset_size();
+    size_t input_dim = gp->get_input_dim();
+    Eigen::MatrixXd samples = gp->get_sampleset();
+    std::vector<size_t> order = stratified_order(samples.leftCols(input_dim));
+    // subset sizes from the smallest to the full dataset
+    sizes.clear();
+    values.clear();
+    size_t m = size;
+    for (size_t s = 1; s < stages; ++s) {
+      m /= factor;
+      if (m < min_size) break;
+      sizes.insert(sizes.begin(), m);
+    }
+    sizes.push_back(size);
+    // plain subset model, the samples are taken from get_sampleset()
+    std::unique_ptr<GaussianProcess> subset(gp->GaussianProcess::fork());
+    for (size_t s = 0; s < sizes.size(); ++s) {
+      GaussianProcess * stage = gp;
+      if (sizes[s] < size) {
+        // every k-th sample along the space-filling curve
+        Eigen::MatrixXd X(sizes[s], input_dim);
+        Eigen::VectorXd y(sizes[s]);
+        for (size_t i = 0; i < sizes[s]; ++i) {
+          size_t k = order[i * size / sizes[s]];
+          X.row(i) = samples.row(k).head(input_dim);
+          y(i) = samples(k, input_dim);
+        }
+        // warm start from the previous stage, the subset is factorized once
+        subset->clear_sampleset();
+        subset->covf().set_loghyper(gp->covf().get_loghyper());
+        subset->add_patterns(X, y);
+        stage = subset.get();
+      }
+      MarginalLikelihood objective(stage);
+      optimizer(&objective, n);
+      values.push_back(stage->log_likelihood());
+      if (stage != gp) gp->covf().set_loghyper(stage->covf().get_loghyper());
+    }
+    return values.back();
+  }
+
+  const std::vector<size_t> & Progressive::get_sizes()
+  {
+    return sizes;
+  }
+
+  const std::vector<double> & Progressive::get_values()
+  {
+    return values;
+  }
+
+  std::vector<size_t> Progressive::stratified_order(const Eigen::MatrixXd & X)
+  {
+    size_t n = X.rows();
+    int dims = std::min<int>(X.cols(), 64);
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = i;
+    if (n == 0 || dims == 0) return order;
+    int bits = std::min(16, 64 / dims);
+    Eigen::RowVectorXd lo = X.leftCols(dims).colwise().minCoeff();
+    Eigen::RowVectorXd range = X.leftCols(dims).colwise().maxCoeff() - lo;
+    double cells = (uint64_t(1) << bits) - 1;
+    // Morton code, the bits of the quantized inputs interleaved
+    std::vector<uint64_t> code(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+      for (int j = 0; j < dims; ++j) {
+        uint64_t q = range(j) > 0 ? uint64_t((X(i, j) - lo(j)) / range(j) * cells) : 0;
+        for (int b = 0; b < bits; ++b) {
+          code[i] |= ((q >> b) & 1) << (b * dims + j);
+        }
+      }
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return code[a] < code[b] || (code[a] == code[b] && a < b);
+    });
+    return order;
+  }
+}
@@ -24,15 +24,26 @@ void RProp::init(double eps_stop, double Delta0, double Deltamin, double Deltama
 
 void RProp::maximize(GaussianProcess * gp, size_t n, bool verbose)
 {
-  int param_dim = gp->covf().get_param_dim();
+  MarginalLikelihood objective(gp);
+  maximize(&objective, n, verbose);
+}
+
+void RProp::maximize(Objective * objective, size_t n, bool verbose)
+{
+  objective->clear_cache();
+  Eigen::VectorXd params = objective->get_loghyper();
+  int param_dim = params.size();
   Eigen::VectorXd Delta = Eigen::VectorXd::Ones(param_dim) * Delta0;
   Eigen::VectorXd grad_old = Eigen::VectorXd::Zero(param_dim);
-  Eigen::VectorXd params = gp->covf().get_loghyper();
+  Eigen::VectorXd grad;
+  // value and gradient of each point in one evaluation
+  double lik = objective->value_and_gradient(params, grad);
   Eigen::VectorXd best_params = params;
-  double best = log(0);
+  double best = lik;
+  start(lik);
 
   for (size_t i=0; i<n; ++i) {
-    Eigen::VectorXd grad = -gp->log_likelihood_gradient();
+    grad = -grad;
     grad_old = grad_old.cwiseProduct(grad);
     for (int j=0; j<grad_old.size(); ++j) {
       if (grad_old(j) > 0) {
@@ -44,16 +55,19 @@ void RProp::maximize(GaussianProcess * gp, size_t n, bool verbose)
       params(j) += -Utils::sign(grad(j)) * Delta(j);
     }
     grad_old = grad;
-    if (grad_old.norm() < eps_stop) break;
-    gp->covf().set_loghyper(params);
-    double lik = gp->log_likelihood();
+    if (grad_old.norm() < eps_stop) {
+      stopped(GRADIENT_NORM);
+      break;
+    }
+    lik = objective->value_and_gradient(params, grad);
     if (verbose) std::cout << i << " " << -lik << std::endl;
     if (lik > best) {
       best = lik;
       best_params = params;
     }
+    if (stop(i + 1, params, lik, grad)) break;
   }
-  gp->covf().set_loghyper(best_params);
+  objective->set_loghyper(best_params);
 }
 
 }
@@ -20,13 +20,9 @@ namespace libgp {
     input_dim = ss.input_dim;
     targets = ss.targets;
 
-    // deep copy needed for vector of pointers
-    for (size_t i=0; i<ss.inputs.size(); ++i)
-    {
-      Eigen::VectorXd * sample_to_store = new Eigen::VectorXd(input_dim);
-      *sample_to_store = *ss.inputs.at(i);
-      inputs.push_back(sample_to_store);
-    }
+    // input vectors are never modified and can be shared
+    inputs = ss.inputs;
+    storage = ss.storage;
   }
 
   SampleSet::~SampleSet() 
@@ -36,9 +32,10 @@ namespace libgp {
   
   void SampleSet::add(const double x[], double y)
   {
-    Eigen::VectorXd * v = new Eigen::VectorXd(input_dim);
+    std::shared_ptr<Eigen::VectorXd> v = std::make_shared<Eigen::VectorXd>(input_dim);
     for (size_t i=0; i<input_dim; ++i) (*v)(i) = x[i];
-    inputs.push_back(v);
+    storage.push_back(v);
+    inputs.push_back(v.get());
     targets.push_back(y);
     assert(inputs.size()==targets.size());
     n = inputs.size();
@@ -46,13 +43,21 @@ namespace libgp {
   
   void SampleSet::add(const Eigen::VectorXd x, double y)
   {
-    Eigen::VectorXd * v = new Eigen::VectorXd(x);
-    inputs.push_back(v);
+    std::shared_ptr<Eigen::VectorXd> v = std::make_shared<Eigen::VectorXd>(x);
+    storage.push_back(v);
+    inputs.push_back(v.get());
     targets.push_back(y);
     assert(inputs.size()==targets.size());
     n = inputs.size();
   }
   
+  void SampleSet::reserve(size_t n)
+  {
+    inputs.reserve(n);
+    storage.reserve(n);
+    targets.reserve(n);
+  }
+
   const Eigen::VectorXd & SampleSet::x(size_t k)
   {
     return *inputs.at(k);
@@ -68,6 +73,11 @@ namespace libgp {
     return targets;
   }
 
+  const std::vector<Eigen::VectorXd *>& SampleSet::x()
+  {
+    return inputs;
+  }
+
   bool SampleSet::set_y(size_t i, double y)
   {
     if (i>=n) return false;
@@ -82,10 +92,8 @@ namespace libgp {
   
   void SampleSet::clear()
   {
-    while (!inputs.empty()) {
-      delete inputs.back();
-      inputs.pop_back();
-    }    
+    inputs.clear();
+    storage.clear();
     n = 0;
     targets.clear();
   }
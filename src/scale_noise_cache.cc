@@ -0,0 +1,115 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "scale_noise_cache.h"
+
+#include <cmath>
+
+namespace libgp {
+
+  ScaleNoiseCache::ScaleNoiseCache ()
+  {
+    scale = noise = -1;
+    sf2 = s2 = 0;
+  }
+
+  ScaleNoiseCache::~ScaleNoiseCache () {}
+
+  Eigen::VectorXd ScaleNoiseCache::k0_params(CovarianceFunction & cf, int scale, int noise)
+  {
+    Eigen::VectorXd p = cf.get_loghyper();
+    if (scale >= 0) p(scale) = 0;
+    if (noise >= 0) p(noise) = 0;
+    return p;
+  }
+
+  bool ScaleNoiseCache::applicable(CovarianceFunction & cf, const Eigen::VectorXd & previous)
+  {
+    int scale, noise;
+    if (!cf.scale_noise_form(scale, noise)) return false;
+    if (previous.size() != static_cast<int>(cf.get_param_dim())) return false;
+    Eigen::VectorXd p = previous;
+    if (scale >= 0) p(scale) = 0;
+    if (noise >= 0) p(noise) = 0;
+    return p == k0_params(cf, scale, noise);
+  }
+
+  bool ScaleNoiseCache::valid(CovarianceFunction & cf, size_t n)
+  {
+    int s, e;
+    if (n == 0 || Q.rows() != static_cast<int>(n)) return false;
+    if (!cf.scale_noise_form(s, e) || s != scale || e != noise) return false;
+    return params == k0_params(cf, scale, noise);
+  }
+
+  void ScaleNoiseCache::decompose(CovarianceFunction & cf, SampleSet & samples, CovarianceFunction::Workspace & ws)
+  {
+    cf.scale_noise_form(scale, noise);
+    params = k0_params(cf, scale, noise);
+    Eigen::VectorXd p = cf.get_loghyper();
+    int n = samples.size();
+    // kernel matrix (lower triangle) with signal and noise level removed
+    Eigen::MatrixXd K0(n, n);
+    const Eigen::VectorXd * const * X = samples.x().data();
+    for (int i = 0; i < n; ++i) {
+      cf.get_row(*X[i], X + i, K0.col(i).segment(i, n - i), ws);
+    }
+    if (noise >= 0) K0.diagonal().array() -= exp(2 * p(noise));
+    if (scale >= 0) K0.triangularView<Eigen::Lower>() /= exp(2 * p(scale));
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(K0);
+    Q = solver.eigenvectors();
+    // K_0 is positive semidefinite up to rounding
+    lambda = solver.eigenvalues().cwiseMax(0);
+    set_scale_noise(cf);
+  }
+
+  void ScaleNoiseCache::set_scale_noise(CovarianceFunction & cf)
+  {
+    Eigen::VectorXd p = cf.get_loghyper();
+    sf2 = scale >= 0 ? exp(2 * p(scale)) : 0;
+    s2 = noise >= 0 ? exp(2 * p(noise)) : 0;
+    d = (sf2 * lambda).array() + s2;
+  }
+
+  bool ScaleNoiseCache::positive_definite() const
+  {
+    return d.size() > 0 && d.minCoeff() > 0;
+  }
+
+  void ScaleNoiseCache::clear()
+  {
+    Q.resize(0, 0);
+    lambda.resize(0);
+    d.resize(0);
+  }
+
+  void ScaleNoiseCache::solve(const Eigen::VectorXd & y, Eigen::VectorXd & alpha) const
+  {
+    alpha.noalias() = Q * (Q.transpose() * y).cwiseQuotient(d);
+  }
+
+  double ScaleNoiseCache::log_det() const
+  {
+    return d.array().log().sum();
+  }
+
+  double ScaleNoiseCache::quad_form(const Eigen::VectorXd & k) const
+  {
+    return ((Q.transpose() * k).array().square() / d.array()).sum();
+  }
+
+  Eigen::MatrixXd ScaleNoiseCache::inverse() const
+  {
+    return Q * d.cwiseInverse().asDiagonal() * Q.transpose();
+  }
+
+  void ScaleNoiseCache::gradient(const Eigen::VectorXd & y, double & scale_grad, double & noise_grad) const
+  {
+    // with a = Q^T alpha, dK/dlog(sf) = 2 sf^2 K_0 and dK/dlog(s) = 2 s^2 I
+    // the derivatives tr((alpha alpha^T - K^-1) dK) / 2 are diagonal in the eigenbasis
+    Eigen::ArrayXd a = (Q.transpose() * y).cwiseQuotient(d).array();
+    scale_grad = sf2 * (lambda.array() * (a.square() - d.array().inverse())).sum();
+    noise_grad = s2 * (a.square() - d.array().inverse()).sum();
+  }
+}
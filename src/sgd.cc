@@ -0,0 +1,93 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "sgd.h"
+#include "rprop.h"
+#include "cg.h"
+
+namespace libgp {
+
+void SGD::init(size_t batch_size, double learning_rate, double decay, bool adam, double beta1, double beta2)
+{
+  this->batch_size = batch_size;
+  this->learning_rate = learning_rate;
+  this->decay = decay;
+  this->adam = adam;
+  this->beta1 = beta1;
+  this->beta2 = beta2;
+  polish = NO_POLISH;
+  polish_n = 20;
+}
+
+void SGD::set_polish(Polish polish, size_t n)
+{
+  this->polish = polish;
+  polish_n = n;
+}
+
+void SGD::seed(unsigned int seed)
+{
+  rng.seed(seed);
+}
+
+void SGD::maximize(GaussianProcess * gp, size_t n, bool verbose)
+{
+  size_t size = gp->get_sampleset_size();
+  Eigen::MatrixXd samples = gp->get_sampleset();
+  size_t input_dim = gp->get_input_dim();
+  size_t m = std::min(batch_size, size);
+  // plain subset model with the covariance function of gp
+  std::unique_ptr<GaussianProcess> subset(gp->GaussianProcess::fork());
+  subset->clear_sampleset();
+  std::vector<size_t> index(size);
+  for (size_t i = 0; i < size; ++i) index[i] = i;
+  Eigen::VectorXd params = gp->covf().get_loghyper();
+  int param_dim = params.size();
+  Eigen::VectorXd m1 = Eigen::VectorXd::Zero(param_dim), m2 = Eigen::VectorXd::Zero(param_dim);
+  Eigen::MatrixXd X(m, input_dim);
+  Eigen::VectorXd y(m);
+  for (size_t t = 1; t <= n && m > 0; ++t) {
+    // random subset without replacement (partial Fisher-Yates shuffle)
+    for (size_t i = 0; i < m; ++i) {
+      std::uniform_int_distribution<size_t> pick(i, size - 1);
+      std::swap(index[i], index[pick(rng)]);
+      X.row(i) = samples.row(index[i]).head(input_dim);
+      y(i) = samples(index[i], input_dim);
+    }
+    // factorize the subset once at the current parameters
+    subset->clear_sampleset();
+    subset->covf().set_loghyper(params);
+    subset->add_patterns(X, y);
+    // gradient per sample, the estimate of the full gradient is size times larger
+    Eigen::VectorXd grad = subset->log_likelihood_gradient() / m;
+    if (!grad.allFinite()) continue;
+    m1 = beta1 * m1 + (1 - beta1) * grad;
+    double rate = learning_rate / (1 + decay * (t - 1));
+    if (adam) {
+      m2 = beta2 * m2 + (1 - beta2) * grad.cwiseAbs2();
+      Eigen::VectorXd m1_hat = m1 / (1 - std::pow(beta1, t));
+      Eigen::VectorXd m2_hat = m2 / (1 - std::pow(beta2, t));
+      params += rate * m1_hat.cwiseQuotient((m2_hat.cwiseSqrt().array() + 1e-8).matrix());
+    } else {
+      params += rate * m1;
+    }
+    if (verbose) std::cout << t << " " << -subset->log_likelihood() * size / m << std::endl;
+  }
+  gp->covf().set_loghyper(params);
+  if (polish == POLISH_RPROP) {
+    RProp rprop;
+    rprop.maximize(gp, polish_n, verbose);
+  } else if (polish == POLISH_CG) {
+    CG cg;
+    cg.maximize(gp, polish_n, verbose);
+  }
+}
+
+}
@@ -0,0 +1,108 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "simd_math.h"
+
+#include <atomic>
+#include <cmath>
+
+namespace libgp {
+namespace simd {
+
+#ifdef LIBGP_SIMD_X86
+  // defined in simd_math_avx2.cc and simd_math_avx512.cc
+  void exp_avx2(const double x[], double y[], size_t n);
+  void log_avx2(const double x[], double y[], size_t n);
+  void sin_avx2(const double x[], double y[], size_t n);
+  void exp_avx512(const double x[], double y[], size_t n);
+  void log_avx512(const double x[], double y[], size_t n);
+  void sin_avx512(const double x[], double y[], size_t n);
+#endif
+
+  namespace {
+
+    void exp_scalar(const double x[], double y[], size_t n)
+    {
+      for (size_t i = 0; i < n; ++i) y[i] = std::exp(x[i]);
+    }
+
+    void log_scalar(const double x[], double y[], size_t n)
+    {
+      for (size_t i = 0; i < n; ++i) y[i] = std::log(x[i]);
+    }
+
+    void sin_scalar(const double x[], double y[], size_t n)
+    {
+      for (size_t i = 0; i < n; ++i) y[i] = std::sin(x[i]);
+    }
+
+    struct Functions
+    {
+      Isa isa;
+      void (*exp)(const double x[], double y[], size_t n);
+      void (*log)(const double x[], double y[], size_t n);
+      void (*sin)(const double x[], double y[], size_t n);
+    };
+
+    const Functions functions[] = {
+      {SCALAR, exp_scalar, log_scalar, sin_scalar},
+#ifdef LIBGP_SIMD_X86
+      {AVX2, exp_avx2, log_avx2, sin_avx2},
+      {AVX512, exp_avx512, log_avx512, sin_avx512},
+#endif
+    };
+
+    std::atomic<const Functions *> selected(NULL);
+
+    const Functions * current()
+    {
+      const Functions * f = selected.load(std::memory_order_relaxed);
+      if (f == NULL) {
+        f = &functions[best_isa()];
+        selected.store(f, std::memory_order_relaxed);
+      }
+      return f;
+    }
+  }
+
+  Isa best_isa()
+  {
+#ifdef LIBGP_SIMD_X86
+    static const Isa best = __builtin_cpu_supports("avx512f") ? AVX512
+                          : __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? AVX2
+                          : SCALAR;
+    return best;
+#else
+    return SCALAR;
+#endif
+  }
+
+  Isa get_isa()
+  {
+    return current()->isa;
+  }
+
+  bool set_isa(Isa isa)
+  {
+    if (isa > best_isa()) return false;
+    selected.store(&functions[isa], std::memory_order_relaxed);
+    return true;
+  }
+
+  void exp(const double x[], double y[], size_t n)
+  {
+    current()->exp(x, y, n);
+  }
+
+  void log(const double x[], double y[], size_t n)
+  {
+    current()->log(x, y, n);
+  }
+
+  void sin(const double x[], double y[], size_t n)
+  {
+    current()->sin(x, y, n);
+  }
+}
+}
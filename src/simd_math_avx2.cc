@@ -0,0 +1,93 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+// Compiled with -mavx2 -mfma, only called after a runtime check.
+
+#include <immintrin.h>
+
+#include "simd_math_kernels.h"
+
+namespace libgp {
+namespace simd {
+
+  namespace {
+
+    struct Avx2
+    {
+      typedef __m256d Reg;
+      typedef __m256d Mask;
+      static constexpr size_t width = 4;
+
+      static Reg set1(double a) { return _mm256_set1_pd(a); }
+      static Reg load(const double * p) { return _mm256_loadu_pd(p); }
+      static void store(double * p, Reg a) { _mm256_storeu_pd(p, a); }
+      static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+      static Reg sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+      static Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+      static Reg div(Reg a, Reg b) { return _mm256_div_pd(a, b); }
+      static Reg fmadd(Reg a, Reg b, Reg c) { return _mm256_fmadd_pd(a, b, c); }
+      static Reg min(Reg a, Reg b) { return _mm256_min_pd(a, b); }
+      static Reg max(Reg a, Reg b) { return _mm256_max_pd(a, b); }
+      static Reg neg(Reg a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+      static Reg abs(Reg a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+      static Reg round(Reg a) { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+      static Mask lt(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+      static Mask gt(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+      static Mask eq(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+      static Mask unord(Reg a) { return _mm256_cmp_pd(a, a, _CMP_UNORD_Q); }
+      static bool any(Mask m) { return _mm256_movemask_pd(m) != 0; }
+      /** a where m is set, b otherwise */
+      static Reg select(Mask m, Reg a, Reg b) { return _mm256_blendv_pd(b, a, m); }
+
+      /** 2^k for integral k in [-1022, 1023] */
+      static Reg pow2i(Reg k)
+      {
+        __m256i bits = _mm256_castpd_si256(_mm256_add_pd(k, _mm256_set1_pd(0x1p52 + 1023)));
+        return _mm256_castsi256_pd(_mm256_slli_epi64(bits, 52));
+      }
+
+      /** Unbiased exponent of a positive normal number. */
+      static Reg exponent(Reg a)
+      {
+        __m256i bits = _mm256_srli_epi64(_mm256_castpd_si256(a), 52);
+        bits = _mm256_or_si256(bits, _mm256_castpd_si256(_mm256_set1_pd(0x1p52)));
+        return _mm256_sub_pd(_mm256_castsi256_pd(bits), _mm256_set1_pd(0x1p52 + 1023));
+      }
+
+      /** Significand in [1, 2) of a positive normal number. */
+      static Reg mantissa(Reg a)
+      {
+        __m256i bits = _mm256_and_si256(_mm256_castpd_si256(a), _mm256_set1_epi64x(0x000fffffffffffffLL));
+        return _mm256_castsi256_pd(_mm256_or_si256(bits, _mm256_set1_epi64x(0x3ff0000000000000LL)));
+      }
+
+      /** Test bit b of the two's complement of integral k with |k| < 2^51. */
+      static Mask bit_set(Reg k, int b)
+      {
+        __m256i bits = _mm256_castpd_si256(_mm256_add_pd(k, _mm256_set1_pd(0x1.8p52)));
+        __m256i bit = _mm256_set1_epi64x(1LL << b);
+        return _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(bits, bit), bit));
+      }
+    };
+
+    typedef Kernels<Avx2> K;
+  }
+
+  void exp_avx2(const double x[], double y[], size_t n)
+  {
+    K::apply<K::exp>(x, y, n);
+  }
+
+  void log_avx2(const double x[], double y[], size_t n)
+  {
+    K::apply<K::log>(x, y, n);
+  }
+
+  void sin_avx2(const double x[], double y[], size_t n)
+  {
+    K::apply_sin(x, y, n);
+  }
+}
+}
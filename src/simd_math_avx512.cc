@@ -0,0 +1,109 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+// Compiled with -mavx512f, only called after a runtime check.
+
+// GCC reports the undefined vectors its own avx512fintrin.h passes to the
+// builtins as possibly uninitialized when they are inlined here.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+#include "simd_math_kernels.h"
+
+namespace libgp {
+namespace simd {
+
+  namespace {
+
+    struct Avx512
+    {
+      typedef __m512d Reg;
+      typedef __mmask8 Mask;
+      static constexpr size_t width = 8;
+
+      static Reg set1(double a) { return _mm512_set1_pd(a); }
+      static Reg load(const double * p) { return _mm512_loadu_pd(p); }
+      static void store(double * p, Reg a) { _mm512_storeu_pd(p, a); }
+      static Reg add(Reg a, Reg b) { return _mm512_add_pd(a, b); }
+      static Reg sub(Reg a, Reg b) { return _mm512_sub_pd(a, b); }
+      static Reg mul(Reg a, Reg b) { return _mm512_mul_pd(a, b); }
+      static Reg div(Reg a, Reg b) { return _mm512_div_pd(a, b); }
+      static Reg fmadd(Reg a, Reg b, Reg c) { return _mm512_fmadd_pd(a, b, c); }
+      static Reg min(Reg a, Reg b) { return _mm512_min_pd(a, b); }
+      static Reg max(Reg a, Reg b) { return _mm512_max_pd(a, b); }
+      static Reg neg(Reg a)
+      {
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(1ULL << 63)));
+      }
+      static Reg abs(Reg a)
+      {
+        return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(~(1ULL << 63))));
+      }
+      static Reg round(Reg a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+      static Mask lt(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+      static Mask gt(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+      static Mask eq(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+      static Mask unord(Reg a) { return _mm512_cmp_pd_mask(a, a, _CMP_UNORD_Q); }
+      static bool any(Mask m) { return m != 0; }
+      /** a where m is set, b otherwise */
+      static Reg select(Mask m, Reg a, Reg b) { return _mm512_mask_blend_pd(m, b, a); }
+
+      /** 2^k for integral k in [-1022, 1023] */
+      static Reg pow2i(Reg k)
+      {
+        __m512i bits = _mm512_castpd_si512(_mm512_add_pd(k, _mm512_set1_pd(0x1p52 + 1023)));
+        return _mm512_castsi512_pd(_mm512_slli_epi64(bits, 52));
+      }
+
+      /** Unbiased exponent of a positive normal number. */
+      static Reg exponent(Reg a)
+      {
+        __m512i bits = _mm512_srli_epi64(_mm512_castpd_si512(a), 52);
+        bits = _mm512_or_si512(bits, _mm512_castpd_si512(_mm512_set1_pd(0x1p52)));
+        return _mm512_sub_pd(_mm512_castsi512_pd(bits), _mm512_set1_pd(0x1p52 + 1023));
+      }
+
+      /** Significand in [1, 2) of a positive normal number. */
+      static Reg mantissa(Reg a)
+      {
+        __m512i bits = _mm512_and_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(0x000fffffffffffffLL));
+        return _mm512_castsi512_pd(_mm512_or_si512(bits, _mm512_set1_epi64(0x3ff0000000000000LL)));
+      }
+
+      /** Test bit b of the two's complement of integral k with |k| < 2^51. */
+      static Mask bit_set(Reg k, int b)
+      {
+        __m512i bits = _mm512_castpd_si512(_mm512_add_pd(k, _mm512_set1_pd(0x1.8p52)));
+        return _mm512_test_epi64_mask(bits, _mm512_set1_epi64(1LL << b));
+      }
+    };
+
+    typedef Kernels<Avx512> K;
+  }
+
+  void exp_avx512(const double x[], double y[], size_t n)
+  {
+    K::apply<K::exp>(x, y, n);
+  }
+
+  void log_avx512(const double x[], double y[], size_t n)
+  {
+    K::apply<K::log>(x, y, n);
+  }
+
+  void sin_avx512(const double x[], double y[], size_t n)
+  {
+    K::apply_sin(x, y, n);
+  }
+}
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,168 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+// Vectorized exp, log and sin, generic over the register operations V.
+// This header is included by translation units compiled for a specific
+// instruction set. It must not pull in Eigen or the C++ standard library:
+// inline functions instantiated there could be merged by the linker with
+// those of the portable translation units.
+
+#ifndef __SIMD_MATH_KERNELS_H__
+#define __SIMD_MATH_KERNELS_H__
+
+#include <cstddef>
+
+namespace libgp {
+namespace simd {
+namespace {
+
+  template <class V> struct Kernels
+  {
+    typedef typename V::Reg Reg;
+    typedef typename V::Mask Mask;
+
+    static Reg exp(Reg x)
+    {
+      const Reg hi = V::set1(709.782712893383973096);
+      const Reg lo = V::set1(-708.0);
+      Reg xc = V::min(V::max(x, lo), hi);
+      // x = k ln2 + r with |r| <= ln2/2, ln2_hi has 32 trailing zero bits
+      Reg k = V::round(V::mul(xc, V::set1(1.44269504088896338700e+00)));
+      Reg r = V::sub(xc, V::mul(k, V::set1(6.93147180369123816490e-01)));
+      r = V::sub(r, V::mul(k, V::set1(1.90821492927058770002e-10)));
+      // taylor polynomial of degree 13, truncation error below 0.05 ulp
+      Reg p = V::set1(1.0 / 6227020800.0);
+      p = V::fmadd(p, r, V::set1(1.0 / 479001600.0));
+      p = V::fmadd(p, r, V::set1(1.0 / 39916800.0));
+      p = V::fmadd(p, r, V::set1(1.0 / 3628800.0));
+      p = V::fmadd(p, r, V::set1(1.0 / 362880.0));
+      p = V::fmadd(p, r, V::set1(1.0 / 40320.0));
+      p = V::fmadd(p, r, V::set1(1.0 / 5040.0));
+      p = V::fmadd(p, r, V::set1(1.0 / 720.0));
+      p = V::fmadd(p, r, V::set1(1.0 / 120.0));
+      p = V::fmadd(p, r, V::set1(1.0 / 24.0));
+      p = V::fmadd(p, r, V::set1(1.0 / 6.0));
+      p = V::fmadd(p, r, V::set1(0.5));
+      p = V::fmadd(p, r, V::set1(1.0));
+      p = V::fmadd(p, r, V::set1(1.0));
+      // k <= 1024 is split to stay within the range of normal numbers
+      Reg y = V::mul(V::mul(p, V::pow2i(V::sub(k, V::set1(1.0)))), V::set1(2.0));
+      y = V::select(V::lt(x, lo), V::set1(0.0), y);
+      y = V::select(V::gt(x, hi), V::set1(__builtin_inf()), y);
+      return V::select(V::unord(x), x, y);
+    }
+
+    static Reg log(Reg x)
+    {
+      // scale subnormal numbers into the normal range
+      Mask sub = V::lt(x, V::set1(2.2250738585072014e-308));
+      Reg xs = V::select(sub, V::mul(x, V::set1(18014398509481984.0)), x);
+      Reg e = V::select(sub, V::sub(V::exponent(xs), V::set1(54.0)), V::exponent(xs));
+      // x = 2^e m with sqrt(1/2) <= m < sqrt(2)
+      Reg m = V::mantissa(xs);
+      Mask big = V::gt(m, V::set1(1.41421356237309504880));
+      m = V::select(big, V::mul(m, V::set1(0.5)), m);
+      e = V::select(big, V::add(e, V::set1(1.0)), e);
+      // log(m) = 2 atanh(f) = 2f + f s (2/3 + 2/5 s + ...) with f = (m-1)/(m+1)
+      Reg f = V::div(V::sub(m, V::set1(1.0)), V::add(m, V::set1(1.0)));
+      Reg s = V::mul(f, f);
+      Reg p = V::set1(2.0 / 25.0);
+      p = V::fmadd(p, s, V::set1(2.0 / 23.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 21.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 19.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 17.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 15.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 13.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 11.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 9.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 7.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 5.0));
+      p = V::fmadd(p, s, V::set1(2.0 / 3.0));
+      Reg r = V::fmadd(e, V::set1(1.90821492927058770002e-10), V::mul(V::mul(f, s), p));
+      r = V::add(V::add(f, f), r);
+      Reg y = V::fmadd(e, V::set1(6.93147180369123816490e-01), r);
+      // special values
+      y = V::select(V::eq(x, V::set1(__builtin_inf())), x, y);
+      y = V::select(V::eq(x, V::set1(0.0)), V::set1(-__builtin_inf()), y);
+      y = V::select(V::lt(x, V::set1(0.0)), V::set1(__builtin_nan("")), y);
+      return V::select(V::unord(x), x, y);
+    }
+
+    /** Valid for |x| < 2^19, see needs_libm_sin(). */
+    static Reg sin(Reg x)
+    {
+      // x = k pi/2 + r with |r| <= pi/4, pi/2 is split into parts of
+      // 33 bits so that k pio2_i is exact for |k| < 2^20
+      Reg k = V::round(V::mul(x, V::set1(6.36619772367581382433e-01)));
+      Reg r = V::sub(x, V::mul(k, V::set1(1.57079632673412561417e+00)));
+      r = V::sub(r, V::mul(k, V::set1(6.07710050630396597660e-11)));
+      r = V::sub(r, V::mul(k, V::set1(2.02226624871116645580e-21)));
+      Reg z = V::mul(r, r);
+      // minimax polynomials of fdlibm's __kernel_sin and __kernel_cos
+      Reg ps = V::set1(1.58969099521155010221e-10);
+      ps = V::fmadd(ps, z, V::set1(-2.50507602534068634195e-08));
+      ps = V::fmadd(ps, z, V::set1(2.75573137070700676789e-06));
+      ps = V::fmadd(ps, z, V::set1(-1.98412698298579493134e-04));
+      ps = V::fmadd(ps, z, V::set1(8.33333333332248946124e-03));
+      ps = V::fmadd(ps, z, V::set1(-1.66666666666666324348e-01));
+      Reg sin_r = V::fmadd(V::mul(r, z), ps, r);
+      Reg pc = V::set1(-1.13596475577881948265e-11);
+      pc = V::fmadd(pc, z, V::set1(2.08757232129817482790e-09));
+      pc = V::fmadd(pc, z, V::set1(-2.75573143513906633035e-07));
+      pc = V::fmadd(pc, z, V::set1(2.48015872894767294178e-05));
+      pc = V::fmadd(pc, z, V::set1(-1.38888888888741095749e-03));
+      pc = V::fmadd(pc, z, V::set1(4.16666666666666019037e-02));
+      Reg hz = V::mul(V::set1(0.5), z);
+      Reg w = V::sub(V::set1(1.0), hz);
+      // 1 - hz is rounded, its error is added back
+      Reg cos_r = V::add(w, V::fmadd(V::mul(z, z), pc, V::sub(V::sub(V::set1(1.0), w), hz)));
+      // quadrant
+      Reg y = V::select(V::bit_set(k, 0), cos_r, sin_r);
+      return V::select(V::bit_set(k, 1), V::neg(y), y);
+    }
+
+    /** Arguments the reduction of sin() is not accurate for. */
+    static bool needs_libm_sin(Reg x)
+    {
+      Reg a = V::abs(x);
+      return V::any(V::gt(a, V::set1(524288.0))) || V::any(V::unord(a));
+    }
+
+    template <Reg (*F)(Reg)> static void apply(const double x[], double y[], size_t n)
+    {
+      size_t i = 0;
+      for (; i + V::width <= n; i += V::width) {
+        V::store(y + i, F(V::load(x + i)));
+      }
+      if (i < n) {
+        // pad the remainder with ones, a valid argument for all functions
+        double buf[V::width];
+        for (size_t j = 0; j < V::width; ++j) buf[j] = i + j < n ? x[i + j] : 1.0;
+        V::store(buf, F(V::load(buf)));
+        for (size_t j = 0; i + j < n; ++j) y[i + j] = buf[j];
+      }
+    }
+
+    static void apply_sin(const double x[], double y[], size_t n)
+    {
+      double buf[V::width];
+      for (size_t i = 0; i < n; i += V::width) {
+        size_t m = n - i < V::width ? n - i : V::width;
+        for (size_t j = 0; j < V::width; ++j) buf[j] = j < m ? x[i + j] : 1.0;
+        Reg xv = V::load(buf);
+        if (needs_libm_sin(xv)) {
+          for (size_t j = 0; j < m; ++j) y[i + j] = __builtin_sin(buf[j]);
+        } else {
+          V::store(buf, sin(xv));
+          for (size_t j = 0; j < m; ++j) y[i + j] = buf[j];
+        }
+      }
+    }
+  };
+
+}
+}
+}
+
+#endif /* __SIMD_MATH_KERNELS_H__ */
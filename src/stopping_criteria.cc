@@ -0,0 +1,101 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "stopping_criteria.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace libgp {
+
+  StoppingCriteria::StoppingCriteria ()
+    : time_limit(0), has_deadline(false), rel_improvement(0), gradient_norm(0),
+      started(std::chrono::steady_clock::now()), previous(0), reason(MAX_ITERATIONS) {}
+
+  StoppingCriteria::~StoppingCriteria () {}
+
+  void StoppingCriteria::set_time_limit(double seconds)
+  {
+    time_limit = seconds;
+  }
+
+  void StoppingCriteria::set_deadline(const std::chrono::steady_clock::time_point & deadline)
+  {
+    this->deadline = deadline;
+    has_deadline = true;
+  }
+
+  void StoppingCriteria::clear_deadline()
+  {
+    has_deadline = false;
+  }
+
+  void StoppingCriteria::set_tolerance(double rel_improvement, double gradient_norm)
+  {
+    this->rel_improvement = rel_improvement;
+    this->gradient_norm = gradient_norm;
+  }
+
+  void StoppingCriteria::set_callback(const Callback & callback)
+  {
+    this->callback = callback;
+  }
+
+  StoppingCriteria::Reason StoppingCriteria::get_stop_reason()
+  {
+    return reason;
+  }
+
+  void StoppingCriteria::start(double value)
+  {
+    started = std::chrono::steady_clock::now();
+    previous = value;
+    reason = MAX_ITERATIONS;
+  }
+
+  bool StoppingCriteria::out_of_time()
+  {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if ((time_limit > 0 && std::chrono::duration<double>(now - started).count() >= time_limit)
+        || (has_deadline && now >= deadline)) {
+      reason = TIME_LIMIT;
+      return true;
+    }
+    return false;
+  }
+
+  bool StoppingCriteria::stop(size_t iteration, const Eigen::VectorXd & loghyper, double value,
+                              const Eigen::VectorXd & gradient)
+  {
+    double norm = gradient.norm();
+    if (callback) {
+      OptimizerStats stats;
+      stats.iteration = iteration;
+      stats.loghyper = loghyper;
+      stats.value = value;
+      stats.gradient_norm = norm;
+      stats.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+      if (!callback(stats)) {
+        reason = CALLBACK;
+        return true;
+      }
+    }
+    double change = std::abs(value - previous);
+    previous = value;
+    if (rel_improvement > 0 && change <= rel_improvement * std::max(1.0, std::abs(value))) {
+      reason = RELATIVE_IMPROVEMENT;
+      return true;
+    }
+    if (gradient_norm > 0 && norm < gradient_norm) {
+      reason = GRADIENT_NORM;
+      return true;
+    }
+    return out_of_time();
+  }
+
+  void StoppingCriteria::stopped(Reason reason)
+  {
+    this->reason = reason;
+  }
+}
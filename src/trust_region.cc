@@ -0,0 +1,102 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <Eigen/Eigenvalues>
+
+#include "trust_region.h"
+
+namespace libgp {
+
+void TrustRegion::init(double radius, double radius_max, double eta, double eps_stop)
+{
+  this->radius = radius;
+  this->radius_max = radius_max;
+  this->eta = eta;
+  this->eps_stop = eps_stop;
+}
+
+Eigen::VectorXd TrustRegion::solve_subproblem(const Eigen::MatrixXd & B, const Eigen::VectorXd & g, double radius)
+{
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(B);
+  const Eigen::VectorXd & lambda = eig.eigenvalues();
+  const Eigen::MatrixXd & Q = eig.eigenvectors();
+  Eigen::VectorXd c = Q.transpose() * g;
+  // step -(B + mu I)^-1 g in the eigenbasis
+  auto step = [&](double mu) {
+    return Eigen::VectorXd(-c.array() / (lambda.array() + mu));
+  };
+  // Newton step if B is positive definite and the step is inside the region
+  if (lambda(0) > 0) {
+    Eigen::VectorXd p = step(0);
+    if (p.norm() <= radius) return Q * p;
+  }
+  double lo = std::max(0.0, -lambda(0));
+  double hi = lo + g.norm() / radius;
+  Eigen::VectorXd p = step(lo + 1e-12 * (1 + std::abs(lambda(0))));
+  if (lambda(0) <= 0 && p.norm() < radius) {
+    // hard case: g is orthogonal to the eigenvectors of the smallest eigenvalue
+    for (int i = 0; i < p.size(); ++i) {
+      if (lambda(i) - lambda(0) <= 1e-12 * (1 + std::abs(lambda(0)))) p(i) = 0;
+    }
+    p(0) = std::sqrt(std::max(0.0, radius * radius - p.squaredNorm()));
+    return Q * p;
+  }
+  // |p(mu)| = radius by bisection, |p(mu)| decreases with mu
+  for (int k = 0; k < 100 && hi - lo > 1e-12 * (1 + hi); ++k) {
+    double mu = 0.5 * (lo + hi);
+    if (step(mu).norm() > radius) lo = mu;
+    else hi = mu;
+  }
+  return Q * step(hi);
+}
+
+void TrustRegion::maximize(GaussianProcess * gp, size_t n, bool verbose)
+{
+  // minimize the negative log-likelihood F with gradient g and Hessian B
+  Eigen::VectorXd x = gp->covf().get_loghyper();
+  Eigen::VectorXd g;
+  Eigen::MatrixXd B;
+  double F = -gp->log_likelihood_hessian(g, B);
+  g = -g;
+  B = -B;
+  double delta = radius;
+  if (verbose) std::cout << 0 << " " << F << std::endl;
+  start(-F);
+
+  for (size_t i = 0; i < n; ++i) {
+    if (g.lpNorm<Eigen::Infinity>() < eps_stop) {
+      stopped(GRADIENT_NORM);
+      break;
+    }
+    Eigen::VectorXd p = solve_subproblem(B, g, delta);
+    double predicted = -(g.dot(p) + 0.5 * p.dot(B * p));
+    Eigen::VectorXd x_new = x + p;
+    gp->covf().set_loghyper(x_new);
+    double F_new = -gp->log_likelihood();
+    double rho = (F - F_new) / predicted;
+    // rho is NaN if the likelihood could not be evaluated
+    if (!(rho >= 0.25)) delta = 0.25 * p.norm();
+    else if (rho > 0.75 && p.norm() >= 0.99 * delta) delta = std::min(2 * delta, radius_max);
+    if (rho > eta && predicted > 0) {
+      // the factorization of the new point is reused
+      x = x_new;
+      F = -gp->log_likelihood_hessian(g, B);
+      g = -g;
+      B = -B;
+      if (verbose) std::cout << i + 1 << " " << F << std::endl;
+      if (stop(i + 1, x, -F, g)) break;
+    } else if (!(predicted > 0) || delta < 1e-10) {
+      stopped(NO_PROGRESS);
+      break;
+    } else if (out_of_time()) {
+      break;
+    }
+  }
+  gp->covf().set_loghyper(x);
+}
+
+}
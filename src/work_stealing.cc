@@ -0,0 +1,84 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "work_stealing.h"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libgp {
+
+  namespace {
+
+    struct TaskQueue
+    {
+      std::deque<size_t> tasks;
+      std::mutex lock;
+    };
+
+    bool pop_front(TaskQueue & queue, size_t & task)
+    {
+      std::lock_guard<std::mutex> guard(queue.lock);
+      if (queue.tasks.empty()) return false;
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+      return true;
+    }
+
+    bool pop_back(TaskQueue & queue, size_t & task)
+    {
+      std::lock_guard<std::mutex> guard(queue.lock);
+      if (queue.tasks.empty()) return false;
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+      return true;
+    }
+  }
+
+  size_t parallel_threads(size_t count, size_t threads)
+  {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    return std::max<size_t>(1, std::min(threads, count));
+  }
+
+  void parallel_for(size_t count, size_t threads, const std::function<void(size_t, size_t)> & task)
+  {
+    if (count == 0) return;
+    threads = parallel_threads(count, threads);
+    if (threads == 1) {
+      for (size_t i = 0; i < count; ++i) task(i, 0);
+      return;
+    }
+    std::vector<TaskQueue> queues(threads);
+    for (size_t i = 0; i < count; ++i) queues[i % threads].tasks.push_back(i);
+    std::exception_ptr error;
+    std::mutex error_lock;
+    // no tasks are added while running, a thread stops once all queues are empty
+    auto worker = [&](size_t t) {
+      size_t i;
+      for (;;) {
+        bool found = pop_front(queues[t], i);
+        for (size_t s = 1; !found && s < threads; ++s) {
+          found = pop_back(queues[(t + s) % threads], i);
+        }
+        if (!found) return;
+        try {
+          task(i, t);
+        } catch (...) {
+          std::lock_guard<std::mutex> guard(error_lock);
+          if (!error) error = std::current_exception();
+        }
+      }
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) pool.push_back(std::thread(worker, t));
+    worker(0);
+    for (size_t t = 0; t < pool.size(); ++t) pool[t].join();
+    if (error) std::rethrow_exception(error);
+  }
+}
@@ -0,0 +1,32 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#ifndef __SAMPLE_GP_H__
+#define __SAMPLE_GP_H__
+
+#include "gp.h"
+#include "gp_utils.h"
+
+#include <Eigen/Dense>
+#include <cmath>
+
+/** Create a 2-d GP with n samples drawn from a squared exponential
+ *  with unit length-scale and signal variance plus Gaussian noise with
+ *  the given standard deviation. The noise is added to the targets, as
+ *  draw_random_sample() evaluates CovNoise on distinct inputs only.
+ *  The inputs are uniform in [-range, range]^2. */
+inline libgp::GaussianProcess * create_sample_gp(int n, double noise, double range = 5)
+{
+  libgp::GaussianProcess * gp = new libgp::GaussianProcess(2, "CovSum ( CovSEiso, CovNoise)");
+  Eigen::VectorXd params(3);
+  params << 0, 0, log(noise);
+  gp->covf().set_loghyper(params);
+  Eigen::MatrixXd X = range * Eigen::MatrixXd::Random(n, 2);
+  Eigen::VectorXd y = gp->covf().draw_random_sample(X);
+  for (int i = 0; i < n; ++i) y(i) += noise * libgp::Utils::randn();
+  gp->add_patterns(X, y);
+  return gp;
+}
+
+#endif /* __SAMPLE_GP_H__ */
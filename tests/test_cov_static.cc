@@ -0,0 +1,115 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "cov_factory.h"
+#include "cov_static.h"
+#include "cov_sum.h"
+#include "cov_prod.h"
+
+#include <cmath>
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace libgp;
+
+// compare covariance, gradient and kernel rows of two covariance functions
+static void compare(CovarianceFunction * expected, CovarianceFunction * actual, int input_dim)
+{
+  ASSERT_EQ(expected->to_string(), actual->to_string());
+  ASSERT_EQ(expected->get_param_dim(), actual->get_param_dim());
+  Eigen::VectorXd params = Eigen::VectorXd::Random(expected->get_param_dim());
+  expected->set_loghyper(params);
+  actual->set_loghyper(params);
+  Eigen::VectorXd g1(params.size()), g2(params.size());
+  for (int i = 0; i < 20; ++i) {
+    Eigen::VectorXd x1 = Eigen::VectorXd::Random(input_dim);
+    Eigen::VectorXd x2 = Eigen::VectorXd::Random(input_dim);
+    ASSERT_NEAR(expected->get(x1, x2), actual->get(x1, x2), 1e-12);
+    ASSERT_NEAR(expected->get(x1, x1), actual->get(x1, x1), 1e-12);
+    expected->grad(x1, x2, g1);
+    actual->grad(x1, x2, g2);
+    for (int j = 0; j < params.size(); ++j) ASSERT_NEAR(g1(j), g2(j), 1e-12);
+    expected->grad(x1, x1, g1);
+    actual->grad(x1, x1, g2);
+    for (int j = 0; j < params.size(); ++j) ASSERT_NEAR(g1(j), g2(j), 1e-12);
+    // analytic second derivatives
+    Eigen::MatrixXd h1(params.size(), params.size()), h2(params.size(), params.size());
+    for (const Eigen::VectorXd * x : {&x2, &x1}) {
+      expected->hessian(x1, *x, h1);
+      actual->hessian(x1, *x, h2);
+      for (int j = 0; j < params.size(); ++j) {
+        for (int l = 0; l < params.size(); ++l) ASSERT_NEAR(h1(j, l), h2(j, l), 1e-12 * (1 + std::abs(h1(j, l))));
+      }
+    }
+  }
+  // kernel rows, the first vector is compared to itself
+  std::vector<Eigen::VectorXd> X(9, Eigen::VectorXd(input_dim));
+  std::vector<const Eigen::VectorXd *> ptr;
+  for (size_t i = 0; i < X.size(); ++i) {
+    X[i].setRandom();
+    ptr.push_back(&X[i]);
+  }
+  CovarianceFunction::Workspace ws;
+  Eigen::VectorXd k(X.size());
+  actual->get_row(X[0], ptr.data(), k, ws);
+  for (size_t i = 0; i < X.size(); ++i) ASSERT_NEAR(expected->get(X[0], X[i]), k(i), 1e-12);
+  // rows from squared distances, computed in place
+  ASSERT_EQ(expected->supports_distances(), actual->supports_distances());
+  if (actual->supports_distances()) {
+    for (size_t i = 0; i < X.size(); ++i) k(i) = (X[0] - X[i]).squaredNorm();
+    ASSERT_TRUE(actual->get_row_from_distances(k, true, k, ws));
+    for (size_t i = 0; i < X.size(); ++i) ASSERT_NEAR(expected->get(X[0], X[i]), k(i), 1e-12);
+  }
+}
+
+template <class Composite>
+static void compare_to_tree(std::string first, std::string second, int input_dim)
+{
+  CovFactory factory;
+  Composite * tree = new Composite();
+  tree->init(input_dim, factory.create(input_dim, first), factory.create(input_dim, second));
+  CovarianceFunction * covf = factory.create(input_dim, tree->to_string());
+  compare(tree, covf, input_dim);
+  delete covf;
+  delete tree;
+}
+
+TEST(CovStaticTest, FactoryMatchesTree) {
+  const char * kernels[] = {"CovSEiso", "CovSEard", "CovMatern3iso", "CovMatern5iso",
+                            "CovRQiso", "CovLinearone"};
+  // fixed dimension and dynamic instances
+  int dims[] = {1, 3, max_fixed_dim + 4};
+  for (int input_dim : dims) {
+    for (const char * kernel : kernels) {
+      compare_to_tree<CovSum>(kernel, "CovNoise", input_dim);
+    }
+    compare_to_tree<CovSum>("CovSum(CovSEiso, CovLinearone)", "CovNoise", input_dim);
+    compare_to_tree<CovSum>("CovProd(CovSEiso, CovLinearone)", "CovNoise", input_dim);
+    if (input_dim > 1) {
+      compare_to_tree<CovSum>("CovSum(InputDimFilter(0/CovSEiso), InputDimFilter(1/CovSEiso))", "CovNoise", input_dim);
+    }
+  }
+}
+
+TEST(CovStaticTest, Filter) {
+  CovFactory factory;
+  CovarianceFunction * tree = factory.create(3, "CovProd(InputDimFilter(1/CovSEiso), InputDimFilter(2/CovMatern5iso))");
+  CovStatic<expr::Prod<expr::Filter<1, expr::SEiso>, expr::Filter<2, expr::Matern5iso> > > covf;
+  covf.init(3);
+  compare(tree, &covf, 3);
+  delete tree;
+}
+
+TEST(CovStaticTest, FactoryBuildsFilter) {
+  typedef expr::Sum<expr::Sum<expr::Filter<0, expr::SEiso>, expr::Filter<1, expr::SEiso> >, expr::Noise> Additive;
+  CovFactory factory;
+  CovarianceFunction * covf = factory.create(3, Additive().to_string());
+  EXPECT_TRUE((dynamic_cast<CovStaticFixed<Additive, 3> *>(covf) != NULL));
+  delete covf;
+  // the second filter needs two inputs
+  CovStatic<Additive> unsupported;
+  EXPECT_FALSE(unsupported.init(1));
+}
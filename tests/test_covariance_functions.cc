@@ -3,10 +3,216 @@
 // All rights reserved.
 
 #include "cov_factory.h"
+#include "cov_sum.h"
+#include "simd_math.h"
 
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <typeinfo>
 #include <Eigen/Dense>
 #include <gtest/gtest.h>
 
+// distance of two doubles in units in the last place
+static double ulp_distance(double a, double b)
+{
+  if (a == b || (std::isnan(a) && std::isnan(b))) return 0;
+  int64_t i, j;
+  std::memcpy(&i, &a, sizeof(a));
+  std::memcpy(&j, &b, sizeof(b));
+  if (i < 0) i = INT64_MIN - i;
+  if (j < 0) j = INT64_MIN - j;
+  return double(i > j ? uint64_t(i) - uint64_t(j) : uint64_t(j) - uint64_t(i));
+}
+
+TEST(SimdMathTest, EqualToScalar) {
+  int n = 10003;
+  Eigen::VectorXd u = Eigen::VectorXd::Random(n);
+  Eigen::VectorXd x_exp = 700 * u;
+  Eigen::VectorXd x_log = (300 * u).unaryExpr([](double v) { return std::pow(10.0, v); });
+  Eigen::VectorXd x_sin = 1000 * u;
+  x_sin.head(100) *= 1000;
+  Eigen::VectorXd y(n);
+  libgp::simd::Isa best = libgp::simd::best_isa();
+  for (int isa = libgp::simd::SCALAR; isa <= best; ++isa) {
+    ASSERT_TRUE(libgp::simd::set_isa(libgp::simd::Isa(isa)));
+    libgp::simd::exp(x_exp.data(), y.data(), n);
+    for (int i = 0; i < n; ++i) ASSERT_LE(ulp_distance(y(i), std::exp(x_exp(i))), 2) << x_exp(i);
+    libgp::simd::log(x_log.data(), y.data(), n);
+    for (int i = 0; i < n; ++i) ASSERT_LE(ulp_distance(y(i), std::log(x_log(i))), 2) << x_log(i);
+    libgp::simd::sin(x_sin.data(), y.data(), n);
+    for (int i = 0; i < n; ++i) ASSERT_LE(ulp_distance(y(i), std::sin(x_sin(i))), 3) << x_sin(i);
+    // special values
+    double special[] = {0.0, -0.0, INFINITY, -INFINITY, NAN, -1.0, 4.9e-324, 1e6};
+    double result[8];
+    libgp::simd::exp(special, result, 8);
+    for (int i = 0; i < 8; ++i) ASSERT_EQ(0, ulp_distance(result[i], std::exp(special[i]))) << special[i];
+    libgp::simd::log(special, result, 8);
+    for (int i = 0; i < 8; ++i) ASSERT_EQ(0, ulp_distance(result[i], std::log(special[i]))) << special[i];
+    libgp::simd::sin(special, result, 8);
+    for (int i = 0; i < 8; ++i) ASSERT_EQ(0, ulp_distance(result[i], std::sin(special[i]))) << special[i];
+  }
+  libgp::simd::set_isa(best);
+}
+
+TEST(RowTest, EqualToGet) {
+  const char * kernels[] = {
+    "CovLinearard", "CovMatern3iso", "CovMatern5iso", "CovPeriodic", "CovPeriodicMatern3iso",
+    "CovRQiso", "CovSEard", "CovSEiso", "CovProd(CovSum(CovSEard, CovNoise), CovRQiso)",
+    "CovSum(CovMatern5iso, CovNoise)", "InputDimFilter(1/CovPeriodic)"};
+  libgp::CovFactory factory;
+  libgp::CovarianceFunction::Workspace ws;
+  libgp::simd::Isa best = libgp::simd::best_isa();
+  // fixed dimension and generic implementations
+  for (int input_dim : {3, 10}) {
+    std::vector<Eigen::VectorXd> X(37, Eigen::VectorXd(input_dim));
+    std::vector<const Eigen::VectorXd *> ptr;
+    for (size_t i = 0; i < X.size(); ++i) {
+      X[i].setRandom();
+      ptr.push_back(&X[i]);
+    }
+    Eigen::VectorXd k(X.size());
+    for (int isa = libgp::simd::SCALAR; isa <= best; ++isa) {
+      libgp::simd::set_isa(libgp::simd::Isa(isa));
+      for (const char * kernel : kernels) {
+        libgp::CovarianceFunction * covf = factory.create(input_dim, kernel);
+        covf->set_loghyper(Eigen::VectorXd::Random(covf->get_param_dim()));
+        // the fifth vector is compared to itself
+        covf->get_row(X[4], ptr.data(), k, ws);
+        for (size_t i = 0; i < X.size(); ++i) {
+          double expected = covf->get(X[4], X[i]);
+          ASSERT_NEAR(expected, k(i), 1e-13 * std::max(1.0, std::fabs(expected))) << kernel;
+        }
+        delete covf;
+      }
+    }
+  }
+  libgp::simd::set_isa(best);
+}
+
+TEST(CloneTest, EqualToOriginal) {
+  const char * kernels[] = {
+    "CovLinearard", "CovLinearone", "CovMatern3iso", "CovMatern5iso", "CovNoise",
+    "CovPeriodic", "CovPeriodicMatern3iso", "CovRQiso", "CovSEard", "CovSEiso",
+    "CovSum(CovSEiso, CovNoise)", "CovProd(CovSum(CovSEard, CovNoise), CovRQiso)",
+    "InputDimFilter(1/CovSum(CovSEiso, CovNoise))"};
+  libgp::CovFactory factory;
+  // fixed dimension and generic implementations
+  for (int input_dim : {3, 10}) {
+    Eigen::VectorXd x1 = Eigen::VectorXd::Random(input_dim), x2 = Eigen::VectorXd::Random(input_dim);
+    for (const char * kernel : kernels) {
+      libgp::CovarianceFunction * covf = factory.create(input_dim, kernel);
+      Eigen::VectorXd params = Eigen::VectorXd::Random(covf->get_param_dim());
+      covf->set_loghyper(params);
+      libgp::CovarianceFunction * copy = covf->clone();
+      ASSERT_EQ(typeid(*covf), typeid(*copy)) << kernel;
+      ASSERT_EQ(covf->to_string(), copy->to_string());
+      ASSERT_EQ(params, copy->get_loghyper());
+      ASSERT_EQ(covf->get(x1, x2), copy->get(x1, x2)) << kernel;
+      ASSERT_EQ(covf->get(x1, x1), copy->get(x1, x1)) << kernel;
+      Eigen::VectorXd g1(params.size()), g2(params.size());
+      covf->grad(x1, x2, g1);
+      copy->grad(x1, x2, g2);
+      ASSERT_EQ(g1, g2) << kernel;
+      // the copy is independent
+      copy->set_loghyper(Eigen::VectorXd::Zero(params.size()));
+      ASSERT_EQ(params, covf->get_loghyper());
+      copy->get(x1, x2);
+      covf->grad(x1, x2, g2);
+      ASSERT_EQ(g1, g2) << kernel;
+      delete copy;
+      delete covf;
+    }
+  }
+}
+
+TEST(HessianTest, EqualToNumerical) {
+  const char * kernels[] = {
+    "CovLinearard", "CovLinearone", "CovMatern3iso", "CovMatern5iso", "CovNoise",
+    "CovRQiso", "CovSEard", "CovSEiso", "CovSum(CovSEiso, CovNoise)",
+    "CovProd(CovSum(CovSEard, CovNoise), CovRQiso)", "InputDimFilter(1/CovSum(CovMatern5iso, CovNoise))"};
+  libgp::CovFactory factory;
+  for (int input_dim : {3, 10}) {
+    Eigen::VectorXd x1 = Eigen::VectorXd::Random(input_dim), x2 = Eigen::VectorXd::Random(input_dim);
+    for (const char * kernel : kernels) {
+      libgp::CovarianceFunction * covf = factory.create(input_dim, kernel);
+      size_t param_dim = covf->get_param_dim();
+      Eigen::VectorXd params = Eigen::VectorXd::Random(param_dim);
+      covf->set_loghyper(params);
+      Eigen::MatrixXd analytic(param_dim, param_dim), numerical(param_dim, param_dim);
+      for (bool same : {false, true}) {
+        const Eigen::VectorXd & x = same ? x1 : x2;
+        covf->hessian(x1, x, analytic);
+        // central differences of grad()
+        covf->libgp::CovarianceFunction::hessian(x1, x, numerical);
+        ASSERT_EQ(params, covf->get_loghyper());
+        for (size_t i = 0; i < param_dim; ++i) {
+          for (size_t j = 0; j < param_dim; ++j) {
+            ASSERT_NEAR(numerical(i, j), analytic(i, j), 1e-6 * (1 + std::abs(analytic(i, j))))
+              << kernel << " " << i << " " << j;
+          }
+        }
+      }
+      delete covf;
+    }
+    // the factory creates compile-time expressions for sums with noise,
+    // their second derivatives equal those of the tree
+    for (const char * kernel : {"CovSEiso", "CovRQiso"}) {
+      libgp::CovSum tree;
+      tree.init(input_dim, factory.create(input_dim, kernel), factory.create(input_dim, "CovNoise"));
+      libgp::CovarianceFunction * covf = factory.create(input_dim, tree.to_string());
+      size_t param_dim = covf->get_param_dim();
+      Eigen::VectorXd params = Eigen::VectorXd::Random(param_dim);
+      covf->set_loghyper(params);
+      tree.set_loghyper(params);
+      Eigen::MatrixXd expected(param_dim, param_dim), actual(param_dim, param_dim);
+      for (bool same : {false, true}) {
+        const Eigen::VectorXd & x = same ? x1 : x2;
+        tree.hessian(x1, x, expected);
+        covf->hessian(x1, x, actual);
+        for (size_t i = 0; i < param_dim; ++i) {
+          for (size_t j = 0; j < param_dim; ++j) {
+            ASSERT_NEAR(expected(i, j), actual(i, j), 1e-12 * (1 + std::abs(expected(i, j))))
+              << kernel << " " << i << " " << j;
+          }
+        }
+      }
+      delete covf;
+    }
+  }
+}
+
+TEST(ValueAndGradTest, EqualToSeparate) {
+  const char * kernels[] = {
+    "CovLinearard", "CovLinearone", "CovMatern3iso", "CovMatern5iso", "CovNoise",
+    "CovPeriodic", "CovPeriodicMatern3iso", "CovProd(CovSEiso, CovMatern3iso)",
+    "CovRQiso", "CovSEard", "CovSEiso", "CovSum(CovSEiso, CovNoise)",
+    "CovSum(CovLinearard, CovNoise)", "InputDimFilter(1/CovSEiso)",
+    "InputDimFilter(0/CovSum(CovSEiso, CovNoise))",
+    "CovProd(CovSum(CovSEard, CovNoise), CovRQiso)"};
+  libgp::CovFactory factory;
+  libgp::CovarianceFunction::Workspace ws;
+  for (const char * kernel : kernels) {
+    libgp::CovarianceFunction * covf = factory.create(3, kernel);
+    int param_dim = covf->get_param_dim();
+    covf->set_loghyper(Eigen::VectorXd::Random(param_dim));
+    Eigen::VectorXd x1 = Eigen::VectorXd::Random(3);
+    Eigen::VectorXd x2 = Eigen::VectorXd::Random(3);
+    Eigen::VectorXd expected(param_dim), grad(param_dim);
+    double k;
+    covf->value_and_grad(x1, x2, k, grad, ws);
+    covf->grad(x1, x2, expected);
+    ASSERT_NEAR(covf->get(x1, x2), k, 1e-12) << kernel;
+    for (int i = 0; i < param_dim; ++i) ASSERT_NEAR(expected(i), grad(i), 1e-12) << kernel;
+    // diagonal, the noise term only contributes for identical vectors
+    covf->value_and_grad(x1, x1, k, grad, ws);
+    covf->grad(x1, x1, expected);
+    ASSERT_NEAR(covf->get(x1, x1), k, 1e-12) << kernel;
+    for (int i = 0; i < param_dim; ++i) ASSERT_NEAR(expected(i), grad(i), 1e-12) << kernel;
+    delete covf;
+  }
+}
+
 #if GTEST_HAS_PARAM_TEST
 
 using ::testing::TestWithParam;
@@ -0,0 +1,127 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "cross_validation.h"
+
+#include <cmath>
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace libgp;
+
+class CrossValidationTest : public testing::Test {
+  protected:
+    virtual void SetUp() {
+      params.resize(3);
+      params << -0.5, 0.2, -1.5;
+      X = Eigen::MatrixXd::Random(n, input_dim);
+      y = Eigen::VectorXd::Random(n);
+      gp = new GaussianProcess(input_dim, covf_def);
+      gp->covf().set_loghyper(params);
+      gp->add_patterns(X, y);
+    }
+
+    virtual void TearDown() {
+      delete gp;
+    }
+
+    // compare to a model trained on the samples outside of the fold
+    void check(const Fold & fold, const FoldResult & result) {
+      std::vector<bool> held_out(n, false);
+      for (size_t i : fold.test) held_out[i] = true;
+      for (size_t i : fold.excluded) held_out[i] = true;
+      GaussianProcess ref(input_dim, covf_def);
+      ref.covf().set_loghyper(params);
+      for (int i = 0; i < n; ++i) {
+        Eigen::VectorXd x = X.row(i);
+        if (!held_out[i]) ref.add_pattern(x.data(), y(i));
+      }
+      double se = 0, nlpd = 0;
+      for (size_t j = 0; j < fold.test.size(); ++j) {
+        Eigen::VectorXd x = X.row(fold.test[j]);
+        double mean = ref.f(x.data());
+        double var = ref.var(x.data()) + exp(2 * params(2));
+        ASSERT_NEAR(mean, result.mean(j), 1e-8);
+        ASSERT_NEAR(var, result.var(j), 1e-8);
+        double r = y(fold.test[j]) - mean;
+        se += r * r;
+        nlpd += 0.5 * log(2 * M_PI * var) + 0.5 * r * r / var;
+      }
+      ASSERT_TRUE(result.valid);
+      ASSERT_NEAR(sqrt(se / fold.test.size()), result.rmse, 1e-8);
+      ASSERT_NEAR(nlpd / fold.test.size(), result.nlpd, 1e-8);
+    }
+
+    static const int input_dim = 2, n = 30;
+    std::string covf_def = "CovSum ( CovSEiso, CovNoise)";
+    Eigen::VectorXd params;
+    Eigen::MatrixXd X;
+    Eigen::VectorXd y;
+    GaussianProcess * gp;
+};
+
+TEST_F(CrossValidationTest, KFold)
+{
+  CrossValidation cv(*gp);
+  std::vector<Fold> folds = CrossValidation::kfold(n, 4);
+  ASSERT_EQ(4u, folds.size());
+  std::vector<FoldResult> results = cv.evaluate(folds, 3);
+  for (size_t f = 0; f < folds.size(); ++f) check(folds[f], results[f]);
+  // single thread gives identical results
+  std::vector<FoldResult> serial = cv.evaluate(folds, 1);
+  for (size_t f = 0; f < folds.size(); ++f) ASSERT_EQ(results[f].rmse, serial[f].rmse);
+}
+
+TEST_F(CrossValidationTest, TimeSeriesGap)
+{
+  CrossValidation cv(*gp);
+  std::vector<Fold> folds = CrossValidation::kfold(n, 5, 2);
+  ASSERT_EQ(2u, folds[0].excluded.size());
+  ASSERT_EQ(4u, folds[2].excluded.size());
+  std::vector<FoldResult> results = cv.evaluate(folds);
+  for (size_t f = 0; f < folds.size(); ++f) check(folds[f], results[f]);
+}
+
+TEST_F(CrossValidationTest, Assignment)
+{
+  std::vector<int> assignment(n);
+  for (int i = 0; i < n; ++i) assignment[i] = i % 4 == 3 ? -1 : i % 3;
+  std::vector<Fold> folds = CrossValidation::from_assignment(assignment);
+  ASSERT_EQ(3u, folds.size());
+  CrossValidation cv(*gp);
+  std::vector<FoldResult> results = cv.evaluate(folds);
+  for (size_t f = 0; f < folds.size(); ++f) check(folds[f], results[f]);
+  // unused fold indices are skipped
+  for (int i = 0; i < n; ++i) assignment[i] = i % 2 ? 5 : 2;
+  folds = CrossValidation::from_assignment(assignment);
+  ASSERT_EQ(2u, folds.size());
+  ASSERT_EQ(0u, folds[0].test[0]);
+  ASSERT_EQ(1u, folds[1].test[0]);
+  cv.evaluate(folds);
+  // a sample may not be held out twice
+  folds[0].excluded.push_back(folds[0].test[0]);
+  ASSERT_THROW(cv.evaluate(folds), std::runtime_error);
+}
+
+TEST_F(CrossValidationTest, IllConditioned)
+{
+  // duplicate inputs without noise term make the kernel matrix singular
+  GaussianProcess singular(input_dim, "CovSEiso");
+  singular.covf().set_loghyper(params.head(2));
+  Eigen::MatrixXd X2(2 * n, input_dim);
+  X2 << X, X;
+  Eigen::VectorXd y2(2 * n);
+  y2 << y, y;
+  singular.add_patterns(X2, y2);
+  CrossValidation cv(singular);
+  std::vector<FoldResult> results = cv.evaluate(CrossValidation::kfold(2 * n, 4));
+  for (const FoldResult & result : results) {
+    ASSERT_FALSE(result.valid);
+    ASSERT_TRUE(std::isnan(result.rmse));
+  }
+}
@@ -0,0 +1,103 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "data_reader.h"
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <vector>
+
+class DataReaderTest : public testing::Test {
+  protected:
+    virtual void SetUp() {
+      input_dim = 2;
+      n = 200;
+      X = Eigen::MatrixXd::Random(n, input_dim);
+      y = Eigen::VectorXd::Random(n);
+      X_test = Eigen::MatrixXd::Random(10, input_dim);
+    }
+
+    libgp::GaussianProcess * create_gp() {
+      libgp::GaussianProcess * gp = new libgp::GaussianProcess(input_dim, "CovSum ( CovSEiso, CovNoise)");
+      Eigen::VectorXd params(3);
+      params << -0.5, 0, -2;
+      gp->covf().set_loghyper(params);
+      return gp;
+    }
+
+    void expect_same_predictions(libgp::GaussianProcess * a, libgp::GaussianProcess * b) {
+      Eigen::MatrixXd pa = a->predict(X_test, true);
+      Eigen::MatrixXd pb = b->predict(X_test, true);
+      for (int i = 0; i < X_test.rows(); ++i) {
+        ASSERT_NEAR(pa(i, 0), pb(i, 0), 1e-6);
+        ASSERT_NEAR(pa(i, 1), pb(i, 1), 1e-6);
+      }
+    }
+
+    int input_dim;
+    int n;
+    Eigen::MatrixXd X;
+    Eigen::VectorXd y;
+    Eigen::MatrixXd X_test;
+};
+
+TEST_F(DataReaderTest, ModelFileRoundTrip)
+{
+  libgp::GaussianProcess * gp = create_gp();
+  gp->add_patterns(X, y);
+  gp->write("test_data_reader_model.txt");
+  libgp::GaussianProcess * loaded = new libgp::GaussianProcess("test_data_reader_model.txt");
+  ASSERT_EQ(gp->get_sampleset_size(), loaded->get_sampleset_size());
+  ASSERT_EQ(gp->covf().to_string(), loaded->covf().to_string());
+  expect_same_predictions(gp, loaded);
+  std::remove("test_data_reader_model.txt");
+  delete loaded;
+  delete gp;
+}
+
+TEST_F(DataReaderTest, BlockwiseImport)
+{
+  // comma separated with target in the last column and a small buffer
+  // to exercise lines crossing buffer boundaries
+  std::ofstream outfile("test_data_reader.csv");
+  outfile.precision(17);
+  outfile << "# x1, x2, y" << std::endl;
+  for (int i = 0; i < n; ++i) {
+    outfile << X(i, 0) << "," << X(i, 1) << "," << y(i) << "\r\n";
+    if (i == n / 2) outfile << std::endl;
+  }
+  outfile.close();
+
+  libgp::GaussianProcess * gp = create_gp();
+  for (int i = 0; i < n; ++i) {
+    Eigen::VectorXd x = X.row(i);
+    gp->add_pattern(x.data(), y(i));
+  }
+
+  libgp::GaussianProcess * imported = create_gp();
+  libgp::DataReader reader("test_data_reader.csv", 64);
+  ASSERT_TRUE(reader.is_open());
+  reader.set_target_column(-1);
+  ASSERT_EQ(n, reader.import(*imported, 37));
+  ASSERT_EQ(gp->get_sampleset_size(), imported->get_sampleset_size());
+  ASSERT_NEAR(gp->log_likelihood(), imported->log_likelihood(), 1e-6);
+  expect_same_predictions(gp, imported);
+  std::remove("test_data_reader.csv");
+  delete imported;
+  delete gp;
+}
+
+TEST_F(DataReaderTest, InvalidRow)
+{
+  std::ofstream outfile("test_data_reader_invalid.txt");
+  outfile << "1 2 3" << std::endl << "1 2" << std::endl;
+  outfile.close();
+  libgp::DataReader reader("test_data_reader_invalid.txt");
+  Eigen::MatrixXd x;
+  Eigen::VectorXd t;
+  ASSERT_THROW(reader.read(input_dim, x, t), std::runtime_error);
+  std::remove("test_data_reader_invalid.txt");
+}
@@ -0,0 +1,73 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "frozen_predictor.h"
+
+#include <cstdio>
+#include <gtest/gtest.h>
+
+class FrozenPredictorTest : public testing::Test {
+  protected:
+    virtual void SetUp() {
+      gp = new libgp::GaussianProcess(3, "CovSum ( CovSEard, CovNoise)");
+      Eigen::VectorXd params(5);
+      params << 0, -0.5, 0.5, 0, -2;
+      gp->covf().set_loghyper(params);
+      Eigen::MatrixXd X = Eigen::MatrixXd::Random(150, 3);
+      Eigen::VectorXd y = gp->covf().draw_random_sample(X);
+      gp->add_patterns(X, y);
+      X_test = Eigen::MatrixXd::Random(20, 3);
+    }
+
+    virtual void TearDown() {
+      delete gp;
+    }
+
+    void expect_same_predictions(const libgp::FrozenPredictor & frozen) {
+      Eigen::VectorXd mean(X_test.rows()), var(X_test.rows());
+      libgp::FrozenPredictor::Workspace ws = frozen.workspace();
+      frozen.predict(X_test, mean, var, ws);
+      for (int i = 0; i < X_test.rows(); ++i) {
+        Eigen::VectorXd x = X_test.row(i);
+        double f = gp->f(x.data()), v = gp->var(x.data());
+        ASSERT_NEAR(f, mean(i), 1e-8);
+        ASSERT_NEAR(v, var(i), 1e-8);
+        ASSERT_NEAR(f, frozen.f(x.data(), ws), 1e-8);
+        ASSERT_NEAR(v, frozen.var(x.data(), ws), 1e-8);
+      }
+    }
+
+    libgp::GaussianProcess * gp;
+    Eigen::MatrixXd X_test;
+};
+
+TEST_F(FrozenPredictorTest, EqualToGaussianProcess)
+{
+  libgp::FrozenPredictor frozen(*gp);
+  ASSERT_EQ(gp->get_sampleset_size(), frozen.size());
+  expect_same_predictions(frozen);
+}
+
+TEST_F(FrozenPredictorTest, Serialization)
+{
+  libgp::FrozenPredictor frozen(*gp);
+  frozen.write("test_frozen_predictor.bin");
+  libgp::FrozenPredictor loaded("test_frozen_predictor.bin");
+  std::remove("test_frozen_predictor.bin");
+  ASSERT_TRUE(loaded.has_variance());
+  expect_same_predictions(loaded);
+}
+
+TEST_F(FrozenPredictorTest, MeanOnly)
+{
+  libgp::FrozenPredictor frozen(*gp, false);
+  libgp::FrozenPredictor::Workspace ws = frozen.workspace();
+  Eigen::VectorXd mean(X_test.rows()), var(X_test.rows());
+  ASSERT_FALSE(frozen.has_variance());
+  ASSERT_THROW(frozen.predict(X_test, mean, var, ws), std::runtime_error);
+  Eigen::VectorXd no_var;
+  frozen.predict(X_test, mean, no_var, ws);
+  ASSERT_NEAR(gp->predict(X_test)(0, 0), mean(0), 1e-8);
+}
@@ -0,0 +1,112 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "gp_batch.h"
+#include "work_stealing.h"
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace libgp;
+
+// compare all models of the batch to independent Gaussian processes
+static void compare(GPBatch & batch, std::vector<GaussianProcess *> & gps, size_t threads)
+{
+  int input_dim = batch.get_input_dim();
+  Eigen::VectorXd ll = batch.log_likelihood(threads);
+  Eigen::MatrixXd grad = batch.log_likelihood_gradient(threads);
+  std::vector<size_t> id;
+  Eigen::MatrixXd x_star = Eigen::MatrixXd::Random(3 * gps.size(), input_dim);
+  for (Eigen::Index i = 0; i < x_star.rows(); ++i) id.push_back((7 * i) % gps.size());
+  Eigen::MatrixXd p = batch.predict(id, x_star, true, threads);
+  for (size_t i = 0; i < gps.size(); ++i) {
+    ASSERT_EQ(gps[i]->get_sampleset_size(), batch.get_sampleset_size(i));
+    ASSERT_NEAR(gps[i]->log_likelihood(), ll(i), 1e-7);
+    Eigen::VectorXd g = gps[i]->log_likelihood_gradient();
+    for (int j = 0; j < g.size(); ++j) ASSERT_NEAR(g(j), grad(j, i), 1e-6);
+  }
+  for (size_t q = 0; q < id.size(); ++q) {
+    Eigen::VectorXd x = x_star.row(q);
+    ASSERT_NEAR(gps[id[q]]->f(x.data()), p(q, 0), 1e-8);
+    ASSERT_NEAR(gps[id[q]]->var(x.data()), p(q, 1), 1e-8);
+  }
+}
+
+TEST(GPBatchTest, EqualToSingleModels)
+{
+  int input_dim = 2;
+  const char * covf_def = "CovSum ( CovSEiso, CovNoise)";
+  GPBatch batch(input_dim, covf_def);
+  std::vector<GaussianProcess *> gps;
+  for (int i = 0; i < 12; ++i) {
+    ASSERT_EQ(static_cast<size_t>(i), batch.add_model());
+    gps.push_back(new GaussianProcess(input_dim, covf_def));
+    Eigen::VectorXd params = Eigen::VectorXd::Random(batch.get_param_dim());
+    params(2) = -1.5;
+    batch.set_loghyper(i, params);
+    gps[i]->covf().set_loghyper(params);
+    // sizes across several buckets
+    int n = 5 + 9 * i;
+    Eigen::MatrixXd X = Eigen::MatrixXd::Random(n, input_dim);
+    Eigen::VectorXd y = Eigen::VectorXd::Random(n);
+    batch.add_patterns(i, X, y);
+    gps[i]->add_patterns(X, y);
+  }
+  compare(batch, gps, 3);
+  // single patterns extend the factorization, moving models between buckets
+  for (int k = 0; k < 30; ++k) {
+    size_t i = k % 4;
+    Eigen::VectorXd x = Eigen::VectorXd::Random(input_dim);
+    batch.add_pattern(i, x.data(), 0.1 * k);
+    gps[i]->add_pattern(x.data(), 0.1 * k);
+  }
+  compare(batch, gps, 1);
+  // batched hyperparameter update
+  Eigen::MatrixXd P = Eigen::MatrixXd::Random(batch.get_param_dim(), gps.size());
+  P.row(2).setConstant(-1.0);
+  batch.set_loghyper(P);
+  for (size_t i = 0; i < gps.size(); ++i) {
+    gps[i]->covf().set_loghyper(P.col(i));
+    ASSERT_TRUE(P.col(i).isApprox(batch.get_loghyper(i)));
+  }
+  compare(batch, gps, 0);
+  batch.clear_sampleset(5);
+  gps[5]->clear_sampleset();
+  Eigen::VectorXd x = Eigen::VectorXd::Random(input_dim);
+  batch.add_pattern(5, x.data(), 1.0);
+  gps[5]->add_pattern(x.data(), 1.0);
+  compare(batch, gps, 2);
+  for (size_t i = 0; i < gps.size(); ++i) delete gps[i];
+}
+
+TEST(GPBatchTest, Errors)
+{
+  GPBatch batch(2, "CovSum ( CovSEiso, CovNoise)");
+  batch.add_model();
+  ASSERT_THROW(batch.get_sampleset_size(1), std::runtime_error);
+  ASSERT_THROW(batch.set_loghyper(0, Eigen::VectorXd::Zero(2)), std::runtime_error);
+  ASSERT_THROW(batch.predict(std::vector<size_t>(2, 0), Eigen::MatrixXd::Zero(3, 2)), std::runtime_error);
+  // an empty model predicts the prior
+  Eigen::MatrixXd p = batch.predict(std::vector<size_t>(1, 0), Eigen::MatrixXd::Zero(1, 2), true);
+  ASSERT_DOUBLE_EQ(0.0, p(0, 0));
+  ASSERT_DOUBLE_EQ(1.0, p(0, 1));
+}
+
+TEST(GPBatchTest, WorkStealing)
+{
+  std::vector<std::atomic<int> > runs(1000);
+  for (size_t i = 0; i < runs.size(); ++i) runs[i] = 0;
+  parallel_for(runs.size(), 4, [&](size_t i, size_t t) {
+    ASSERT_LT(t, 4u);
+    runs[i]++;
+  });
+  for (size_t i = 0; i < runs.size(); ++i) ASSERT_EQ(1, runs[i]);
+  ASSERT_THROW(parallel_for(10, 3, [](size_t i, size_t) {
+    if (i == 7) throw std::runtime_error("task failed");
+  }), std::runtime_error);
+}
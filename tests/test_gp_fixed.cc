@@ -0,0 +1,175 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "gp_fixed.h"
+#include "cov_factory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <string>
+
+template <int D> void compare_to_dynamic(std::string covf_def)
+{
+  libgp::GaussianProcess gp(D, covf_def);
+  libgp::GaussianProcessFixed<D> gp_fixed(covf_def);
+  ASSERT_TRUE(gp_fixed.is_fixed());
+  Eigen::VectorXd params = Eigen::VectorXd::Random(gp.covf().get_param_dim());
+  params(params.size() - 1) = -2;
+  gp.covf().set_loghyper(params);
+  gp_fixed.covf().set_loghyper(params);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(100, D);
+  Eigen::VectorXd y = gp.covf().draw_random_sample(X);
+  for (int i = 0; i < X.rows(); ++i) {
+    Eigen::VectorXd x = X.row(i);
+    gp.add_pattern(x.data(), y(i));
+    gp_fixed.add_pattern(x.data(), y(i));
+  }
+  Eigen::MatrixXd X_test = Eigen::MatrixXd::Random(20, D);
+  Eigen::MatrixXd expected = gp.predict(X_test, true);
+  Eigen::MatrixXd actual = gp_fixed.predict(X_test, true);
+  for (int i = 0; i < X_test.rows(); ++i) {
+    Eigen::VectorXd x = X_test.row(i);
+    ASSERT_NEAR(expected(i, 0), actual(i, 0), 1e-8);
+    ASSERT_NEAR(expected(i, 1), actual(i, 1), 1e-8);
+    ASSERT_NEAR(gp.f(x.data()), gp_fixed.f(x.data()), 1e-8);
+    ASSERT_NEAR(gp.var(x.data()), gp_fixed.var(x.data()), 1e-8);
+  }
+  ASSERT_NEAR(gp.log_likelihood(), gp_fixed.log_likelihood(), 1e-6);
+  // force recomputation of the kernel matrix on the fixed path
+  params(0) += 0.1;
+  gp.covf().set_loghyper(params);
+  gp_fixed.covf().set_loghyper(params);
+  ASSERT_NEAR(gp.log_likelihood(), gp_fixed.log_likelihood(), 1e-6);
+}
+
+TEST(GPFixedTest, SEiso) {
+  compare_to_dynamic<2>("CovSum ( CovSEiso, CovNoise)");
+}
+
+TEST(GPFixedTest, SEard) {
+  compare_to_dynamic<3>("CovSum ( CovSEard, CovNoise)");
+}
+
+TEST(GPFixedTest, Matern) {
+  compare_to_dynamic<1>("CovSum ( CovProd(CovMatern3iso, CovMatern5iso), CovNoise)");
+}
+
+TEST(GPFixedTest, RQiso) {
+  compare_to_dynamic<4>("CovSum ( CovRQiso, CovNoise)");
+}
+
+TEST(GPFixedTest, FactorySpecialization) {
+  libgp::CovFactory factory;
+  for (int d = 1; d <= 9; ++d) {
+    libgp::CovarianceFunction * covf = factory.create(d, "CovSum(CovSEiso, CovNoise)");
+    bool fixed = dynamic_cast<libgp::CovFixedBase *>(covf) != NULL;
+    ASSERT_EQ(d <= libgp::max_fixed_dim, fixed);
+    ASSERT_EQ("CovSum(CovSEiso, CovNoise)", covf->to_string());
+    delete covf;
+  }
+  // composites fall back if one operand has no specialization
+  libgp::CovarianceFunction * covf = factory.create(2, "CovSum(CovLinearard, CovNoise)");
+  ASSERT_TRUE(dynamic_cast<libgp::CovFixedBase *>(covf) == NULL);
+  delete covf;
+}
+
+TEST(GPFixedTest, Fallback) {
+  libgp::GaussianProcessFixed<2> gp("CovSum(InputDimFilter(0/CovSEiso), CovNoise)");
+  ASSERT_FALSE(gp.is_fixed());
+  gp.covf().set_loghyper(Eigen::VectorXd::Zero(gp.covf().get_param_dim()));
+  double x[] = {0.1, 0.2};
+  gp.add_pattern(x, 1.0);
+  ASSERT_TRUE(std::isfinite(gp.f(x)));
+}
+
+TEST(GPFixedTest, Copy) {
+  std::string covf_def = "CovSum ( CovSEiso, CovNoise)";
+  libgp::GaussianProcess gp(2, covf_def);
+  libgp::GaussianProcessFixed<2> * source = new libgp::GaussianProcessFixed<2>(covf_def);
+  Eigen::VectorXd params(3);
+  params << 0, 0, -2;
+  gp.covf().set_loghyper(params);
+  source->covf().set_loghyper(params);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(20, 2);
+  Eigen::VectorXd y = Eigen::VectorXd::Random(20);
+  gp.add_patterns(X, y);
+  source->add_patterns(X, y);
+  libgp::GaussianProcessFixed<2> copy(*source);
+  ASSERT_TRUE(copy.is_fixed());
+  // the copy evaluates its own hyperparameters and outlives the source
+  params(0) = 0.5;
+  source->covf().set_loghyper(-params);
+  copy.covf().set_loghyper(params);
+  delete source;
+  gp.covf().set_loghyper(params);
+  double x[] = {0.1, 0.2};
+  ASSERT_NEAR(gp.log_likelihood(), copy.log_likelihood(), 1e-8);
+  ASSERT_NEAR(gp.f(x), copy.f(x), 1e-8);
+  ASSERT_NEAR(gp.var(x), copy.var(x), 1e-8);
+}
+
+TEST(GPFixedTest, RowAndFusedGradient) {
+  // kernel rows and fused gradients take the fixed dimension path as well
+  libgp::CovFactory factory;
+  libgp::CovarianceFunction * covf = factory.create(3, "CovProd(CovSEard, CovMatern3iso)");
+  ASSERT_TRUE(dynamic_cast<libgp::CovFixed<3> *>(covf) != NULL);
+  covf->set_loghyper(Eigen::VectorXd::Random(covf->get_param_dim()));
+  std::vector<Eigen::VectorXd> X(10, Eigen::VectorXd(3));
+  std::vector<const Eigen::VectorXd *> pointers;
+  for (size_t i = 0; i < X.size(); ++i) {
+    X[i].setRandom();
+    pointers.push_back(&X[i]);
+  }
+  libgp::CovarianceFunction::Workspace ws;
+  Eigen::VectorXd row(X.size()), grad(covf->get_param_dim()), g(covf->get_param_dim());
+  covf->get_row(X[0], pointers.data(), row, ws);
+  for (size_t i = 0; i < X.size(); ++i) {
+    // rows use the vectorized exp and distances in a different order
+    double expected = covf->get(X[0], X[i]);
+    ASSERT_NEAR(expected, row(i), 1e-13 * std::max(1.0, std::fabs(expected)));
+    double k;
+    covf->value_and_grad(X[0], X[i], k, grad, ws);
+    covf->grad(X[0], X[i], g);
+    ASSERT_NEAR(expected, k, 1e-13 * std::max(1.0, std::fabs(expected)));
+    for (int j = 0; j < g.size(); ++j) ASSERT_DOUBLE_EQ(g(j), grad(j));
+  }
+  delete covf;
+}
+
+// exposes whether the kernel matrix is represented by the eigendecomposition
+class SpectralFixed : public libgp::GaussianProcessFixed<2> {
+  public:
+    SpectralFixed(std::string covf_def) : libgp::GaussianProcessFixed<2>(covf_def) {}
+    bool spectral() { compute(); return use_spectral; }
+};
+
+TEST(GPFixedTest, ScaleNoiseCache) {
+  // the fixed dimension kernel shares the eigendecomposition path
+  SpectralFixed gp("CovSum ( CovSEiso, CovNoise)");
+  ASSERT_TRUE(gp.is_fixed());
+  gp.set_scale_noise_cache(true);
+  Eigen::VectorXd params(3);
+  params << 0, 0, -2;
+  gp.covf().set_loghyper(params);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(40, 2);
+  Eigen::VectorXd y = Eigen::VectorXd::Random(40);
+  gp.add_patterns(X, y);
+  gp.log_likelihood();
+  double x[] = {0.1, 0.2};
+  for (int i = 0; i < 3; ++i) {
+    params(1) = 0.3 * i - 0.5;
+    params(2) = -2.5 + 0.4 * i;
+    gp.covf().set_loghyper(params);
+    ASSERT_TRUE(gp.spectral());
+    libgp::GaussianProcess ref(2, "CovSum ( CovSEiso, CovNoise)");
+    ref.covf().set_loghyper(params);
+    ref.add_patterns(X, y);
+    ASSERT_NEAR(ref.log_likelihood(), gp.log_likelihood(), 1e-8);
+    ASSERT_NEAR(ref.f(x), gp.f(x), 1e-8);
+    ASSERT_NEAR(ref.var(x), gp.var(x), 1e-8);
+    ASSERT_NEAR(ref.predict(X, true)(3, 1), gp.predict(X, true)(3, 1), 1e-8);
+  }
+}
@@ -0,0 +1,104 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "gp_linear.h"
+#include "frozen_predictor.h"
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace libgp;
+
+// compare likelihood, gradient and predictions to the dense implementation
+static void compare(GaussianProcess & dense, GaussianProcessLinear & linear, int input_dim)
+{
+  ASSERT_NEAR(dense.log_likelihood(), linear.log_likelihood(), 1e-7);
+  Eigen::VectorXd g1 = dense.log_likelihood_gradient();
+  Eigen::VectorXd g2 = linear.log_likelihood_gradient();
+  ASSERT_EQ(g1.size(), g2.size());
+  for (int j = 0; j < g1.size(); ++j) ASSERT_NEAR(g1(j), g2(j), 1e-6);
+  Eigen::MatrixXd x_star = Eigen::MatrixXd::Random(5, input_dim);
+  Eigen::MatrixXd p1 = dense.predict(x_star, true);
+  Eigen::MatrixXd p2 = linear.predict(x_star, true);
+  linear.prepare();
+  for (int i = 0; i < x_star.rows(); ++i) {
+    Eigen::VectorXd x = x_star.row(i);
+    ASSERT_NEAR(dense.f(x.data()), linear.f(x.data()), 1e-8);
+    ASSERT_NEAR(dense.var(x.data()), linear.var(x.data()), 1e-8);
+    ASSERT_NEAR(p1(i, 0), p2(i, 0), 1e-8);
+    ASSERT_NEAR(p1(i, 1), p2(i, 1), 1e-8);
+    double mean, var;
+    ASSERT_TRUE(linear.predict_rt(x.data(), mean, &var));
+    ASSERT_NEAR(p1(i, 0), mean, 1e-8);
+    ASSERT_NEAR(p1(i, 1), var, 1e-8);
+  }
+}
+
+static void check(std::string covf_def, int input_dim)
+{
+  GaussianProcess dense(input_dim, covf_def);
+  GaussianProcessLinear linear(input_dim, covf_def);
+  Eigen::VectorXd params = Eigen::VectorXd::Random(dense.covf().get_param_dim());
+  dense.covf().set_loghyper(params);
+  linear.covf().set_loghyper(params);
+  // batch, then single patterns
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(40, input_dim);
+  Eigen::VectorXd y = Eigen::VectorXd::Random(40);
+  dense.add_patterns(X, y);
+  linear.add_patterns(X, y);
+  compare(dense, linear, input_dim);
+  for (int i = 0; i < 10; ++i) {
+    Eigen::VectorXd x = Eigen::VectorXd::Random(input_dim);
+    dense.add_pattern(x.data(), 0.1 * i);
+    linear.add_pattern(x.data(), 0.1 * i);
+  }
+  compare(dense, linear, input_dim);
+  dense.set_y(3, 2.0);
+  linear.set_y(3, 2.0);
+  params = Eigen::VectorXd::Random(params.size());
+  dense.covf().set_loghyper(params);
+  linear.covf().set_loghyper(params);
+  compare(dense, linear, input_dim);
+  // the full cholesky factor is computed on request
+  FrozenPredictor frozen(linear);
+  FrozenPredictor::Workspace ws = frozen.workspace();
+  Eigen::VectorXd x = Eigen::VectorXd::Random(input_dim);
+  ASSERT_NEAR(dense.f(x.data()), frozen.f(x.data(), ws), 1e-8);
+  ASSERT_NEAR(dense.var(x.data()), frozen.var(x.data(), ws), 1e-8);
+  // the cholesky factor does not cover patterns added afterwards
+  for (int i = 0; i < 3; ++i) {
+    Eigen::VectorXd x = Eigen::VectorXd::Random(input_dim);
+    dense.add_pattern(x.data(), -0.2 * i);
+    linear.add_pattern(x.data(), -0.2 * i);
+  }
+  dense.set_y(0, 1.5);
+  linear.set_y(0, 1.5);
+  compare(dense, linear, input_dim);
+  FrozenPredictor refrozen(linear);
+  FrozenPredictor::Workspace ws2 = refrozen.workspace();
+  ASSERT_NEAR(dense.var(x.data()), refrozen.var(x.data(), ws2), 1e-8);
+  // forks for hyperparameter search keep the feature representation
+  std::unique_ptr<GaussianProcess> fork(linear.fork());
+  ASSERT_TRUE(dynamic_cast<GaussianProcessLinear *>(fork.get()) != NULL);
+  compare(dense, *static_cast<GaussianProcessLinear *>(fork.get()), input_dim);
+}
+
+TEST(GaussianProcessLinearTest, EqualToDense)
+{
+  check("CovSum ( CovLinearard, CovNoise)", 3);
+  check("CovSum ( CovLinearone, CovNoise)", 2);
+  check("CovSum ( CovNoise, CovSum ( CovLinearard, CovLinearone))", 2);
+}
+
+TEST(GaussianProcessLinearTest, FeatureDim)
+{
+  GaussianProcessLinear gp(4, "CovSum ( CovLinearone, CovNoise)");
+  ASSERT_EQ(5u, gp.get_feature_dim());
+  ASSERT_THROW(GaussianProcessLinear(2, "CovSum ( CovSEiso, CovNoise)"), std::runtime_error);
+  ASSERT_THROW(GaussianProcessLinear(2, "CovLinearard"), std::runtime_error);
+}
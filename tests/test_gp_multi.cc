@@ -0,0 +1,80 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "gp_multi.h"
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+using namespace libgp;
+
+// compare to independent models per output
+static void compare(GaussianProcessMulti & multi, const Eigen::MatrixXd & X, const Eigen::MatrixXd & Y,
+                    const Eigen::VectorXd & params, const std::string & covf_def)
+{
+  int input_dim = X.cols(), m = Y.cols();
+  Eigen::MatrixXd x_star = Eigen::MatrixXd::Random(6, input_dim);
+  Eigen::VectorXd var;
+  Eigen::MatrixXd mean = multi.predict_outputs(x_star, &var);
+  double lik = 0;
+  Eigen::VectorXd grad = Eigen::VectorXd::Zero(params.size());
+  for (int j = 0; j < m; ++j) {
+    GaussianProcess gp(input_dim, covf_def);
+    gp.covf().set_loghyper(params);
+    gp.add_patterns(X, Y.col(j));
+    Eigen::MatrixXd p = gp.predict(x_star, true);
+    for (int i = 0; i < x_star.rows(); ++i) {
+      ASSERT_NEAR(p(i, 0), mean(i, j), 1e-8);
+      ASSERT_NEAR(p(i, 1), var(i), 1e-8);
+    }
+    lik += gp.log_likelihood();
+    grad += gp.log_likelihood_gradient();
+  }
+  ASSERT_NEAR(lik, multi.log_likelihood(), 1e-7);
+  Eigen::VectorXd g = multi.log_likelihood_gradient();
+  for (int k = 0; k < params.size(); ++k) ASSERT_NEAR(grad(k), g(k), 1e-6);
+}
+
+TEST(GaussianProcessMultiTest, EqualToIndependent)
+{
+  int input_dim = 2, m = 4;
+  std::string covf_def = "CovSum ( CovSEiso, CovNoise)";
+  GaussianProcessMulti multi(input_dim, m, covf_def);
+  Eigen::VectorXd params(3);
+  params << -0.3, 0.1, -1.5;
+  multi.covf().set_loghyper(params);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(30, input_dim);
+  Eigen::MatrixXd Y = Eigen::MatrixXd::Random(30, m);
+  Eigen::MatrixXd X0 = X.topRows(20), Y0 = Y.topRows(20);
+  multi.add_patterns(X0, Y0);
+  for (int i = 20; i < 30; ++i) {
+    Eigen::VectorXd x = X.row(i);
+    Eigen::VectorXd y = Y.row(i);
+    multi.add_pattern(x.data(), y.data());
+  }
+  compare(multi, X, Y, params, covf_def);
+  Y(4, 2) = 1.5;
+  Y(7, 0) = -0.5;
+  multi.set_y(4, 2, 1.5);
+  multi.set_y(7, 0, -0.5);
+  compare(multi, X, Y, params, covf_def);
+  // signal and noise level only
+  params(1) = 0.4;
+  params(2) = -1.0;
+  multi.covf().set_loghyper(params);
+  compare(multi, X, Y, params, covf_def);
+  params(0) = 0.2;
+  multi.covf().set_loghyper(params);
+  compare(multi, X, Y, params, covf_def);
+  // scalar interface refers to the first output
+  ASSERT_THROW(multi.add_pattern(X.data(), 0.0), std::runtime_error);
+  ASSERT_EQ(30u, multi.get_targets().rows());
+  // forks for hyperparameter search keep all outputs
+  std::unique_ptr<GaussianProcess> fork(multi.fork());
+  ASSERT_TRUE(dynamic_cast<GaussianProcessMulti *>(fork.get()) != NULL);
+  compare(*static_cast<GaussianProcessMulti *>(fork.get()), X, Y, params, covf_def);
+}
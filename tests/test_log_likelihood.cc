@@ -11,6 +11,7 @@
 #include <vector>
 #include "cov_se_iso.h"
 #include "cov_factory.h"
+#include "cov_sum.h"
 
 TEST(LogLikelihoodTest, CheckGradients) 
 {
@@ -48,3 +49,169 @@ TEST(LogLikelihoodTest, CheckGradients)
   delete gp;
 }
 
+
+TEST(LogLikelihoodTest, CheckHessian)
+{
+  int input_dim = 2;
+  libgp::GaussianProcess gp(input_dim, "CovSum ( CovRQiso, CovNoise)");
+  Eigen::VectorXd params(4);
+  params << 0, 0, 0.5, -2;
+  gp.covf().set_loghyper(params);
+  size_t n = 100;
+  Eigen::MatrixXd X(n, input_dim);
+  X.setRandom();
+  Eigen::VectorXd y = gp.covf().draw_random_sample(X);
+  gp.add_patterns(X, y);
+
+  // the kernel is a compile-time expression, its second derivatives equal
+  // the analytic ones of the tree
+  libgp::CovFactory factory;
+  libgp::CovSum tree;
+  tree.init(input_dim, factory.create(input_dim, "CovRQiso"), factory.create(input_dim, "CovNoise"));
+  tree.set_loghyper(params);
+  Eigen::MatrixXd expected(4, 4), actual(4, 4);
+  for (int i = 0; i < 10; ++i) {
+    Eigen::VectorXd x1 = X.row(i), x2 = X.row(i + 1);
+    for (const Eigen::VectorXd * x : {&x2, &x1}) {
+      tree.hessian(x1, *x, expected);
+      gp.covf().hessian(x1, *x, actual);
+      ASSERT_TRUE(expected.isApprox(actual, 1e-12));
+    }
+  }
+
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd hess;
+  double value = gp.log_likelihood_hessian(grad, hess);
+  ASSERT_NEAR(gp.log_likelihood(), value, 1e-10 * std::abs(value));
+  Eigen::VectorXd reference = gp.log_likelihood_gradient();
+  for (int i = 0; i < params.size(); ++i) ASSERT_NEAR(reference(i), grad(i), 1e-8 * (1 + std::abs(grad(i))));
+
+  double e = 1e-5;
+  for (int i = 0; i < params.size(); ++i) {
+    double theta = params(i);
+    params(i) = theta - e;
+    gp.covf().set_loghyper(params);
+    Eigen::VectorXd g1 = gp.log_likelihood_gradient();
+    params(i) = theta + e;
+    gp.covf().set_loghyper(params);
+    Eigen::VectorXd g2 = gp.log_likelihood_gradient();
+    params(i) = theta;
+    for (int j = 0; j < params.size(); ++j) {
+      ASSERT_NEAR((g2(j)-g1(j))/(2*e), hess(i, j), 1e-4 * (1 + std::abs(hess(i, j))));
+    }
+  }
+}
+
+TEST(LogLikelihoodTest, Streaming)
+{
+  int input_dim = 2;
+  libgp::GaussianProcess gp(input_dim, "CovSum ( CovSEiso, CovNoise)");
+  Eigen::VectorXd params(3);
+  params << 0, 0, -2;
+  gp.covf().set_loghyper(params);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(60, input_dim);
+  Eigen::VectorXd y = Eigen::VectorXd::Random(60);
+  for (int i = 0; i < 30; ++i) {
+    Eigen::VectorXd x = X.row(i);
+    gp.add_pattern(x.data(), y(i));
+    // likelihood from the incrementally updated statistics
+    gp.log_likelihood();
+  }
+  gp.add_patterns(X.bottomRows(30), y.tail(30));
+  y(45) = 0.7;
+  gp.set_y(45, 0.7);
+  y(59) = -0.3;
+  gp.set_y(59, -0.3);
+  libgp::GaussianProcess ref(input_dim, "CovSum ( CovSEiso, CovNoise)");
+  ref.covf().set_loghyper(params);
+  ref.add_patterns(X, y);
+  ASSERT_NEAR(ref.log_likelihood(), gp.log_likelihood(), 1e-8);
+  Eigen::VectorXd x = Eigen::VectorXd::Random(input_dim);
+  ASSERT_NEAR(ref.f(x.data()), gp.f(x.data()), 1e-8);
+}
+
+TEST(LogLikelihoodTest, LeaveOneOut)
+{
+  int input_dim = 2, n = 25;
+  std::string covf_def = "CovSum ( CovSEiso, CovNoise)";
+  libgp::GaussianProcess gp(input_dim, covf_def);
+  Eigen::VectorXd params(3);
+  params << -0.5, 0.2, -1.5;
+  gp.covf().set_loghyper(params);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(n, input_dim);
+  Eigen::VectorXd y = Eigen::VectorXd::Random(n);
+  gp.add_patterns(X, y);
+  Eigen::MatrixXd loo = gp.loo_predict();
+  // compare to models trained without sample i
+  double lp = 0;
+  for (int i = 0; i < n; ++i) {
+    libgp::GaussianProcess ref(input_dim, covf_def);
+    ref.covf().set_loghyper(params);
+    for (int j = 0; j < n; ++j) {
+      Eigen::VectorXd x = X.row(j);
+      if (j != i) ref.add_pattern(x.data(), y(j));
+    }
+    Eigen::VectorXd x = X.row(i);
+    // the loo variance includes the noise
+    double var = ref.var(x.data()) + exp(2 * params(2));
+    ASSERT_NEAR(ref.f(x.data()), loo(i, 0), 1e-8);
+    ASSERT_NEAR(var, loo(i, 1), 1e-8);
+    lp += -0.5 * log(var) - 0.5 * pow(y(i) - loo(i, 0), 2) / var - 0.5 * log(2 * M_PI);
+  }
+  ASSERT_NEAR(lp, gp.loo_log_predictive(), 1e-8);
+
+  double e = 1e-5;
+  Eigen::VectorXd grad = gp.loo_log_predictive_gradient();
+  for (int i = 0; i < params.size(); ++i) {
+    double theta = params(i);
+    params(i) = theta - e;
+    gp.covf().set_loghyper(params);
+    double j1 = gp.loo_log_predictive();
+    params(i) = theta + e;
+    gp.covf().set_loghyper(params);
+    double j2 = gp.loo_log_predictive();
+    params(i) = theta;
+    ASSERT_NEAR((j2-j1)/(2*e), grad(i), 1e-5);
+  }
+}
+
+TEST(LogLikelihoodTest, Batch)
+{
+  int input_dim = 2, n = 40;
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(n, input_dim);
+  Eigen::VectorXd y = Eigen::VectorXd::Random(n);
+  // isotropic kernels use the shared distances, CovSEard the generic path,
+  // the sums with CovNoise are compile-time expressions
+  std::vector<std::string> defs = {"CovSum ( CovProd ( CovSEiso, CovRQiso), CovNoise)",
+                                   "CovSum ( CovMatern5iso, CovMatern3iso)",
+                                   "CovSum ( CovMatern3iso, CovNoise)",
+                                   "CovSum ( CovSEard, CovNoise)"};
+  for (size_t d = 0; d < defs.size(); ++d) {
+    libgp::GaussianProcess gp(input_dim, defs[d]);
+    ASSERT_EQ(defs[d].find("CovSEard") == std::string::npos, gp.covf().supports_distances());
+    int p = gp.covf().get_param_dim();
+    Eigen::VectorXd params = Eigen::VectorXd::Constant(p, -1);
+    gp.covf().set_loghyper(params);
+    gp.add_patterns(X, y);
+    double value = gp.log_likelihood();
+    Eigen::MatrixXd theta = 0.5 * Eigen::MatrixXd::Random(7, p);
+    for (size_t threads = 1; threads <= 4; threads += 3) {
+      Eigen::MatrixXd grad;
+      Eigen::VectorXd batch = gp.log_likelihood_batch(theta, &grad, threads);
+      // the model is not changed
+      ASSERT_EQ(params, gp.covf().get_loghyper());
+      ASSERT_EQ(value, gp.log_likelihood());
+      for (int c = 0; c < theta.rows(); ++c) {
+        libgp::GaussianProcess ref(input_dim, defs[d]);
+        ref.covf().set_loghyper(theta.row(c).transpose());
+        ref.add_patterns(X, y);
+        double reference = ref.log_likelihood();
+        ASSERT_NEAR(reference, batch(c), 1e-8 * (1 + std::abs(reference)));
+        Eigen::VectorXd g = ref.log_likelihood_gradient();
+        for (int i = 0; i < p; ++i) ASSERT_NEAR(g(i), grad(c, i), 1e-6 * (1 + std::abs(g(i))));
+      }
+    }
+    ASSERT_EQ(theta.rows(), gp.log_likelihood_batch(theta).size());
+    ASSERT_THROW(gp.log_likelihood_batch(Eigen::MatrixXd::Zero(2, p + 1)), std::runtime_error);
+  }
+}
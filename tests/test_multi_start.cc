@@ -0,0 +1,114 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "sample_gp.h"
+#include "multi_start.h"
+#include "lbfgsb.h"
+#include "rprop.h"
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+
+using namespace libgp;
+
+TEST(MultiStartTest, Fork)
+{
+  std::unique_ptr<GaussianProcess> gp(create_sample_gp(50, 0.05));
+  std::unique_ptr<GaussianProcess> fork(gp->fork());
+  ASSERT_EQ(gp->get_sampleset_size(), fork->get_sampleset_size());
+  ASSERT_EQ(gp->get_sampleset(), fork->get_sampleset());
+  ASSERT_NEAR(gp->log_likelihood(), fork->log_likelihood(), 1e-10);
+  Eigen::VectorXd x = Eigen::VectorXd::Random(2);
+  ASSERT_NEAR(gp->f(x.data()), fork->f(x.data()), 1e-10);
+  ASSERT_NEAR(gp->var(x.data()), fork->var(x.data()), 1e-10);
+  // hyperparameters and new samples of the fork do not affect the original
+  double ll = gp->log_likelihood();
+  fork->covf().set_loghyper(Eigen::VectorXd::Constant(3, -1));
+  fork->add_pattern(x.data(), 1.0);
+  fork->set_y(0, 3.0);
+  ASSERT_EQ(50u, gp->get_sampleset_size());
+  ASSERT_EQ(ll, gp->log_likelihood());
+  GaussianProcess ref(2, "CovSum ( CovSEiso, CovNoise)");
+  ref.covf().set_loghyper(fork->covf().get_loghyper());
+  Eigen::MatrixXd samples = fork->get_sampleset();
+  ref.add_patterns(samples.leftCols(2), samples.col(2));
+  ASSERT_NEAR(ref.log_likelihood(), fork->log_likelihood(), 1e-8);
+  // the original outlives its fork and vice versa
+  fork.reset(gp->fork());
+  gp.reset();
+  ASSERT_NEAR(ll, fork->log_likelihood(), 1e-8);
+}
+
+TEST(MultiStartTest, ForkEmpty)
+{
+  // streaming into a fork of an empty or cleared model
+  GaussianProcess empty(2, "CovSum ( CovSEiso, CovNoise)");
+  std::unique_ptr<GaussianProcess> fork(empty.fork());
+  std::unique_ptr<GaussianProcess> gp(create_sample_gp(20, 0.05));
+  std::unique_ptr<GaussianProcess> cleared(gp->fork());
+  cleared->clear_sampleset();
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(10, 2);
+  Eigen::VectorXd y = Eigen::VectorXd::Random(10);
+  GaussianProcess ref(2, "CovSum ( CovSEiso, CovNoise)");
+  ref.covf().set_loghyper(gp->covf().get_loghyper());
+  fork->covf().set_loghyper(gp->covf().get_loghyper());
+  for (int i = 0; i < X.rows(); ++i) {
+    Eigen::VectorXd x = X.row(i);
+    fork->add_pattern(x.data(), y(i));
+    cleared->add_pattern(x.data(), y(i));
+    ref.add_pattern(x.data(), y(i));
+  }
+  ASSERT_NEAR(ref.log_likelihood(), fork->log_likelihood(), 1e-10);
+  ASSERT_NEAR(ref.log_likelihood(), cleared->log_likelihood(), 1e-10);
+}
+
+TEST(MultiStartTest, BestStart)
+{
+  std::unique_ptr<GaussianProcess> gp(create_sample_gp(60, 0.05));
+  Eigen::MatrixXd starts = MultiStart::random_starts(Eigen::VectorXd::Zero(3), 6, 2.0);
+  MultiStart multi([](Objective * objective, size_t n) {
+    LBFGSB lbfgsb;
+    lbfgsb.maximize(objective, n, false);
+  });
+  double best = multi.maximize(gp.get(), starts, 20, 3);
+  ASSERT_EQ(6, multi.get_values().size());
+  ASSERT_EQ(best, multi.get_values().maxCoeff());
+  ASSERT_NEAR(best, gp->log_likelihood(), 1e-8);
+  // equal to a single run from each start
+  for (int i = 0; i < starts.cols(); ++i) {
+    std::unique_ptr<GaussianProcess> single(gp->fork());
+    single->covf().set_loghyper(starts.col(i));
+    LBFGSB lbfgsb;
+    lbfgsb.maximize(single.get(), 20, false);
+    ASSERT_NEAR(single->log_likelihood(), multi.get_values()(i), 1e-8);
+    ASSERT_LE(single->log_likelihood(), best + 1e-8);
+  }
+}
+
+TEST(MultiStartTest, Cutoff)
+{
+  std::unique_ptr<GaussianProcess> gp(create_sample_gp(60, 0.05));
+  Eigen::MatrixXd starts = MultiStart::random_starts(Eigen::VectorXd::Zero(3), 8, 3.0);
+  // one start at the generating hyperparameters
+  starts.col(0) << 0, 0, log(0.05);
+  MultiStart multi([](Objective * objective, size_t n) {
+    RProp rprop;
+    rprop.maximize(objective, n, false);
+  });
+  multi.set_cutoff(2, 5.0);
+  double best = multi.maximize(gp.get(), starts, 20, 2);
+  ASSERT_FALSE(multi.get_abandoned()[0]);
+  size_t abandoned = 0;
+  for (int i = 0; i < starts.cols(); ++i) {
+    if (multi.get_abandoned()[i]) {
+      ++abandoned;
+      ASSERT_LT(multi.get_values()(i), best);
+    }
+  }
+  ASSERT_GT(abandoned, 0u);
+  ASSERT_NEAR(best, gp->log_likelihood(), 1e-8);
+}
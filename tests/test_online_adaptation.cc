@@ -0,0 +1,106 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "online_adaptation.h"
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+
+using namespace libgp;
+
+static const std::string covf_def = "CovSum ( CovSEiso, CovNoise)";
+
+static void create_stream(int n, Eigen::MatrixXd & X, Eigen::VectorXd & y)
+{
+  GaussianProcess source(1, covf_def);
+  Eigen::VectorXd params(3);
+  params << log(0.5), 0, log(0.1);
+  source.covf().set_loghyper(params);
+  X = 5 * Eigen::MatrixXd::Random(n, 1);
+  y = source.covf().draw_random_sample(X);
+}
+
+static Eigen::VectorXd initial_loghyper()
+{
+  Eigen::VectorXd params(3);
+  params << log(2.0), 0, log(0.5);
+  return params;
+}
+
+// the factorization of gp agrees with a model built from scratch
+static void expect_consistent(GaussianProcess & gp)
+{
+  Eigen::MatrixXd samples = gp.get_sampleset();
+  GaussianProcess ref(1, covf_def);
+  ref.covf().set_loghyper(gp.covf().get_loghyper());
+  ref.add_patterns(samples.leftCols(1), samples.col(1));
+  double value = ref.log_likelihood();
+  ASSERT_NEAR(value, gp.log_likelihood(), 1e-6 * std::abs(value));
+  for (double x = -2; x <= 2; x += 0.5) {
+    ASSERT_NEAR(ref.f(&x), gp.f(&x), 1e-6);
+    ASSERT_NEAR(ref.var(&x), gp.var(&x), 1e-6);
+  }
+}
+
+TEST(OnlineAdaptationTest, Adapt)
+{
+  Eigen::MatrixXd X;
+  Eigen::VectorXd y;
+  create_stream(400, X, y);
+  GaussianProcess gp(1, covf_def);
+  gp.covf().set_loghyper(initial_loghyper());
+  OnlineAdaptation online(&gp);
+  online.set_background(false);
+  // no refits, only the adapted hyperparameters change
+  online.init(25, 100, 5, 0.05, 1e10);
+  for (int i = 0; i < 50; ++i) online.add_pattern(&X(i, 0), y(i));
+  ASSERT_EQ(initial_loghyper(), gp.covf().get_loghyper());
+  ASSERT_GT(online.get_drift(), 0);
+  ASSERT_EQ(0u, online.get_refits());
+  ASSERT_FALSE(online.refit_pending());
+
+  online.init(25, 100, 5, 0.05, 0.3);
+  for (int i = 50; i < X.rows(); ++i) online.add_pattern(&X(i, 0), y(i));
+  ASSERT_GE(online.get_refits(), 1u);
+  expect_consistent(gp);
+  GaussianProcess initial(1, covf_def);
+  initial.covf().set_loghyper(initial_loghyper());
+  initial.add_patterns(X, y);
+  ASSERT_GT(gp.log_likelihood(), initial.log_likelihood());
+}
+
+TEST(OnlineAdaptationTest, Background)
+{
+  Eigen::MatrixXd X;
+  Eigen::VectorXd y;
+  create_stream(300, X, y);
+  GaussianProcess gp(1, covf_def);
+  gp.covf().set_loghyper(initial_loghyper());
+  gp.add_patterns(X.topRows(200), y.head(200));
+  OnlineAdaptation online(&gp);
+  online.refit();
+  ASSERT_TRUE(online.refit_pending());
+  // the model changes while the refit runs
+  for (int i = 200; i < X.rows(); ++i) gp.add_pattern(&X(i, 0), y(i));
+  gp.set_y(3, 0.5);
+  ASSERT_TRUE(online.wait());
+  ASSERT_FALSE(online.refit_pending());
+  ASSERT_FALSE(online.wait());
+  ASSERT_EQ(1u, online.get_refits());
+  ASSERT_EQ(0, online.get_drift());
+  ASSERT_NE(initial_loghyper(), gp.covf().get_loghyper());
+  expect_consistent(gp);
+
+  // a refit of samples that were removed only contributes the hyperparameters
+  online.refit();
+  gp.clear_sampleset();
+  gp.add_patterns(X.bottomRows(50), y.tail(50));
+  ASSERT_TRUE(online.wait());
+  ASSERT_EQ(2u, online.get_refits());
+  ASSERT_EQ(50u, gp.get_sampleset_size());
+  expect_consistent(gp);
+}
@@ -5,10 +5,20 @@
 #include "gp.h"
 #include "rprop.h"
 #include "cg.h"
+#include "lbfgsb.h"
+#include "sgd.h"
+#include "trust_region.h"
+#include "objective.h"
 #include "gp_utils.h"
+#include "sample_gp.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <gtest/gtest.h>
 #include <vector>
 
@@ -70,3 +80,381 @@ TEST_F(OptimizerTest, CG)
   ASSERT_NEAR(0, gp->covf().get_loghyper()(1), 1.0);
 }
 
+TEST_F(OptimizerTest, CGParallel)
+{
+  Eigen::VectorXd params(param_dim);
+  params << -1, -1, -1;
+  gp->covf().set_loghyper(params);
+  double start = gp->log_likelihood();
+
+  libgp::CG cg;
+  cg.set_parallel(4);
+  cg.maximize(gp, 15, false);
+
+  ASSERT_GT(gp->log_likelihood(), start);
+  ASSERT_NEAR(0, gp->covf().get_loghyper()(0), 1.0);
+  ASSERT_NEAR(0, gp->covf().get_loghyper()(1), 1.0);
+
+  // forks evaluate independently of the original objective
+  libgp::MarginalLikelihood objective(gp);
+  libgp::Objective * forked = objective.fork();
+  ASSERT_TRUE(forked != NULL);
+  double value = objective.value();
+  forked->set_loghyper(params);
+  ASSERT_DOUBLE_EQ(value, objective.value());
+  ASSERT_NEAR(start, forked->value(), 1e-8 * std::abs(start));
+  delete forked;
+}
+
+TEST_F(OptimizerTest, LooPredictive)
+{
+  Eigen::VectorXd params(param_dim);
+  params << -1, -1, -1;
+  gp->covf().set_loghyper(params);
+  libgp::LooPredictive objective(gp);
+  double start = objective.value();
+
+  libgp::RProp rprop;
+  rprop.init();
+  rprop.maximize(&objective, 15, false);
+  double rprop_value = objective.value();
+  ASSERT_GT(rprop_value, start);
+
+  gp->covf().set_loghyper(params);
+  libgp::CG cg;
+  cg.maximize(&objective, 15, false);
+  ASSERT_GT(objective.value(), start);
+}
+
+TEST_F(OptimizerTest, JointLikelihood)
+{
+  // further datasets of different size from the same process
+  std::vector<libgp::GaussianProcess *> gps(1, gp);
+  for (int k = 0; k < 4; ++k) {
+    gps.push_back(new libgp::GaussianProcess(input_dim, "CovSum ( CovSEiso, CovNoise)"));
+    Eigen::MatrixXd X = 10 * Eigen::MatrixXd::Random(30 + 10 * k, input_dim);
+    Eigen::VectorXd y = gp->covf().draw_random_sample(X);
+    gps.back()->add_patterns(X, y);
+  }
+  Eigen::VectorXd params(param_dim);
+  params << -1, -1, -1;
+  gp->covf().set_loghyper(params);
+  libgp::JointLikelihood objective(gps, 3);
+  double sum = 0;
+  Eigen::VectorXd grad = Eigen::VectorXd::Zero(param_dim);
+  for (size_t i = 0; i < gps.size(); ++i) {
+    ASSERT_TRUE(params.isApprox(gps[i]->covf().get_loghyper()));
+    sum += gps[i]->log_likelihood();
+    grad += gps[i]->log_likelihood_gradient();
+  }
+  ASSERT_NEAR(sum, objective.value(), 1e-8);
+  ASSERT_TRUE(grad.isApprox(objective.gradient(), 1e-10));
+
+  libgp::RProp rprop;
+  rprop.init();
+  rprop.maximize(&objective, 15, false);
+  ASSERT_GT(objective.value(), sum);
+  for (size_t i = 1; i < gps.size(); ++i) {
+    ASSERT_TRUE(gp->covf().get_loghyper().isApprox(gps[i]->covf().get_loghyper()));
+  }
+  objective.set_loghyper(params);
+  libgp::CG cg;
+  cg.maximize(&objective, 15, false);
+  ASSERT_GT(objective.value(), sum);
+  for (size_t i = 1; i < gps.size(); ++i) delete gps[i];
+}
+
+TEST_F(OptimizerTest, EvaluationCache)
+{
+  libgp::MarginalLikelihood objective(gp);
+  Eigen::VectorXd params(param_dim), grad, cached;
+  params << -1, -1, -1;
+  double value = objective.value_and_gradient(params, grad);
+  ASSERT_EQ(1u, objective.get_evaluations());
+  ASSERT_NEAR(gp->log_likelihood(), value, 1e-10);
+  ASSERT_TRUE(gp->log_likelihood_gradient().isApprox(grad));
+  // revisiting a point is answered from the cache
+  Eigen::VectorXd other = params.array() + 0.5;
+  objective.value_and_gradient(other, cached);
+  ASSERT_EQ(value, objective.value_and_gradient(params, cached));
+  ASSERT_EQ(grad, cached);
+  ASSERT_EQ(2u, objective.get_evaluations());
+  objective.clear_cache();
+  objective.value_and_gradient(params, cached);
+  ASSERT_EQ(3u, objective.get_evaluations());
+  // leave-one-out value and gradient in one pass
+  libgp::LooPredictive loo(gp);
+  value = loo.value_and_gradient(params, grad);
+  ASSERT_NEAR(gp->loo_log_predictive(), value, 1e-8);
+  ASSERT_TRUE(gp->loo_log_predictive_gradient().isApprox(grad, 1e-8));
+  // one evaluation per iteration
+  libgp::RProp rprop;
+  rprop.init();
+  objective.set_loghyper(params);
+  size_t start = objective.get_evaluations();
+  rprop.maximize(&objective, 10, false);
+  ASSERT_LE(objective.get_evaluations() - start, 11u);
+}
+
+TEST_F(OptimizerTest, LBFGSB)
+{
+  // noisy samples, the optimum lies inside the default bounds
+  std::unique_ptr<libgp::GaussianProcess> sample(create_sample_gp(100, 0.1, 2));
+  Eigen::VectorXd params(param_dim);
+  params << -1, -1, -1;
+  sample->covf().set_loghyper(params);
+
+  // stop on the projected gradient
+  libgp::LBFGSB lbfgsb;
+  lbfgsb.init(10, 1e-3);
+  lbfgsb.maximize(sample.get(), 500, true);
+  ASSERT_EQ(libgp::StoppingCriteria::GRADIENT_NORM, lbfgsb.get_stop_reason());
+
+  ASSERT_NEAR(0, sample->covf().get_loghyper()(0), 1.0);
+  ASSERT_NEAR(0, sample->covf().get_loghyper()(1), 1.0);
+
+  // the optimum lies outside the box, the bound is placed relative to it
+  // since the length-scale optimum depends on the random data set
+  double ell = sample->covf().get_loghyper()(0);
+  Eigen::VectorXd lower(param_dim), upper(param_dim);
+  lower << ell - 2, -2, -8;
+  upper << ell - 0.5, 2, 0;
+  lbfgsb.set_bounds(lower, upper);
+  params(0) = ell - 1;
+  sample->covf().set_loghyper(params);
+  lbfgsb.maximize(sample.get(), 500, false);
+  Eigen::VectorXd p = sample->covf().get_loghyper();
+  ASSERT_DOUBLE_EQ(upper(0), p(0));
+  ASSERT_TRUE((p.array() >= lower.array()).all() && (p.array() <= upper.array()).all());
+}
+
+// concave quadratic -(x - c)^T A (x - c) / 2 with coupled variables, the
+// evaluations of all forks are counted
+class Quadratic : public libgp::Objective
+{
+public:
+  Quadratic(const Eigen::MatrixXd & A, const Eigen::VectorXd & c)
+    : A(A), c(c), x(Eigen::VectorXd::Zero(c.size())), count(new std::atomic<size_t>(0)) {}
+  virtual Eigen::VectorXd get_loghyper() { return x; }
+  virtual void set_loghyper(const Eigen::VectorXd &p) { x = p; }
+  virtual double value() { ++*count; return -0.5 * (x - c).dot(A * (x - c)); }
+  virtual Eigen::VectorXd gradient() { return -A * (x - c); }
+  virtual libgp::Objective * fork() { return new Quadratic(*this); }
+  Eigen::MatrixXd A;
+  Eigen::VectorXd c, x;
+  std::shared_ptr<std::atomic<size_t> > count;
+};
+
+TEST(LBFGSBTest, ActiveBoundCoupled)
+{
+  // the optimum lies outside the box, the solution has active bounds on
+  // which the L-BFGS direction may point outward
+  srand(0);
+  libgp::LBFGSB lbfgsb;
+  lbfgsb.set_bounds(-1, 1);
+  for (int k = 0; k < 50; ++k) {
+    Eigen::MatrixXd M = Eigen::MatrixXd::Random(6, 6);
+    Quadratic objective(M * M.transpose() + 0.1 * Eigen::MatrixXd::Identity(6, 6),
+                        3 * Eigen::VectorXd::Random(6));
+    lbfgsb.maximize(&objective, 200, false);
+    Eigen::VectorXd x = objective.get_loghyper();
+    Eigen::VectorXd g = -objective.gradient();
+    Eigen::VectorXd pg = x - (x - g).cwiseMax(-1).cwiseMin(1);
+    ASSERT_LT(pg.lpNorm<Eigen::Infinity>(), 1e-4);
+  }
+}
+
+TEST(CGTest, ParallelEvaluations)
+{
+  // speculative points count against the maximum number of evaluations
+  srand(1);
+  Eigen::MatrixXd M = Eigen::MatrixXd::Random(6, 6);
+  Eigen::MatrixXd A = M * M.transpose() + 0.1 * Eigen::MatrixXd::Identity(6, 6);
+  Eigen::VectorXd c = Eigen::VectorXd::Random(6);
+  for (size_t n = 5; n <= 40; n += 7) {
+    Quadratic objective(A, c);
+    libgp::CG cg;
+    cg.set_parallel(4);
+    cg.maximize(&objective, n, false);
+    ASSERT_LE(objective.count->load(), n + 1);
+  }
+  Quadratic objective(A, c);
+  libgp::CG cg;
+  cg.set_parallel(4);
+  cg.maximize(&objective, 400, false);
+  ASSERT_LT((objective.get_loghyper() - c).norm(), 1e-4);
+}
+
+TEST_F(OptimizerTest, SGD)
+{
+  // noisy samples, the length-scale is determined by the full dataset
+  std::unique_ptr<libgp::GaussianProcess> sample(create_sample_gp(100, 0.1, 2));
+  Eigen::VectorXd params(param_dim);
+  params << -1, -1, -1;
+  sample->covf().set_loghyper(params);
+  double start = sample->log_likelihood();
+
+  libgp::SGD sgd;
+  sgd.init(32, 0.1);
+  sgd.maximize(sample.get(), 100, false);
+  // the length-scale is poorly determined by sparse subsets
+  ASSERT_GT(sample->log_likelihood(), start);
+  ASSERT_NEAR(0, sample->covf().get_loghyper()(1), 1.0);
+
+  // momentum only with full-batch polish
+  sample->covf().set_loghyper(params);
+  sgd.init(32, 0.5, 0.01, false);
+  sgd.set_polish(libgp::SGD::POLISH_CG, 10);
+  sgd.maximize(sample.get(), 100, false);
+  ASSERT_NEAR(0, sample->covf().get_loghyper()(0), 1.0);
+  ASSERT_NEAR(0, sample->covf().get_loghyper()(1), 1.0);
+}
+
+TEST_F(OptimizerTest, TrustRegion)
+{
+  // noisy samples, the optimum is interior and the gradient vanishes there
+  std::unique_ptr<libgp::GaussianProcess> sample(create_sample_gp(100, 0.1, 2));
+  Eigen::VectorXd params(param_dim);
+  params << -1, -1, -1;
+  sample->covf().set_loghyper(params);
+
+  libgp::TrustRegion tr;
+  size_t iterations = 0;
+  tr.set_callback([&](const libgp::OptimizerStats & s) {
+    iterations = s.iteration;
+    return true;
+  });
+  tr.set_tolerance(0, 1e-3);
+  tr.maximize(sample.get(), 30, true);
+  ASSERT_NEAR(0, sample->covf().get_loghyper()(0), 1.0);
+  ASSERT_NEAR(0, sample->covf().get_loghyper()(1), 1.0);
+  ASSERT_EQ(libgp::StoppingCriteria::GRADIENT_NORM, tr.get_stop_reason());
+  ASSERT_LE(iterations, 20u);
+
+  // indefinite Hessian: steepest descent inside the region, boundary otherwise
+  Eigen::MatrixXd B(2, 2);
+  B << -1, 0, 0, 2;
+  Eigen::VectorXd g(2);
+  g << 0, 1;
+  Eigen::VectorXd p = libgp::TrustRegion::solve_subproblem(B, g, 1.0);
+  ASSERT_NEAR(1.0, p.norm(), 1e-8);
+  B << 2, 0, 0, 4;
+  p = libgp::TrustRegion::solve_subproblem(B, g, 1.0);
+  ASSERT_NEAR(-0.25, p(1), 1e-12);
+  ASSERT_NEAR(0.1, libgp::TrustRegion::solve_subproblem(B, g, 0.1).norm(), 1e-8);
+}
+
+TEST_F(OptimizerTest, StoppingCriteria)
+{
+  Eigen::VectorXd params(param_dim);
+  params << -1, -1, -1;
+
+  // stats of every iteration, stop after three
+  libgp::CG cg;
+  std::vector<libgp::OptimizerStats> stats;
+  cg.set_callback([&](const libgp::OptimizerStats & s) {
+    stats.push_back(s);
+    return stats.size() < 3;
+  });
+  gp->covf().set_loghyper(params);
+  cg.maximize(gp, 100, false);
+  ASSERT_EQ(libgp::StoppingCriteria::CALLBACK, cg.get_stop_reason());
+  ASSERT_EQ(3u, stats.size());
+  for (size_t k = 1; k < stats.size(); ++k) {
+    ASSERT_GT(stats[k].iteration, stats[k-1].iteration);
+    ASSERT_GE(stats[k].elapsed, stats[k-1].elapsed);
+    ASSERT_GT(stats[k].value, stats[k-1].value);
+  }
+  ASSERT_NEAR(gp->log_likelihood(), stats.back().value, 1e-8);
+  ASSERT_NEAR(gp->log_likelihood_gradient().norm(), stats.back().gradient_norm, 1e-6);
+
+  // an expired deadline stops after the first iteration
+  libgp::RProp rprop;
+  rprop.init();
+  rprop.set_deadline(std::chrono::steady_clock::now());
+  gp->covf().set_loghyper(params);
+  rprop.maximize(gp, 100, false);
+  ASSERT_EQ(libgp::StoppingCriteria::TIME_LIMIT, rprop.get_stop_reason());
+  rprop.clear_deadline();
+  gp->covf().set_loghyper(params);
+  rprop.maximize(gp, 5, false);
+  ASSERT_EQ(libgp::StoppingCriteria::MAX_ITERATIONS, rprop.get_stop_reason());
+
+  // a time limit bounds the wall-clock time of the line search
+  cg.set_callback(libgp::StoppingCriteria::Callback());
+  cg.set_time_limit(1e-9);
+  gp->covf().set_loghyper(params);
+  double start = gp->log_likelihood();
+  cg.maximize(gp, 100, false);
+  ASSERT_EQ(libgp::StoppingCriteria::TIME_LIMIT, cg.get_stop_reason());
+  ASSERT_GE(gp->log_likelihood(), start - 1e-10 * std::abs(start));
+
+  // convergence
+  cg.set_time_limit(0);
+  cg.set_tolerance(1e-4);
+  gp->covf().set_loghyper(params);
+  cg.maximize(gp, 500, false);
+  ASSERT_EQ(libgp::StoppingCriteria::RELATIVE_IMPROVEMENT, cg.get_stop_reason());
+  libgp::LBFGSB lbfgsb;
+  lbfgsb.set_tolerance(0, 1e-2);
+  gp->covf().set_loghyper(params);
+  lbfgsb.maximize(gp, 500, false);
+  ASSERT_EQ(libgp::StoppingCriteria::GRADIENT_NORM, lbfgsb.get_stop_reason());
+  ASSERT_LT(gp->log_likelihood_gradient().norm(), 1e-2);
+}
+
+// records the value of every evaluation
+class CountingObjective : public libgp::MarginalLikelihood {
+  public:
+    CountingObjective(libgp::GaussianProcess * gp) : libgp::MarginalLikelihood(gp) {}
+    std::vector<double> values;
+    // evaluations until a value above target, 0 if it is never reached
+    size_t reached(double target) {
+      for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i] > target) return i + 1;
+      }
+      return 0;
+    }
+  protected:
+    virtual double evaluate(Eigen::VectorXd &grad) {
+      double value = libgp::MarginalLikelihood::evaluate(grad);
+      values.push_back(value);
+      return value;
+    }
+};
+
+TEST_F(OptimizerTest, EvaluationCount)
+{
+  // noisy samples, so that the optimum is inside the default bounds of
+  // L-BFGS-B and reachable by the unbounded optimizers
+  std::unique_ptr<libgp::GaussianProcess> sample(create_sample_gp(100, 0.1, 2));
+  Eigen::VectorXd params(param_dim);
+  params << -1, -1, -1;
+  CountingObjective o_rprop(sample.get()), o_cg(sample.get()), o_lbfgsb(sample.get());
+  libgp::RProp rprop;
+  rprop.init();
+  sample->covf().set_loghyper(params);
+  rprop.maximize(&o_rprop, 200, false);
+  libgp::CG cg;
+  sample->covf().set_loghyper(params);
+  cg.maximize(&o_cg, 200, false);
+  libgp::LBFGSB lbfgsb;
+  lbfgsb.init(10, 1e-8);
+  sample->covf().set_loghyper(params);
+  lbfgsb.maximize(&o_lbfgsb, 200, false);
+  // evaluations until the best value of any optimizer is reached within 1e-3
+  double best = -std::numeric_limits<double>::infinity();
+  for (CountingObjective * o : {&o_rprop, &o_cg, &o_lbfgsb}) {
+    best = std::max(best, *std::max_element(o->values.begin(), o->values.end()));
+  }
+  double target = best - 1e-3;
+  // counts are written to the test report (--gtest_output), not to stdout
+  RecordProperty("evaluations_rprop", static_cast<int>(o_rprop.reached(target)));
+  RecordProperty("evaluations_cg", static_cast<int>(o_cg.reached(target)));
+  RecordProperty("evaluations_lbfgsb", static_cast<int>(o_lbfgsb.reached(target)));
+  ASSERT_GT(o_rprop.reached(target), 0u);
+  ASSERT_GT(o_cg.reached(target), 0u);
+  ASSERT_GT(o_lbfgsb.reached(target), 0u);
+  // depends on the random data set, typically about half of the others
+  ASSERT_LE(o_lbfgsb.reached(target), std::max(o_rprop.reached(target), o_cg.reached(target)));
+}
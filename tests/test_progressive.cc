@@ -0,0 +1,83 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "sample_gp.h"
+#include "progressive.h"
+#include "cg.h"
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+using namespace libgp;
+
+TEST(ProgressiveTest, StratifiedOrder)
+{
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(1024, 2);
+  std::vector<size_t> order = Progressive::stratified_order(X);
+  std::vector<size_t> sorted = order;
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); ++i) ASSERT_EQ(i, sorted[i]);
+  // every 16th sample, the quadrants of the curve (split at the center of
+  // the bounding box) are covered in proportion to their samples
+  Eigen::RowVectorXd center = (X.colwise().minCoeff() + X.colwise().maxCoeff()) / 2;
+  int count[4] = {0, 0, 0, 0}, quadrant[4] = {0, 0, 0, 0};
+  for (int k = 0; k < X.rows(); ++k) count[(X(k, 0) >= center(0)) + 2 * (X(k, 1) >= center(1))]++;
+  for (size_t i = 0; i < 64; ++i) {
+    size_t k = order[i * 16];
+    quadrant[(X(k, 0) >= center(0)) + 2 * (X(k, 1) >= center(1))]++;
+  }
+  for (int q = 0; q < 4; ++q) ASSERT_NEAR(count[q] / 16.0, quadrant[q], 1);
+}
+
+TEST(ProgressiveTest, Stages)
+{
+  // both runs stop once the gradient vanishes, the evaluations on the full
+  // dataset vary between datasets and are compared in total
+  size_t progressive_evaluations = 0, full_evaluations = 0;
+  for (int dataset = 0; dataset < 4; ++dataset) {
+    // dense enough for the smallest subset to determine the hyperparameters
+    std::unique_ptr<GaussianProcess> gp(create_sample_gp(256, 0.2, 2));
+    Eigen::VectorXd start(3);
+    start << -1, -1, -1;
+    // reference: optimize on the full dataset
+    std::unique_ptr<GaussianProcess> full(gp->fork());
+    full->covf().set_loghyper(start);
+    MarginalLikelihood objective(full.get());
+    CG cg;
+    cg.set_tolerance(0, 1e-3);
+    cg.maximize(&objective, 1000, false);
+    ASSERT_EQ(StoppingCriteria::GRADIENT_NORM, cg.get_stop_reason());
+
+    std::vector<size_t> evaluations;
+    std::vector<StoppingCriteria::Reason> reasons;
+    Progressive progressive([&](Objective * o, size_t n) {
+      CG stage;
+      stage.set_tolerance(0, 1e-3);
+      stage.maximize(o, n, false);
+      evaluations.push_back(o->get_evaluations());
+      reasons.push_back(stage.get_stop_reason());
+    });
+    progressive.set_stages(3, 2, 64);
+    gp->covf().set_loghyper(start);
+    double value = progressive.maximize(gp.get(), 1000);
+    std::vector<size_t> sizes = progressive.get_sizes();
+    ASSERT_EQ(3u, sizes.size());
+    ASSERT_EQ(64u, sizes[0]);
+    ASSERT_EQ(128u, sizes[1]);
+    ASSERT_EQ(256u, sizes[2]);
+    ASSERT_EQ(3u, progressive.get_values().size());
+    ASSERT_DOUBLE_EQ(value, gp->log_likelihood());
+    for (size_t s = 0; s < reasons.size(); ++s) ASSERT_EQ(StoppingCriteria::GRADIENT_NORM, reasons[s]);
+    // both converge to the same optimum
+    ASSERT_NEAR(objective.value(), value, 1e-6 * std::abs(value));
+    progressive_evaluations += evaluations.back();
+    full_evaluations += objective.get_evaluations();
+  }
+  // the warm start saves evaluations on the full dataset
+  ASSERT_LT(progressive_evaluations, full_evaluations);
+}
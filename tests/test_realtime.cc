@@ -0,0 +1,185 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "frozen_predictor.h"
+#include "cov_factory.h"
+
+#include <cstdlib>
+#include <new>
+#include <gtest/gtest.h>
+
+// Count heap allocations while the flag is set. Eigen allocates through
+// malloc, hence malloc is interposed as well where the C library allows it.
+static bool count_allocations = false;
+static size_t allocations = 0;
+
+#if defined(__GLIBC__)
+extern "C" {
+  void * __libc_malloc(size_t size);
+  void * __libc_calloc(size_t count, size_t size);
+  void * __libc_realloc(void * p, size_t size);
+
+  void * malloc(size_t size)
+  {
+    if (count_allocations) allocations++;
+    return __libc_malloc(size);
+  }
+
+  void * calloc(size_t count, size_t size)
+  {
+    if (count_allocations) allocations++;
+    return __libc_calloc(count, size);
+  }
+
+  void * realloc(void * p, size_t size)
+  {
+    if (count_allocations) allocations++;
+    return __libc_realloc(p, size);
+  }
+}
+#endif
+
+void * operator new(std::size_t size)
+{
+  if (count_allocations) allocations++;
+  void * p = std::malloc(size == 0 ? 1 : size);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+
+void * operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void * p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void * p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void * p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void * p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+class RealTimeTest : public testing::Test {
+  protected:
+    virtual void SetUp() {
+      gp = new libgp::GaussianProcess(2, "CovSum ( CovSEiso, CovNoise)");
+      Eigen::VectorXd params(3);
+      params << 0, 0, -2;
+      gp->covf().set_loghyper(params);
+      X = Eigen::MatrixXd::Random(100, 2);
+      Eigen::VectorXd y = gp->covf().draw_random_sample(X);
+      gp->add_patterns(X, y);
+      X_test = Eigen::MatrixXd::Random(50, 2);
+    }
+
+    virtual void TearDown() {
+      delete gp;
+    }
+
+    libgp::GaussianProcess * gp;
+    Eigen::MatrixXd X;
+    Eigen::MatrixXd X_test;
+};
+
+TEST_F(RealTimeTest, EqualToLazyPrediction)
+{
+  gp->prepare();
+  for (int i = 0; i < X_test.rows(); ++i) {
+    Eigen::VectorXd x = X_test.row(i);
+    double mean, var;
+    ASSERT_TRUE(gp->predict_rt(x.data(), mean, &var));
+    ASSERT_NEAR(gp->f(x.data()), mean, 1e-10);
+    ASSERT_NEAR(gp->var(x.data()), var, 1e-10);
+  }
+}
+
+TEST_F(RealTimeTest, RequiresPreparation)
+{
+  double x[] = {0.1, 0.2}, mean;
+  ASSERT_FALSE(gp->predict_rt(x, mean));
+  gp->prepare();
+  ASSERT_TRUE(gp->predict_rt(x, mean));
+  gp->add_pattern(x, 1.0);
+  ASSERT_FALSE(gp->predict_rt(x, mean));
+  gp->prepare();
+  ASSERT_TRUE(gp->predict_rt(x, mean));
+  gp->covf().set_loghyper(gp->covf().get_loghyper());
+  ASSERT_FALSE(gp->predict_rt(x, mean));
+}
+
+TEST_F(RealTimeTest, NoAllocations)
+{
+  std::vector<Eigen::VectorXd> inputs;
+  for (int i = 0; i < X_test.rows(); ++i) inputs.push_back(X_test.row(i));
+  gp->prepare();
+  double mean, var, sum = 0;
+  allocations = 0;
+  count_allocations = true;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    gp->predict_rt(inputs[i].data(), mean, &var);
+    sum += mean + var;
+  }
+  count_allocations = false;
+  ASSERT_EQ(0u, allocations);
+  ASSERT_TRUE(std::isfinite(sum));
+#if defined(__GLIBC__)
+  // the lazy path allocates, which makes sure the counter works
+  count_allocations = true;
+  gp->var(inputs[0].data());
+  count_allocations = false;
+  ASSERT_LT(0u, allocations);
+#endif
+}
+
+TEST_F(RealTimeTest, FrozenPredictorNoAllocations)
+{
+  libgp::FrozenPredictor frozen(*gp);
+  libgp::FrozenPredictor::Workspace ws = frozen.workspace();
+  Eigen::VectorXd mean(X_test.rows()), var(X_test.rows());
+  allocations = 0;
+  count_allocations = true;
+  frozen.predict(X_test, mean, var, ws);
+  count_allocations = false;
+  ASSERT_EQ(0u, allocations);
+}
+
+TEST(ValueAndGradTest, NoAllocations)
+{
+  libgp::CovFactory factory;
+  libgp::CovarianceFunction * covf = factory.create(2,
+      "CovSum(CovProd(InputDimFilter(1/CovSEard), CovMatern5iso), CovSum(CovRQiso, CovNoise))");
+  covf->set_loghyper(Eigen::VectorXd::Zero(covf->get_param_dim()));
+  libgp::CovarianceFunction::Workspace ws;
+  Eigen::VectorXd x1 = Eigen::VectorXd::Random(2), x2 = Eigen::VectorXd::Random(2);
+  Eigen::VectorXd grad(covf->get_param_dim());
+  double k, sum = 0;
+  // the first evaluation fills the workspace
+  covf->value_and_grad(x1, x2, k, grad, ws);
+  allocations = 0;
+  count_allocations = true;
+  for (int i = 0; i < 10; ++i) {
+    covf->value_and_grad(x1, x2, k, grad, ws);
+    sum += k + grad.sum();
+    covf->value_and_grad(x1, x1, k, grad, ws);
+    sum += k + grad.sum();
+  }
+  count_allocations = false;
+  ASSERT_EQ(0u, allocations);
+  ASSERT_TRUE(std::isfinite(sum));
+  delete covf;
+}
@@ -0,0 +1,144 @@
+// libgp - Gaussian process library for Machine Learning
+// Copyright (c) 2013, Manuel Blum <mblum@informatik.uni-freiburg.de>
+// All rights reserved.
+
+#include "gp.h"
+#include "cov_sum.h"
+#include "cov_se_iso.h"
+#include "cov_noise.h"
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+
+using namespace libgp;
+
+// sweep signal and noise level and compare to a freshly factorized model
+static void sweep(std::string covf_def, int input_dim)
+{
+  GaussianProcess gp(input_dim, covf_def);
+  gp.set_scale_noise_cache(true);
+  int param_dim = gp.covf().get_param_dim();
+  int scale, noise;
+  ASSERT_TRUE(gp.covf().scale_noise_form(scale, noise));
+  Eigen::VectorXd params = Eigen::VectorXd::Zero(param_dim);
+  if (noise >= 0) params(noise) = -2;
+  gp.covf().set_loghyper(params);
+  Eigen::MatrixXd X = Eigen::MatrixXd::Random(80, input_dim);
+  Eigen::VectorXd y = gp.covf().draw_random_sample(X);
+  gp.add_patterns(X, y);
+  gp.log_likelihood();
+  Eigen::VectorXd x_star = Eigen::VectorXd::Random(input_dim);
+  for (int i = 0; i < 5; ++i) {
+    if (scale >= 0) params(scale) = 0.3 * i - 0.5;
+    if (noise >= 0) params(noise) = -2.5 + 0.4 * i;
+    gp.covf().set_loghyper(params);
+    GaussianProcess ref(input_dim, covf_def);
+    ref.covf().set_loghyper(params);
+    ref.add_patterns(X, y);
+    ASSERT_NEAR(ref.log_likelihood(), gp.log_likelihood(), 1e-8);
+    Eigen::VectorXd g1 = ref.log_likelihood_gradient();
+    Eigen::VectorXd g2 = gp.log_likelihood_gradient();
+    for (int j = 0; j < param_dim; ++j) ASSERT_NEAR(g1(j), g2(j), 1e-7);
+    // derivatives of the levels from the eigendecomposition only
+    double scale_grad, noise_grad;
+    ASSERT_TRUE(gp.scale_noise_gradient(scale_grad, noise_grad));
+    ASSERT_NEAR(scale >= 0 ? g1(scale) : 0, scale_grad, 1e-7);
+    ASSERT_NEAR(noise >= 0 ? g1(noise) : 0, noise_grad, 1e-7);
+    ASSERT_NEAR(ref.f(x_star.data()), gp.f(x_star.data()), 1e-8);
+    ASSERT_NEAR(ref.var(x_star.data()), gp.var(x_star.data()), 1e-8);
+  }
+  // back to the parameters of the cholesky factor
+  Eigen::VectorXd first = params;
+  if (scale >= 0) first(scale) = 0;
+  if (noise >= 0) first(noise) = -2;
+  gp.covf().set_loghyper(first);
+  GaussianProcess orig(input_dim, covf_def);
+  orig.covf().set_loghyper(first);
+  orig.add_patterns(X, y);
+  ASSERT_NEAR(orig.log_likelihood(), gp.log_likelihood(), 1e-8);
+  ASSERT_NEAR(orig.f(x_star.data()), gp.f(x_star.data()), 1e-8);
+  gp.covf().set_loghyper(params);
+  // further samples and real-time prediction require the cholesky factor
+  Eigen::VectorXd x = Eigen::VectorXd::Random(input_dim);
+  gp.add_pattern(x.data(), 0.5);
+  GaussianProcess ref(input_dim, covf_def);
+  ref.covf().set_loghyper(params);
+  ref.add_patterns(X, y);
+  ref.add_pattern(x.data(), 0.5);
+  ASSERT_NEAR(ref.log_likelihood(), gp.log_likelihood(), 1e-8);
+  gp.prepare();
+  double mean, var;
+  ASSERT_TRUE(gp.predict_rt(x_star.data(), mean, &var));
+  ASSERT_NEAR(ref.f(x_star.data()), mean, 1e-8);
+  ASSERT_NEAR(ref.var(x_star.data()), var, 1e-8);
+}
+
+TEST(ScaleNoiseCacheTest, Sweep)
+{
+  sweep("CovSum ( CovSEiso, CovNoise)", 3);
+  sweep("CovSum ( CovMatern5iso, CovNoise)", 2);
+  sweep("CovSum ( CovSEard, CovNoise)", 2);
+  sweep("CovSum ( CovRQiso, CovNoise)", 2);
+}
+
+TEST(ScaleNoiseCacheTest, Structure)
+{
+  CovSEiso se;
+  se.init(2);
+  int s, e;
+  ASSERT_TRUE(se.scale_noise_form(s, e));
+  ASSERT_EQ(1, s);
+  ASSERT_EQ(-1, e);
+  CovarianceFunction * noise = new CovNoise();
+  CovarianceFunction * signal = new CovSEiso();
+  noise->init(2);
+  signal->init(2);
+  CovSum sum;
+  sum.init(2, noise, signal);
+  ASSERT_TRUE(sum.scale_noise_form(s, e));
+  ASSERT_EQ(2, s);
+  ASSERT_EQ(0, e);
+  // two noise terms do not have the required form
+  CovarianceFunction * noise1 = new CovNoise();
+  CovarianceFunction * noise2 = new CovNoise();
+  noise1->init(2);
+  noise2->init(2);
+  CovSum twice;
+  twice.init(2, noise1, noise2);
+  ASSERT_FALSE(twice.scale_noise_form(s, e));
+}
+
+TEST(ScaleNoiseCacheTest, NoiseOnly)
+{
+  // without further parameters the gradient does not need K^-1
+  sweep("CovNoise", 2);
+  GaussianProcess gp(2, "CovSum ( CovLinearard, CovNoise)");
+  double scale_grad, noise_grad;
+  ASSERT_FALSE(gp.scale_noise_gradient(scale_grad, noise_grad));
+}
+
+TEST(ScaleNoiseCacheTest, NoiseFree)
+{
+  // clipped eigenvalues of a singular K_0 fall back to the cholesky factor
+  GaussianProcess gp(1, "CovSEiso");
+  gp.set_scale_noise_cache(true);
+  Eigen::VectorXd params(2);
+  params << 0, 0;
+  gp.covf().set_loghyper(params);
+  Eigen::MatrixXd X = Eigen::VectorXd::LinSpaced(13, -1, 1);
+  Eigen::VectorXd y = X.col(0).array().sin();
+  gp.add_patterns(X, y);
+  double ll = gp.log_likelihood();
+  params(1) = 0.3;
+  gp.covf().set_loghyper(params);
+  GaussianProcess ref(1, "CovSEiso");
+  ref.covf().set_loghyper(params);
+  ref.add_patterns(X, y);
+  ASSERT_TRUE(std::isfinite(ll));
+  ASSERT_TRUE(std::isfinite(ref.log_likelihood()));
+  ASSERT_DOUBLE_EQ(ref.log_likelihood(), gp.log_likelihood());
+  double x = 0.1;
+  ASSERT_DOUBLE_EQ(ref.f(&x), gp.f(&x));
+}